@@ -3,6 +3,9 @@
 #include "standardoutput.h"
 #include "complex.h"
 
+#include <cstddef>
+#include <cstring>
+
 /**
  * Namespace of all classes of the GETLib - software library.
  */
@@ -20,6 +23,174 @@ namespace GET
 	 * @author Holger T�ubig
 	 */
 	typedef unsigned char uchar;
+
+	/**
+	 * Basic data type for gray value images with 16 bit unsigned integers (0..65535).
+	 *
+	 * For sensors delivering 10, 12 or 14 bit data: an Image<uint16> keeps the full
+	 * precision with half the memory of an Image<float>. Arithmetic and filters calculate
+	 * in float and store rounded and saturated (see PixelTraits).
+	 */
+	typedef unsigned short uint16;
+
+	/**
+	 * Basic data type for gray value images with 16 bit signed integers (-32768..32767),
+	 * e.g. for differences or gradients of 12 bit data (see uint16).
+	 */
+	typedef short int16;
+
+	/**
+	 * Data type for numbers of pixels and offsets into the image data.
+	 *
+	 * 64 bit on 64-bit platforms, so that images with more than 2^31 pixels
+	 * (e.g. 100000 x 60000) can be stored. Width, height and row pitch of an image
+	 * remain int; products of them must be computed as PixelIndex.
+	 */
+	typedef std::ptrdiff_t PixelIndex;
+
+	/**
+	 * Basic data type for gray value images with half precision (IEEE 754 binary16).
+	 *
+	 * 1 sign bit, 5 exponent bits and 10 mantissa bits: about 3 decimal digits in the range
+	 * 6e-5 .. 65504 (smaller values as subnormal numbers). An Image<half> needs half the memory
+	 * and memory bandwidth of an Image<float>, e.g. for intermediate results.
+	 *
+	 * Calculations are done in float: every operation converts the operands to float and
+	 * rounds the result to the nearest half (ties to even, overflow to infinity). Images are
+	 * converted with Image::copy(), which uses the F16C instructions if the CPU supports them
+	 * (see ImageArithmetic::doConvert()).
+	 */
+	struct half
+	{
+		/** Bit pattern of the number */
+		unsigned short bits;
+
+		/** Constructor, the value is undefined. */
+		inline half() {}
+
+		/** Conversion float -> half (rounded to nearest, ties to even). */
+		inline half(float value) : bits(getBits(value)) {}
+
+		/** Conversion half -> float (exact). */
+		inline operator float() const { return getFloat(bits); }
+
+		/** Arithmetic in float, the result is rounded. */
+		inline half &operator+=(float value) { bits = getBits(getFloat(bits) + value); return *this; }
+		inline half &operator-=(float value) { bits = getBits(getFloat(bits) - value); return *this; }
+		inline half &operator*=(float value) { bits = getBits(getFloat(bits) * value); return *this; }
+		inline half &operator/=(float value) { bits = getBits(getFloat(bits) / value); return *this; }
+
+		/** Returns the bit pattern of the half nearest to value (ties to even). */
+		static inline unsigned short getBits(float value)
+		{
+			unsigned int f;
+			std::memcpy(&f, &value, sizeof(f));
+			unsigned int sign = (f >> 16) & 0x8000;
+			f &= 0x7fffffff;
+
+			if (f >= 0x7f800000) // infinity and NaN (quiet, upper mantissa bits are kept)
+				return (unsigned short)(sign | 0x7c00 | ((f > 0x7f800000) ? 0x200 | ((f >> 13) & 0x3ff) : 0));
+			if (f >= 0x477ff000) // >= 65520 is rounded to infinity
+				return (unsigned short)(sign | 0x7c00);
+			if (f <= 0x33000000) // <= 2^-25 is rounded to zero
+				return (unsigned short)sign;
+
+			// normal numbers: rebias the exponent, subnormal numbers: shift the mantissa
+			unsigned int mantissa, h, shift;
+			if (f >= 0x38800000)
+			{
+				mantissa = f;
+				h = (f - 0x38000000) >> 13;
+				shift = 13;
+			}
+			else
+			{
+				mantissa = (f & 0x7fffff) | 0x800000;
+				shift = 126 - (f >> 23);
+				h = mantissa >> shift;
+			}
+			unsigned int rest = mantissa & ((1u << shift) - 1);
+			unsigned int halfway = 1u << (shift - 1);
+			if ((rest > halfway) || ((rest == halfway) && (h & 1)))
+				++h; // a carry into the exponent is correct
+			return (unsigned short)(sign | h);
+		}
+
+		/** Returns the value of a bit pattern. */
+		static inline float getFloat(unsigned short bits)
+		{
+			unsigned int sign = (unsigned int)(bits & 0x8000) << 16;
+			unsigned int exponent = (bits >> 10) & 0x1f;
+			unsigned int mantissa = bits & 0x3ff;
+			unsigned int f;
+
+			if (exponent == 0x1f)
+				f = sign | 0x7f800000 | (mantissa << 13);
+			else if (exponent != 0)
+				f = sign | ((exponent + 112) << 23) | (mantissa << 13);
+			else
+			{
+				// zero and subnormal numbers: mantissa * 2^-24 is exact in float
+				float value = mantissa * 5.9604644775390625e-8f;
+				std::memcpy(&f, &value, sizeof(f));
+				f |= sign;
+			}
+
+			float value;
+			std::memcpy(&value, &f, sizeof(value));
+			return value;
+		}
+	};
+
+	/**
+	 * Basic data type for gray value images in the bfloat16 format (upper half of a float).
+	 *
+	 * 1 sign bit, 8 exponent bits and 7 mantissa bits: the range of float with about 2 decimal
+	 * digits. Suited for intermediate results whose range is unknown; needs half the memory
+	 * and memory bandwidth of an Image<float>.
+	 *
+	 * Calculations are done in float, the result is rounded to the nearest bfloat16 (ties to
+	 * even). Images are converted with Image::copy() (see ImageArithmetic::doConvert()).
+	 */
+	struct bfloat16
+	{
+		/** Bit pattern of the number (upper 16 bits of the float) */
+		unsigned short bits;
+
+		/** Constructor, the value is undefined. */
+		inline bfloat16() {}
+
+		/** Conversion float -> bfloat16 (rounded to nearest, ties to even). */
+		inline bfloat16(float value) : bits(getBits(value)) {}
+
+		/** Conversion bfloat16 -> float (exact). */
+		inline operator float() const { return getFloat(bits); }
+
+		/** Arithmetic in float, the result is rounded. */
+		inline bfloat16 &operator+=(float value) { bits = getBits(getFloat(bits) + value); return *this; }
+		inline bfloat16 &operator-=(float value) { bits = getBits(getFloat(bits) - value); return *this; }
+		inline bfloat16 &operator*=(float value) { bits = getBits(getFloat(bits) * value); return *this; }
+		inline bfloat16 &operator/=(float value) { bits = getBits(getFloat(bits) / value); return *this; }
+
+		/** Returns the bit pattern of the bfloat16 nearest to value (ties to even). */
+		static inline unsigned short getBits(float value)
+		{
+			unsigned int f;
+			std::memcpy(&f, &value, sizeof(f));
+			if ((f & 0x7fffffff) > 0x7f800000) // NaN stays (quiet) NaN
+				return (unsigned short)((f >> 16) | 0x40);
+			return (unsigned short)((f + 0x7fff + ((f >> 16) & 1)) >> 16);
+		}
+
+		/** Returns the value of a bit pattern. */
+		static inline float getFloat(unsigned short bits)
+		{
+			unsigned int f = (unsigned int)bits << 16;
+			float value;
+			std::memcpy(&value, &f, sizeof(value));
+			return value;
+		}
+	};
 }
 
 
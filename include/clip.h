@@ -36,8 +36,42 @@ class Clip
 	 * @param image Image whose value range is to be cropped
 	 */
 	void doClipImage( Image<float> &image );
+
+	/** The pixels of a 16 bit image are clipped to the set value range.
+	 * 
+	 * The bounds are rounded to the nearest value and limited to the range of the base data type
+	 * (see PixelTraits::getPixel()). The pixels are clamped with ImageArithmetic::doClamp().
+	 * 
+	 * @param image Image whose value range is to be cropped
+	 */
+	inline void doClipImage( Image<uint16> &image ) { doClipInteger16( image ); };
+
+	/** The pixels of a 16 bit image are clipped to the set value range (see doClipImage( Image<uint16> & )). */
+	inline void doClipImage( Image<int16> &image ) { doClipInteger16( image ); };
+
+  private:
+	/** Implementation of doClipImage() for uint16 and int16 (row by row). */
+	template <typename Typ>
+	inline void doClipInteger16( Image<Typ> &image );
 };
 
 
 
+/* ************************************************************************** */
+template <typename Typ>
+inline void Clip::doClipInteger16( Image<Typ> &image )
+/* ************************************************************************** */
+{
+	Typ minimum = PixelTraits<Typ>::getPixel( m_minval );
+	Typ maximum = PixelTraits<Typ>::getPixel( m_maxval );
+
+	// packed images are processed as a single row
+	int rows = image.isPacked() ? 1 : image.getHeight();
+	PixelIndex size = ( rows == 1 ) ? image.getSize() : image.getWidth();
+	for ( int y = 0; y < rows; ++y )
+		ImageArithmetic::doClamp( image.getRow( y ), minimum, maximum, size );
+}
+
+
+
 }/*__GET__CLIP_H*/
@@ -0,0 +1,332 @@
+#pragma once
+
+#include "complex.h"
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace GET
+{
+
+	/** Vectorised operations on arrays of complex numbers.
+	 *
+	 * The operators of Complex process one element at a time with temporaries. These batch
+	 * kernels process whole arrays (e.g. the pixels of an Image<Complex>) with SIMD
+	 * instructions: 4 complex numbers per instruction with AVX, 2 with SSE2 and one
+	 * complex number at a time otherwise. The instruction set is chosen at compile time
+	 * (-mavx; SSE2 is always available on x86-64).
+	 *
+	 * The complex multiplication (a + ib)(c + id) = (ac - bd) + i(ad + bc) is computed with
+	 * the real parts and the imaginary parts of the second operand duplicated into all lanes
+	 * and the real and imaginary parts of the first operand swapped:
+	 *
+	 *   [a b] * [c c] +- [b a] * [d d]
+	 *
+	 * All kernels allow the result to be the same array as one of the inputs (in-place operation).
+	 * The results are the same as the ones of the Complex operators apart from rounding
+	 * (fused multiply-add is not used).
+	 *
+	 * @see FrequencyDomainFilteringBaseTemplate::doFiltering()
+	 */
+	class ComplexKernels
+	{
+	public:
+		/** result[i] = a[i] * b[i] (complex * complex) */
+		static inline void doMultiply(const Complex *a, const Complex *b, Complex *result, int size);
+
+		/** result[i] = a[i] * b[i] (complex * real, e.g. a spectrum with a real filter mask) */
+		static inline void doMultiply(const Complex *a, const float *b, Complex *result, int size);
+
+		/** result[i] = a[i] * conj(b[i]) (e.g. cross-power spectrum for correlation) */
+		static inline void doMultiplyConjugate(const Complex *a, const Complex *b, Complex *result, int size);
+
+		/** accumulator[i] += a[i] * b[i] (complex * complex) */
+		static inline void doMultiplyAccumulate(const Complex *a, const Complex *b, Complex *accumulator, int size);
+
+		/** accumulator[i] += a[i] * b[i] (complex * real) */
+		static inline void doMultiplyAccumulate(const Complex *a, const float *b, Complex *accumulator, int size);
+
+		/** data[i] *= factor */
+		static inline void doScale(Complex *data, float factor, int size);
+
+		/** result[i] = a[i] * b[i] for complex numbers in split layout (complex * real)
+		 *
+		 * @see SplitComplexImage
+		 */
+		static inline void doMultiply(const float *a_re, const float *a_im, const float *b, float *result_re, float *result_im, int size);
+
+		/** result[i] = a[i] * b[i] for complex numbers in split layout (complex * complex in interleaved layout, e.g. a complex filter mask)
+		 *
+		 * @see SplitComplexImage
+		 */
+		static inline void doMultiply(const float *a_re, const float *a_im, const Complex *b, float *result_re, float *result_im, int size);
+
+	private:
+#if defined(__AVX__)
+		/** Complex product of 4 complex numbers (conjugate: a * conj(b)) */
+		static inline __m256 doMultiply4(__m256 a, __m256 b, bool conjugate)
+		{
+			__m256 b_re = _mm256_moveldup_ps(b);		  // [c c]
+			__m256 b_im = _mm256_movehdup_ps(b);		  // [d d]
+			__m256 a_swap = _mm256_permute_ps(a, 0xB1); // [b a]
+			if (conjugate)
+			{
+				// [ac + bd, bc - ad]
+				__m256 odd_sign = _mm256_castsi256_ps(_mm256_set_epi32(0x80000000, 0, 0x80000000, 0, 0x80000000, 0, 0x80000000, 0));
+				return _mm256_add_ps(_mm256_mul_ps(a, b_re), _mm256_xor_ps(_mm256_mul_ps(a_swap, b_im), odd_sign));
+			}
+			return _mm256_addsub_ps(_mm256_mul_ps(a, b_re), _mm256_mul_ps(a_swap, b_im));
+		};
+
+		/** Loads 4 real values and duplicates each one for the real and imaginary part */
+		static inline __m256 doLoadReal4(const float *b)
+		{
+			__m128 values = _mm_loadu_ps(b);
+			return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_unpacklo_ps(values, values)), _mm_unpackhi_ps(values, values), 1);
+		};
+#endif
+
+#if defined(__SSE2__)
+		/** Complex product of 2 complex numbers (conjugate: a * conj(b)) */
+		static inline __m128 doMultiply2(__m128 a, __m128 b, bool conjugate)
+		{
+			__m128 b_re = _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 2, 0, 0));   // [c c]
+			__m128 b_im = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 3, 1, 1));   // [d d]
+			__m128 a_swap = _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)); // [b a]
+			__m128 sign = conjugate ? _mm_castsi128_ps(_mm_set_epi32(0x80000000, 0, 0x80000000, 0))
+									: _mm_castsi128_ps(_mm_set_epi32(0, 0x80000000, 0, 0x80000000));
+			return _mm_add_ps(_mm_mul_ps(a, b_re), _mm_xor_ps(_mm_mul_ps(a_swap, b_im), sign));
+		};
+
+		/** Loads 2 real values and duplicates each one for the real and imaginary part */
+		static inline __m128 doLoadReal2(const float *b)
+		{
+			__m128 values = _mm_castpd_ps(_mm_load_sd((const double *)b));
+			return _mm_unpacklo_ps(values, values);
+		};
+#endif
+
+		/** Scalar complex product (conjugate: a * conj(b)) */
+		static inline Complex doMultiply1(const Complex &a, const Complex &b, bool conjugate)
+		{
+			Complex result;
+			if (conjugate)
+			{
+				result.re = a.re * b.re + a.im * b.im;
+				result.im = a.im * b.re - a.re * b.im;
+			}
+			else
+			{
+				result.re = a.re * b.re - a.im * b.im;
+				result.im = a.im * b.re + a.re * b.im;
+			}
+			return result;
+		};
+
+		/** Common implementation of the complex * complex kernels */
+		static inline void doComplexKernel(const Complex *a, const Complex *b, Complex *result, int size, bool conjugate, bool accumulate);
+
+		/** Common implementation of the complex * real kernels */
+		static inline void doRealKernel(const Complex *a, const float *b, Complex *result, int size, bool accumulate);
+	};
+
+	/* ************************************************************************** */
+	/* *** Implementation of the inline methods ********************************* */
+	/* ************************************************************************** */
+
+	/* ************************************************************************** */
+	inline void ComplexKernels::doMultiply(const Complex *a, const Complex *b, Complex *result, int size)
+	/* ************************************************************************** */
+	{
+		doComplexKernel(a, b, result, size, false, false);
+	}
+
+	/* ************************************************************************** */
+	inline void ComplexKernels::doMultiply(const Complex *a, const float *b, Complex *result, int size)
+	/* ************************************************************************** */
+	{
+		doRealKernel(a, b, result, size, false);
+	}
+
+	/* ************************************************************************** */
+	inline void ComplexKernels::doMultiplyConjugate(const Complex *a, const Complex *b, Complex *result, int size)
+	/* ************************************************************************** */
+	{
+		doComplexKernel(a, b, result, size, true, false);
+	}
+
+	/* ************************************************************************** */
+	inline void ComplexKernels::doMultiplyAccumulate(const Complex *a, const Complex *b, Complex *accumulator, int size)
+	/* ************************************************************************** */
+	{
+		doComplexKernel(a, b, accumulator, size, false, true);
+	}
+
+	/* ************************************************************************** */
+	inline void ComplexKernels::doMultiplyAccumulate(const Complex *a, const float *b, Complex *accumulator, int size)
+	/* ************************************************************************** */
+	{
+		doRealKernel(a, b, accumulator, size, true);
+	}
+
+	/* ************************************************************************** */
+	inline void ComplexKernels::doScale(Complex *data, float factor, int size)
+	/* ************************************************************************** */
+	{
+		float *values = (float *)data;
+		int i = 0;
+		size *= 2;
+
+#if defined(__AVX__)
+		__m256 factor8 = _mm256_set1_ps(factor);
+		for (; i + 8 <= size; i += 8)
+			_mm256_storeu_ps(values + i, _mm256_mul_ps(_mm256_loadu_ps(values + i), factor8));
+#endif
+#if defined(__SSE2__)
+		__m128 factor4 = _mm_set1_ps(factor);
+		for (; i + 4 <= size; i += 4)
+			_mm_storeu_ps(values + i, _mm_mul_ps(_mm_loadu_ps(values + i), factor4));
+#endif
+		for (; i < size; ++i)
+			values[i] *= factor;
+	}
+
+	/* ************************************************************************** */
+	inline void ComplexKernels::doMultiply(const float *a_re, const float *a_im, const float *b, float *result_re, float *result_im, int size)
+	/* ************************************************************************** */
+	{
+		int i = 0;
+
+#if defined(__AVX__)
+		for (; i + 8 <= size; i += 8)
+		{
+			__m256 b8 = _mm256_loadu_ps(b + i);
+			_mm256_storeu_ps(result_re + i, _mm256_mul_ps(_mm256_loadu_ps(a_re + i), b8));
+			_mm256_storeu_ps(result_im + i, _mm256_mul_ps(_mm256_loadu_ps(a_im + i), b8));
+		}
+#endif
+#if defined(__SSE2__)
+		for (; i + 4 <= size; i += 4)
+		{
+			__m128 b4 = _mm_loadu_ps(b + i);
+			_mm_storeu_ps(result_re + i, _mm_mul_ps(_mm_loadu_ps(a_re + i), b4));
+			_mm_storeu_ps(result_im + i, _mm_mul_ps(_mm_loadu_ps(a_im + i), b4));
+		}
+#endif
+		for (; i < size; ++i)
+		{
+			result_re[i] = a_re[i] * b[i];
+			result_im[i] = a_im[i] * b[i];
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void ComplexKernels::doMultiply(const float *a_re, const float *a_im, const Complex *b, float *result_re, float *result_im, int size)
+	/* ************************************************************************** */
+	{
+		const float *fb = (const float *)b;
+		int i = 0;
+
+#if defined(__SSE2__)
+		for (; i + 4 <= size; i += 4)
+		{
+			// Deinterleave 4 values of b: [c0 d0 c1 d1] [c2 d2 c3 d3] -> [c0 c1 c2 c3] [d0 d1 d2 d3]
+			__m128 low = _mm_loadu_ps(fb + 2 * i);
+			__m128 high = _mm_loadu_ps(fb + 2 * i + 4);
+			__m128 b_re = _mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0));
+			__m128 b_im = _mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1));
+			__m128 re = _mm_loadu_ps(a_re + i);
+			__m128 im = _mm_loadu_ps(a_im + i);
+			_mm_storeu_ps(result_re + i, _mm_sub_ps(_mm_mul_ps(re, b_re), _mm_mul_ps(im, b_im)));
+			_mm_storeu_ps(result_im + i, _mm_add_ps(_mm_mul_ps(im, b_re), _mm_mul_ps(re, b_im)));
+		}
+#endif
+		for (; i < size; ++i)
+		{
+			float re = a_re[i];
+			float im = a_im[i];
+			result_re[i] = re * b[i].re - im * b[i].im;
+			result_im[i] = im * b[i].re + re * b[i].im;
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void ComplexKernels::doComplexKernel(const Complex *a, const Complex *b, Complex *result, int size, bool conjugate, bool accumulate)
+	/* ************************************************************************** */
+	{
+		const float *fa = (const float *)a;
+		const float *fb = (const float *)b;
+		float *fr = (float *)result;
+		int i = 0;
+
+#if defined(__AVX__)
+		for (; i + 4 <= size; i += 4)
+		{
+			__m256 product = doMultiply4(_mm256_loadu_ps(fa + 2 * i), _mm256_loadu_ps(fb + 2 * i), conjugate);
+			if (accumulate)
+				product = _mm256_add_ps(_mm256_loadu_ps(fr + 2 * i), product);
+			_mm256_storeu_ps(fr + 2 * i, product);
+		}
+#endif
+#if defined(__SSE2__)
+		for (; i + 2 <= size; i += 2)
+		{
+			__m128 product = doMultiply2(_mm_loadu_ps(fa + 2 * i), _mm_loadu_ps(fb + 2 * i), conjugate);
+			if (accumulate)
+				product = _mm_add_ps(_mm_loadu_ps(fr + 2 * i), product);
+			_mm_storeu_ps(fr + 2 * i, product);
+		}
+#endif
+		for (; i < size; ++i)
+		{
+			Complex product = doMultiply1(a[i], b[i], conjugate);
+			if (accumulate)
+				result[i] += product;
+			else
+				result[i] = product;
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void ComplexKernels::doRealKernel(const Complex *a, const float *b, Complex *result, int size, bool accumulate)
+	/* ************************************************************************** */
+	{
+		const float *fa = (const float *)a;
+		float *fr = (float *)result;
+		int i = 0;
+
+#if defined(__AVX__)
+		for (; i + 4 <= size; i += 4)
+		{
+			__m256 product = _mm256_mul_ps(_mm256_loadu_ps(fa + 2 * i), doLoadReal4(b + i));
+			if (accumulate)
+				product = _mm256_add_ps(_mm256_loadu_ps(fr + 2 * i), product);
+			_mm256_storeu_ps(fr + 2 * i, product);
+		}
+#endif
+#if defined(__SSE2__)
+		for (; i + 2 <= size; i += 2)
+		{
+			__m128 product = _mm_mul_ps(_mm_loadu_ps(fa + 2 * i), doLoadReal2(b + i));
+			if (accumulate)
+				product = _mm_add_ps(_mm_loadu_ps(fr + 2 * i), product);
+			_mm_storeu_ps(fr + 2 * i, product);
+		}
+#endif
+		for (; i < size; ++i)
+		{
+			if (accumulate)
+			{
+				result[i].re += a[i].re * b[i];
+				result[i].im += a[i].im * b[i];
+			}
+			else
+			{
+				result[i].re = a[i].re * b[i];
+				result[i].im = a[i].im * b[i];
+			}
+		}
+	}
+
+} /* namespace GET */
@@ -3,6 +3,17 @@
 #include "image.h"
 #include "imagesequence.h"
 #include "gvector.h"
+#include "splitcompleximage.h"
+#include "planarrgbimage.h"
+#include "fastmath.h"
+
+#include <algorithm>
+#include <math.h>
+#include <vector>
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 namespace GET
 {
@@ -30,6 +41,38 @@ namespace GET
 		 */
 		static void doComplex2Magnitude(const Image<Complex> &image, Image<float> &magnitude_image);
 
+		/**
+		 * Determination of the magnitude image of a complex image in split layout.
+		 *
+		 * Since real and imaginary parts are stored in separate planes, the magnitudes are
+		 * computed for 8 (AVX) or 4 (SSE) pixels per instruction without any shuffles.
+		 *
+		 * @param image complex image in split layout (input)
+		 * @param magnitude_image magnitude image of image (output)
+		 */
+		static inline void doComplex2Magnitude(const SplitComplexImage &image, Image<float> &magnitude_image);
+
+		/**
+		 * Determination of the phase image of a complex image in split layout.
+		 *
+		 * The phases are computed with FastMath::doAtan2() directly from the two planes, i.e. with
+		 * the vectorised approximation if FastMath::FAST has been chosen.
+		 *
+		 * @param image complex image in split layout (input)
+		 * @param phase_image phase image of image (output)
+		 */
+		static inline void doComplex2Phase(const SplitComplexImage &image, Image<float> &phase_image);
+
+		/**
+		 * Computes the gray value image (luminance) of a planar RGB image.
+		 *
+		 * Same weights as Rgb::operator float(), the channels are processed with SIMD instructions.
+		 *
+		 * @param image RGB image in planar layout
+		 * @param gray_image result (is resized to the size of image if necessary)
+		 */
+		static inline void doRgb2Gray(const PlanarRgbImage<float> &image, Image<float> &gray_image);
+
 		/**
 		 * Determination of the phase image of a complex image.
 		 *
@@ -109,6 +152,45 @@ namespace GET
 		 */
 		static void doAutomaticScaling(Image<float> &image);
 
+		/**
+		 * Display image of a Fourier spectrum (magnitude, logarithm and automatic scaling in one kernel).
+		 *
+		 * Computes for each pixel the value log(1 + |F|) and scales these values linearly to
+		 * [0,255], which is the usual way to show a spectrum. The same result could be obtained with
+		 * doComplex2Magnitude(), a logarithm, doAutomaticScaling() and a conversion to uchar, but
+		 * these need four passes over the image and two temporary images. Here the value range is
+		 * determined in a first (vectorised) pass on the squared magnitudes (the logarithm is
+		 * monotonic, so only two logarithms are needed for it), and the second pass writes the
+		 * display image directly (scaled with SSE2). Square roots and logarithms are computed row by row with
+		 * FastMath, i.e. vectorised after FastMath::setAccuracy( FastMath::FAST ).
+		 *
+		 * With low and high a part of the value range can be selected: values below
+		 * low (relative to the range of log(1 + |F|), 0 = minimum, 1 = maximum) become 0, values
+		 * above high become 255. E.g. high < 1 brightens spectra dominated by the DC component.
+		 *
+		 * @param image complex image, e.g. Fourier transform (input)
+		 * @param display_image display image (output)
+		 * @param centre true: the quadrants are swapped, so the zero frequency is shown in the centre
+		 *               at (width/2, height/2) like fftshift, also for odd sizes
+		 *               (for spectra that have not been centred by a Nyquist modulation)
+		 * @param low lower end of the value range shown (0 ... 1)
+		 * @param high upper end of the value range shown (0 ... 1, greater than low)
+		 */
+		static inline void doSpectrum2Display(const Image<Complex> &image, Image<uchar> &display_image, bool centre = false, float low = 0.0f, float high = 1.0f);
+
+		/**
+		 * Display image of a 16 bit image (e.g. of a camera with 10, 12 or 16 bit per pixel).
+		 *
+		 * The upper 8 of the significant bits are shown: each pixel is shifted right by bits - 8,
+		 * pixels above 2^bits - 1 become 255. Unlike a conversion to uchar this does not clip
+		 * all values above 255. Vectorised with SSE2.
+		 *
+		 * @param image 16 bit image (input)
+		 * @param display_image display image (output)
+		 * @param bits number of significant bits of the pixels (8 ... 16)
+		 */
+		static inline void doImage2Display(const Image<uint16> &image, Image<uchar> &display_image, int bits = 16);
+
 		/**
 		 * Returns the x-components of the given vector field.
 		 */
@@ -142,4 +224,275 @@ namespace GET
 		static void doXY2Vector(const ImageSequence<float> &input_x, const ImageSequence<float> &input_y, ImageSequence<Vector2D> &output_vector);
 	};
 
+	/* ************************************************************************** */
+	inline void Conversions::doComplex2Magnitude(const SplitComplexImage &image, Image<float> &magnitude_image)
+	/* ************************************************************************** */
+	{
+		if ((magnitude_image.getWidth() != image.getWidth()) || (magnitude_image.getHeight() != image.getHeight()))
+			magnitude_image.resize(image.getWidth(), image.getHeight());
+
+		// the planes are packed; a packed result is processed as a single row
+		int rows = magnitude_image.isPacked() ? 1 : image.getHeight();
+		PixelIndex size = (rows == 1) ? image.getSize() : image.getWidth();
+
+		for (int y = 0; y < rows; ++y)
+		{
+			const float *re = image.getReal().getData() + y * size;
+			const float *im = image.getImag().getData() + y * size;
+			float *magnitude = magnitude_image.getRow(y);
+			PixelIndex i = 0;
+
+#if defined(__AVX__)
+			for (; i + 8 <= size; i += 8)
+			{
+				__m256 re8 = _mm256_loadu_ps(re + i);
+				__m256 im8 = _mm256_loadu_ps(im + i);
+				_mm256_storeu_ps(magnitude + i, _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(re8, re8), _mm256_mul_ps(im8, im8))));
+			}
+#endif
+#if defined(__SSE2__)
+			for (; i + 4 <= size; i += 4)
+			{
+				__m128 re4 = _mm_loadu_ps(re + i);
+				__m128 im4 = _mm_loadu_ps(im + i);
+				_mm_storeu_ps(magnitude + i, _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(re4, re4), _mm_mul_ps(im4, im4))));
+			}
+#endif
+			for (; i < size; ++i)
+				magnitude[i] = sqrtf(re[i] * re[i] + im[i] * im[i]);
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void Conversions::doComplex2Phase(const SplitComplexImage &image, Image<float> &phase_image)
+	/* ************************************************************************** */
+	{
+		if ((phase_image.getWidth() != image.getWidth()) || (phase_image.getHeight() != image.getHeight()))
+			phase_image.resize(image.getWidth(), image.getHeight());
+
+		// the planes are packed; a packed result is processed as a single row
+		int rows = phase_image.isPacked() ? 1 : image.getHeight();
+		PixelIndex size = (rows == 1) ? image.getSize() : image.getWidth();
+
+		for (int y = 0; y < rows; ++y)
+			FastMath::doAtan2(image.getImag().getData() + y * size, image.getReal().getData() + y * size, phase_image.getRow(y), size);
+	}
+
+	/* ************************************************************************** */
+	inline void Conversions::doRgb2Gray(const PlanarRgbImage<float> &image, Image<float> &gray_image)
+	/* ************************************************************************** */
+	{
+		if ((gray_image.getWidth() != image.getWidth()) || (gray_image.getHeight() != image.getHeight()))
+			gray_image.resize(image.getWidth(), image.getHeight());
+
+		const float weight_red = 0.212671f;
+		const float weight_green = 0.715160f;
+		const float weight_blue = 0.072169f;
+
+		// the planes are packed; a packed result is processed as a single row
+		int rows = gray_image.isPacked() ? 1 : image.getHeight();
+		PixelIndex size = (rows == 1) ? image.getSize() : image.getWidth();
+
+		for (int y = 0; y < rows; ++y)
+		{
+			const float *red = image.getRed().getData() + y * size;
+			const float *green = image.getGreen().getData() + y * size;
+			const float *blue = image.getBlue().getData() + y * size;
+			float *gray = gray_image.getRow(y);
+			PixelIndex i = 0;
+
+#if defined(__AVX__)
+			__m256 wr8 = _mm256_set1_ps(weight_red);
+			__m256 wg8 = _mm256_set1_ps(weight_green);
+			__m256 wb8 = _mm256_set1_ps(weight_blue);
+			for (; i + 8 <= size; i += 8)
+			{
+				__m256 sum = _mm256_add_ps(_mm256_mul_ps(wr8, _mm256_loadu_ps(red + i)), _mm256_mul_ps(wg8, _mm256_loadu_ps(green + i)));
+				_mm256_storeu_ps(gray + i, _mm256_add_ps(sum, _mm256_mul_ps(wb8, _mm256_loadu_ps(blue + i))));
+			}
+#endif
+#if defined(__SSE2__)
+			__m128 wr4 = _mm_set1_ps(weight_red);
+			__m128 wg4 = _mm_set1_ps(weight_green);
+			__m128 wb4 = _mm_set1_ps(weight_blue);
+			for (; i + 4 <= size; i += 4)
+			{
+				__m128 sum = _mm_add_ps(_mm_mul_ps(wr4, _mm_loadu_ps(red + i)), _mm_mul_ps(wg4, _mm_loadu_ps(green + i)));
+				_mm_storeu_ps(gray + i, _mm_add_ps(sum, _mm_mul_ps(wb4, _mm_loadu_ps(blue + i))));
+			}
+#endif
+			for (; i < size; ++i)
+				gray[i] = weight_red * red[i] + weight_green * green[i] + weight_blue * blue[i];
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void Conversions::doSpectrum2Display(const Image<Complex> &image, Image<uchar> &display_image, bool centre, float low, float high)
+	/* ************************************************************************** */
+	{
+		int width = image.getWidth();
+		int height = image.getHeight();
+		PixelIndex size = image.getSize();
+
+		if ((display_image.getWidth() != width) || (display_image.getHeight() != height))
+			display_image.resize(width, height);
+		if (size == 0)
+			return;
+
+		//
+		// Range of the squared magnitudes (a packed image is processed as a single row)
+		//
+		const float *first = (const float *)image.getData();
+		float min_squared = first[0] * first[0] + first[1] * first[1];
+		float max_squared = min_squared;
+		int rows = image.isPacked() ? 1 : height;
+		PixelIndex length = (rows == 1) ? size : width;
+
+		for (int y = 0; y < rows; ++y)
+		{
+			const float *data = (const float *)image.getRow(y);
+			PixelIndex i = 0;
+
+#if defined(__SSE2__)
+			if (length >= 4)
+			{
+				__m128 min4 = _mm_set1_ps(min_squared);
+				__m128 max4 = min4;
+				for (; i + 4 <= length; i += 4)
+				{
+					// [r0 i0 r1 i1] [r2 i2 r3 i3] -> |c0|^2 |c1|^2 |c2|^2 |c3|^2
+					__m128 low_half = _mm_loadu_ps(data + 2 * i);
+					__m128 high_half = _mm_loadu_ps(data + 2 * i + 4);
+					low_half = _mm_mul_ps(low_half, low_half);
+					high_half = _mm_mul_ps(high_half, high_half);
+					__m128 squared = _mm_add_ps(_mm_shuffle_ps(low_half, high_half, _MM_SHUFFLE(2, 0, 2, 0)),
+												_mm_shuffle_ps(low_half, high_half, _MM_SHUFFLE(3, 1, 3, 1)));
+					min4 = _mm_min_ps(min4, squared);
+					max4 = _mm_max_ps(max4, squared);
+				}
+				float mins[4], maxs[4];
+				_mm_storeu_ps(mins, min4);
+				_mm_storeu_ps(maxs, max4);
+				for (int k = 0; k < 4; ++k)
+				{
+					min_squared = std::min(min_squared, mins[k]);
+					max_squared = std::max(max_squared, maxs[k]);
+				}
+			}
+#endif
+			for (; i < length; ++i)
+			{
+				float squared = data[2 * i] * data[2 * i] + data[2 * i + 1] * data[2 * i + 1];
+				min_squared = std::min(min_squared, squared);
+				max_squared = std::max(max_squared, squared);
+			}
+		}
+
+		//
+		// Linear mapping of log(1 + |F|) from [range_min, range_max] to [0,255]
+		//
+		float log_min = logf(1.0f + sqrtf(min_squared));
+		float log_max = logf(1.0f + sqrtf(max_squared));
+		float range_min = log_min + low * (log_max - log_min);
+		float range_max = log_min + high * (log_max - log_min);
+		float factor = (range_max > range_min) ? 255.0f / (range_max - range_min) : 0.0f;
+		float offset = 0.5f - range_min * factor; // rounding
+
+		//
+		// Display image (with swapped quadrants if centre is true)
+		//
+		// the zero frequency moves to (width/2, height/2), also for odd sizes
+		int shift_x = centre ? (width + 1) / 2 : 0;
+		int shift_y = centre ? (height + 1) / 2 : 0;
+		std::vector<float> row(width);
+
+		for (int y = 0; y < height; ++y)
+		{
+			const Complex *source = image.getRow((y + shift_y) % height);
+			uchar *destination = display_image.getRow(y);
+			for (int x = 0; x < width; ++x)
+			{
+				const Complex &value = source[(x + shift_x < width) ? x + shift_x : x + shift_x - width];
+				row[x] = value.re * value.re + value.im * value.im;
+			}
+
+			// log(1 + |F|) of the whole row (vectorised approximations with FastMath::FAST)
+			FastMath::doSqrt(&row[0], &row[0], width);
+			int x = 0;
+#if defined(__SSE2__)
+			for (__m128 one = _mm_set1_ps(1.0f); x + 4 <= width; x += 4)
+				_mm_storeu_ps(&row[x], _mm_add_ps(_mm_loadu_ps(&row[x]), one));
+#endif
+			for (; x < width; ++x)
+				row[x] += 1.0f;
+			FastMath::doLog(&row[0], &row[0], width);
+
+			// scaling to [0,255], 16 pixels at a time
+			x = 0;
+#if defined(__SSE2__)
+			__m128 factor4 = _mm_set1_ps(factor);
+			__m128 offset4 = _mm_set1_ps(offset);
+			__m128 zero4 = _mm_setzero_ps();
+			__m128 limit4 = _mm_set1_ps(255.0f);
+			for (; x + 16 <= width; x += 16)
+			{
+				__m128i value[4];
+				for (int k = 0; k < 4; ++k)
+				{
+					__m128 scaled = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&row[x + 4 * k]), factor4), offset4);
+					value[k] = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(scaled, zero4), limit4));
+				}
+				__m128i low = _mm_packs_epi32(value[0], value[1]);
+				__m128i high = _mm_packs_epi32(value[2], value[3]);
+				_mm_storeu_si128((__m128i *)(destination + x), _mm_packus_epi16(low, high));
+			}
+#endif
+			for (; x < width; ++x)
+				destination[x] = (uchar)std::min(std::max(row[x] * factor + offset, 0.0f), 255.0f);
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void Conversions::doImage2Display(const Image<uint16> &image, Image<uchar> &display_image, int bits)
+	/* ************************************************************************** */
+	{
+		if ((bits < 8) || (bits > 16))
+		{
+			gerr << "runtime error in Conversions::doImage2Display( const Image<uint16> &image, Image<uchar> &display_image, int bits )\n";
+			gerr << "The number of bits must be in [8,16], it is limited to this range\n";
+			bits = std::min(std::max(bits, 8), 16);
+		}
+
+		if ((display_image.getWidth() != image.getWidth()) || (display_image.getHeight() != image.getHeight()))
+			display_image.resize(image.getWidth(), image.getHeight());
+
+		// packed images are processed as a single row
+		int rows = (image.isPacked() && display_image.isPacked()) ? 1 : image.getHeight();
+		PixelIndex size = (rows == 1) ? image.getSize() : image.getWidth();
+		int shift = bits - 8;
+
+		for (int y = 0; y < rows; ++y)
+		{
+			const uint16 *source = image.getRow(y);
+			uchar *destination = display_image.getRow(y);
+			PixelIndex i = 0;
+
+#if defined(__SSE2__)
+			__m128i count = _mm_cvtsi32_si128(shift);
+			for (; i + 16 <= size; i += 16)
+			{
+				// packus_epi16 saturates signed values: limit to 255 first (x - max(x - 255, 0))
+				__m128i limit = _mm_set1_epi16(255);
+				__m128i low = _mm_srl_epi16(_mm_loadu_si128((const __m128i *)(source + i)), count);
+				__m128i high = _mm_srl_epi16(_mm_loadu_si128((const __m128i *)(source + i + 8)), count);
+				low = _mm_sub_epi16(low, _mm_subs_epu16(low, limit));
+				high = _mm_sub_epi16(high, _mm_subs_epu16(high, limit));
+				_mm_storeu_si128((__m128i *)(destination + i), _mm_packus_epi16(low, high));
+			}
+#endif
+			for (; i < size; ++i)
+				destination[i] = (uchar)std::min(source[i] >> shift, 255);
+		}
+	}
+
 } //_CONVERSIONS_H_
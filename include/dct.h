@@ -0,0 +1,405 @@
+#pragma once
+
+#include "image.h"
+#include "fft.h"
+#include "gexception.h"
+
+#include <math.h>
+#include <algorithm>
+
+namespace GET
+{
+
+	/** Discrete Cosine Transform (DCT-II and its inverse, the DCT-III).
+	 *
+	 * The transformation is orthonormal, i.e. the DCT-III computed by the inverse
+	 * methods is the exact inverse of the DCT-II and the energy of the image is preserved.
+	 * The coefficient (u,v) of the DCT-II of an image f of size N*M is
+	 *
+	 *   F(u,v) = c(u) c(v) sum_x sum_y f(x,y) cos(pi(2x+1)u/2N) cos(pi(2y+1)v/2M)
+	 *
+	 * with c(0) = sqrt(1/N) and c(u) = sqrt(2/N) otherwise.
+	 *
+	 * In contrast to the Fourier transform, the DCT implicitly continues the image
+	 * symmetrically at its borders. Filtering in the DCT domain therefore corresponds to
+	 * filtering with mirrored (Neumann) boundary conditions and shows no wrap-around artefacts.
+	 *
+	 * The one-dimensional transforms are computed with an FFT of the same length
+	 * (reordering according to Makhoul). Two real lines are always transformed together
+	 * as real and imaginary part of one complex line, so the complex working memory
+	 * has the size of the real input image.
+	 *
+	 * Only line lengths which are powers of two are supported (for the whole-image
+	 * transform width and height, for the block-wise transform the block size). For
+	 * other lengths FFT would fall back to the DFT with its quadratic effort, so they are
+	 * rejected with a GException. Padding would not help either, because the DCT of a
+	 * padded line is not the DCT of the line.
+	 *
+	 * Besides the transformation of the whole image, a block-wise transformation
+	 * (e.g. 8x8 or 16x16 blocks as used for image compression) is provided.
+	 *
+	 * @note Source: J. Makhoul - A fast cosine transform in one and two dimensions.
+	 *       IEEE Trans. ASSP 28(1), 1980.
+	 */
+	class DCT
+	{
+	private:
+		/** Describes how the lines (rows, columns or block lines) of an image are located in memory.
+		 *
+		 * The lines are numbered consecutively. Line i starts at the element
+		 * (i / lines_per_group) * group_step + (i % lines_per_group) * line_step, and the
+		 * elements of a line are element_step apart.
+		 */
+		struct LineLayout
+		{
+			int length;			 ///< number of elements of a line (= transformation length)
+			int count;			 ///< number of lines
+			int element_step;	 ///< distance of two elements of a line
+			int line_step;		 ///< distance of the start of two lines within a group
+			int lines_per_group; ///< number of lines per group
+			int group_step;		 ///< distance of the start of two groups
+
+			/** Returns the index of the first element of line i */
+			inline long getStart(int i) const
+			{
+				return (long)(i / lines_per_group) * group_step + (long)(i % lines_per_group) * line_step;
+			}
+		};
+
+		/** Two lines of the image, stored as real and imaginary part of a complex line (one row) */
+		Image<Complex> m_line;
+
+		/** Fourier transform of m_line */
+		Image<Complex> m_spectrum;
+
+		/** Length for which m_weights has been computed (0: not computed yet) */
+		int m_weights_length;
+
+		/** Pre-computed weights for the line length m_weights_length.
+		 *
+		 * Line 0 contains c(k) * exp(-i*pi*k/2N) (forward transform),
+		 * line 1 contains exp(i*pi*k/2N) / (N * c(k)) (inverse transform).
+		 */
+		Image<Complex> m_weights;
+
+	public:
+		/** Constructor. */
+		inline DCT();
+
+		/** Two-dimensional DCT-II of the whole image.
+		 *
+		 * @param image Input - image in position space
+		 * @param dct_image Output - DCT coefficients (same size as image)
+		 */
+		inline void doDCT2D(const Image<float> &image, Image<float> &dct_image);
+
+		/** Two-dimensional DCT-III of the whole image (inverse of doDCT2D()).
+		 *
+		 * @param dct_image Input - DCT coefficients
+		 * @param image Output - image in position space
+		 */
+		inline void doInvDCT2D(const Image<float> &dct_image, Image<float> &image);
+
+		/** Block-wise two-dimensional DCT-II.
+		 *
+		 * The image is divided into non-overlapping blocks of size block_size*block_size,
+		 * each of which is transformed separately. The coefficients of a block are
+		 * written to the position of the block (as in JPEG).
+		 *
+		 * @param image Input - image in position space. Width and height must be multiples of block_size.
+		 * @param dct_image Output - DCT coefficients of the blocks
+		 * @param block_size edge length of the blocks (usually 8 or 16)
+		 */
+		inline void doBlockDCT2D(const Image<float> &image, Image<float> &dct_image, int block_size = 8);
+
+		/** Block-wise two-dimensional DCT-III (inverse of doBlockDCT2D()).
+		 *
+		 * @param dct_image Input - DCT coefficients of the blocks. Width and height must be multiples of block_size.
+		 * @param image Output - image in position space
+		 * @param block_size edge length of the blocks (usually 8 or 16)
+		 */
+		inline void doInvBlockDCT2D(const Image<float> &dct_image, Image<float> &image, int block_size = 8);
+
+	private:
+		/** Transforms the rows and afterwards the columns of the blocks of the image.
+		 *
+		 * A whole image transform is a block transform with a single block.
+		 */
+		inline void doTransform2D(const Image<float> &input, Image<float> &output,
+								  int block_width, int block_height, bool inverse);
+
+		/** Transforms all lines described by layout from src to dst (src==dst is allowed).
+		 *
+		 * @param fft Fourier transform without scaling, created for at least layout.length
+		 * @param inverse false: DCT-II, true: DCT-III
+		 */
+		inline void doTransformLines(FFT &fft, const float *src, float *dst, const LineLayout &layout, bool inverse);
+
+		/** Fourier transform (inverse: true for the inverse transform) of m_line into m_spectrum.
+		 *
+		 * The one-dimensional transforms of FFT only work on images with a single row,
+		 * so every pair of lines is transformed separately.
+		 */
+		inline void doTransformLine(FFT &fft, bool inverse);
+
+		/** Throws a GException, if n is not a power of two (method: name of the calling method). */
+		inline static void doCheckLength(int n, const char *method);
+
+		/** Computes m_weights for the line length n (only if the length has changed). */
+		inline void doPrecomputeWeights(int n);
+	};
+
+	/* ************************************************************************** */
+	/* *** Implementation of the INLINE methods ********************************* */
+	/* ************************************************************************** */
+
+	/* ************************************************************************** */
+	inline DCT::DCT() : m_line(),
+						m_spectrum(),
+						m_weights_length(0),
+						m_weights()
+	/* ************************************************************************** */
+	{
+	}
+
+	/* ************************************************************************** */
+	inline void DCT::doDCT2D(const Image<float> &image, Image<float> &dct_image)
+	/* ************************************************************************** */
+	{
+		doCheckLength(image.getWidth(), "DCT::doDCT2D( const Image<float> &image, Image<float> &dct_image )");
+		doCheckLength(image.getHeight(), "DCT::doDCT2D( const Image<float> &image, Image<float> &dct_image )");
+		doTransform2D(image, dct_image, image.getWidth(), image.getHeight(), false);
+	}
+
+	/* ************************************************************************** */
+	inline void DCT::doInvDCT2D(const Image<float> &dct_image, Image<float> &image)
+	/* ************************************************************************** */
+	{
+		doCheckLength(dct_image.getWidth(), "DCT::doInvDCT2D( const Image<float> &dct_image, Image<float> &image )");
+		doCheckLength(dct_image.getHeight(), "DCT::doInvDCT2D( const Image<float> &dct_image, Image<float> &image )");
+		doTransform2D(dct_image, image, dct_image.getWidth(), dct_image.getHeight(), true);
+	}
+
+	/* ************************************************************************** */
+	inline void DCT::doBlockDCT2D(const Image<float> &image, Image<float> &dct_image, int block_size)
+	/* ************************************************************************** */
+	{
+		if ((block_size <= 0) || (image.getWidth() % block_size != 0) || (image.getHeight() % block_size != 0))
+		{
+			throw GException(
+				"DCT::doBlockDCT2D( const Image<float> &image, Image<float> &dct_image, int block_size )",
+				"Width and height of the image must be multiples of the block size.");
+		}
+		doCheckLength(block_size, "DCT::doBlockDCT2D( const Image<float> &image, Image<float> &dct_image, int block_size )");
+		doTransform2D(image, dct_image, block_size, block_size, false);
+	}
+
+	/* ************************************************************************** */
+	inline void DCT::doInvBlockDCT2D(const Image<float> &dct_image, Image<float> &image, int block_size)
+	/* ************************************************************************** */
+	{
+		if ((block_size <= 0) || (dct_image.getWidth() % block_size != 0) || (dct_image.getHeight() % block_size != 0))
+		{
+			throw GException(
+				"DCT::doInvBlockDCT2D( const Image<float> &dct_image, Image<float> &image, int block_size )",
+				"Width and height of the image must be multiples of the block size.");
+		}
+		doCheckLength(block_size, "DCT::doInvBlockDCT2D( const Image<float> &dct_image, Image<float> &image, int block_size )");
+		doTransform2D(dct_image, image, block_size, block_size, true);
+	}
+
+	/* ************************************************************************** */
+	inline void DCT::doTransform2D(const Image<float> &input, Image<float> &output,
+								   int block_width, int block_height, bool inverse)
+	/* ************************************************************************** */
+	{
+		int width = input.getWidth();
+		int height = input.getHeight();
+
+		if ((output.getWidth() != width) || (output.getHeight() != height))
+		{
+			output.resize(width, height);
+		}
+		if ((width == 0) || (height == 0))
+			return;
+
+		// Created for the longest line, so that the sine table is not recomputed during the transform
+		FFT fft(std::max(block_width, block_height), DFT::NOSCALING);
+
+		//
+		// Rows of the blocks: the row segments of all blocks lie one after the other
+		// without a gap, so they form lines of length block_width with step block_width
+		//
+		LineLayout rows;
+		rows.length = block_width;
+		rows.count = (width / block_width) * height;
+		rows.element_step = 1;
+		rows.line_step = block_width;
+		rows.lines_per_group = rows.count;
+		rows.group_step = 0;
+
+		doTransformLines(fft, input.getData(), output.getData(), rows, inverse);
+
+		//
+		// Columns of the blocks: one group of width columns per row of blocks
+		//
+		LineLayout columns;
+		columns.length = block_height;
+		columns.count = width * (height / block_height);
+		columns.element_step = width;
+		columns.line_step = 1;
+		columns.lines_per_group = width;
+		columns.group_step = width * block_height;
+
+		doTransformLines(fft, output.getData(), output.getData(), columns, inverse);
+	}
+
+	/* ************************************************************************** */
+	inline void DCT::doTransformLines(FFT &fft, const float *src, float *dst, const LineLayout &layout, bool inverse)
+	/* ************************************************************************** */
+	{
+		int n = layout.length;
+		int pairs = (layout.count + 1) / 2;
+		int estep = layout.element_step;
+
+		doPrecomputeWeights(n);
+		if (m_line.getWidth() != n)
+		{
+			m_line.resize(n, 1);
+		}
+
+		const Complex *weights = m_weights.getData() + (inverse ? n : 0);
+
+		for (int p = 0; p < pairs; ++p)
+		{
+			//
+			// Gather: two lines as real and imaginary part of one complex line
+			//
+			Complex *z = m_line.getData();
+			const float *a = src + layout.getStart(2 * p);
+			const float *b = (2 * p + 1 < layout.count) ? src + layout.getStart(2 * p + 1) : NULL;
+
+			if (!inverse)
+			{
+				// Makhoul reordering: even elements ascending, odd elements descending
+				for (int i = 0; i < n; ++i)
+				{
+					int j = (i < (n + 1) / 2) ? 2 * i : 2 * (n - 1 - i) + 1;
+					z[i].re = a[(long)j * estep];
+					z[i].im = b ? b[(long)j * estep] : 0.0f;
+				}
+			}
+			else
+			{
+				// V(k) = w(k) * (Y(k) - i*Y(N-k)) with Y(N)=0 for both lines
+				for (int k = 0; k < n; ++k)
+				{
+					float ya = a[(long)k * estep];
+					float yna = (k == 0) ? 0.0f : a[(long)(n - k) * estep];
+					float yb = b ? b[(long)k * estep] : 0.0f;
+					float ynb = (b && k != 0) ? b[(long)(n - k) * estep] : 0.0f;
+					const Complex &w = weights[k];
+
+					// Va = w*(ya - i*yna), Vb = w*(yb - i*ynb); z = Va + i*Vb
+					float va_re = w.re * ya + w.im * yna;
+					float va_im = w.im * ya - w.re * yna;
+					float vb_re = w.re * yb + w.im * ynb;
+					float vb_im = w.im * yb - w.re * ynb;
+					z[k].re = va_re - vb_im;
+					z[k].im = va_im + vb_re;
+				}
+			}
+
+			//
+			// One-dimensional Fourier transform of the line
+			//
+			doTransformLine(fft, inverse);
+
+			//
+			// Scatter
+			//
+			z = m_spectrum.getData();
+			float *da = dst + layout.getStart(2 * p);
+			float *db = b ? dst + layout.getStart(2 * p + 1) : NULL;
+
+			if (!inverse)
+			{
+				// Separate the spectra of both real lines and apply the weights
+				for (int k = 0; k < n; ++k)
+				{
+					const Complex &zk = z[k];
+					const Complex &znk = z[(n - k) % n];
+					const Complex &w = weights[k];
+
+					// Va = (Z(k) + conj(Z(N-k))) / 2, Vb = (Z(k) - conj(Z(N-k))) / 2i
+					float va_re = 0.5f * (zk.re + znk.re);
+					float va_im = 0.5f * (zk.im - znk.im);
+					float vb_re = 0.5f * (zk.im + znk.im);
+					float vb_im = -0.5f * (zk.re - znk.re);
+
+					da[(long)k * estep] = w.re * va_re - w.im * va_im;
+					if (db)
+						db[(long)k * estep] = w.re * vb_re - w.im * vb_im;
+				}
+			}
+			else
+			{
+				// Undo the Makhoul reordering
+				for (int i = 0; i < n; ++i)
+				{
+					int j = (i < (n + 1) / 2) ? 2 * i : 2 * (n - 1 - i) + 1;
+					da[(long)j * estep] = z[i].re;
+					if (db)
+						db[(long)j * estep] = z[i].im;
+				}
+			}
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void DCT::doTransformLine(FFT &fft, bool inverse)
+	/* ************************************************************************** */
+	{
+		if (!inverse)
+			fft.doFourierTransform(m_line, m_spectrum);
+		else
+			fft.doInvFourierTransform(m_line, m_spectrum);
+	}
+
+	/* ************************************************************************** */
+	inline void DCT::doCheckLength(int n, const char *method)
+	/* ************************************************************************** */
+	{
+		if ((n & (n - 1)) != 0)
+		{
+			throw GException(method, "Only transformation lengths which are powers of two are supported.");
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void DCT::doPrecomputeWeights(int n)
+	/* ************************************************************************** */
+	{
+		if (m_weights_length == n)
+			return;
+
+		m_weights.resize(n, 2);
+		Complex *forward = m_weights.getData();
+		Complex *inverse = forward + n;
+
+		for (int k = 0; k < n; ++k)
+		{
+			double c = (k == 0) ? sqrt(1.0 / n) : sqrt(2.0 / n);
+			double phi = M_PI * k / (2.0 * n);
+
+			forward[k].re = (float)(c * cos(phi));
+			forward[k].im = (float)(-c * sin(phi));
+
+			inverse[k].re = (float)(cos(phi) / (n * c));
+			inverse[k].im = (float)(sin(phi) / (n * c));
+		}
+
+		m_weights_length = n;
+	}
+
+} /* namespace GET */
@@ -90,9 +90,11 @@ public:
 	/* *********************************************** */
 	/* Take over arithmetic operations from GET::Image<> */
 	/* *********************************************** */
+	// The reference cast selects Image<float>::add( const Image<float>& ) instead of the
+	// template for scalar values, without copying the image.
 	GrayImage &add(const GrayImage &image)
 	{
-		GET::Image<float>::add((GET::Image<float>)image);
+		GET::Image<float>::add(static_cast<const GET::Image<float> &>(image));
 		return *this;
 	};
 	GrayImage &add(float val)
@@ -102,7 +104,7 @@ public:
 	};
 	GrayImage &sub(const GrayImage &image)
 	{
-		GET::Image<float>::sub((GET::Image<float>)image);
+		GET::Image<float>::sub(static_cast<const GET::Image<float> &>(image));
 		return *this;
 	};
 	GrayImage &sub(float val)
@@ -112,7 +114,7 @@ public:
 	};
 	GrayImage &mul(const GrayImage &image)
 	{
-		GET::Image<float>::mul((GET::Image<float>)image);
+		GET::Image<float>::mul(static_cast<const GET::Image<float> &>(image));
 		return *this;
 	};
 	GrayImage &mul(float val)
@@ -122,7 +124,7 @@ public:
 	};
 	GrayImage &div(const GrayImage &image)
 	{
-		GET::Image<float>::div((GET::Image<float>)image);
+		GET::Image<float>::div(static_cast<const GET::Image<float> &>(image));
 		return *this;
 	};
 	GrayImage &div(float val)
@@ -166,6 +168,50 @@ public:
 	 * Displays the image on the screen.
 	 */
 	void show();
+
+	/* *********************************************** */
+	/* Take over arithmetic operations from GET::Image<> */
+	/* *********************************************** */
+	// The wrappers below would hide all other overloads of the base class (e.g. add( img1, img2 ))
+	using GET::Image<Complex>::add;
+	using GET::Image<Complex>::sub;
+	using GET::Image<Complex>::mul;
+
+	ComplexImage &add(const ComplexImage &image)
+	{
+		GET::Image<Complex>::add(static_cast<const GET::Image<Complex> &>(image));
+		return *this;
+	};
+	ComplexImage &add(Complex val)
+	{
+		GET::Image<Complex>::add(val);
+		return *this;
+	};
+	ComplexImage &sub(const ComplexImage &image)
+	{
+		GET::Image<Complex>::sub(static_cast<const GET::Image<Complex> &>(image));
+		return *this;
+	};
+	ComplexImage &sub(Complex val)
+	{
+		GET::Image<Complex>::sub(val);
+		return *this;
+	};
+	ComplexImage &mul(const ComplexImage &image)
+	{
+		GET::Image<Complex>::mul(static_cast<const GET::Image<Complex> &>(image));
+		return *this;
+	};
+	ComplexImage &mul(Complex val)
+	{
+		GET::Image<Complex>::mul(val);
+		return *this;
+	};
+	ComplexImage &mul(float val)
+	{
+		GET::Image<Complex>::mul(val);
+		return *this;
+	};
 };
 
 using GET::Rgb;
@@ -218,6 +264,25 @@ public:
 	 * Saves the image under a name that can be selected in a file dialog.
 	 */
 	void save();
+
+	/* *********************************************** */
+	/* Take over arithmetic operations from GET::Image<> */
+	/* *********************************************** */
+	// The wrappers below would hide all other overloads of the base class (e.g. add( img1, img2 ))
+	using GET::Image<Rgb>::add;
+	using GET::Image<Rgb>::sub;
+	using GET::Image<Rgb>::mul;
+
+	RgbImage &add(const RgbImage &image)
+	{
+		GET::Image<Rgb>::add(static_cast<const GET::Image<Rgb> &>(image));
+		return *this;
+	};
+	RgbImage &sub(const RgbImage &image)
+	{
+		GET::Image<Rgb>::sub(static_cast<const GET::Image<Rgb> &>(image));
+		return *this;
+	};
 };
 
 using GET::Hsv;
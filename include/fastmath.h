@@ -0,0 +1,618 @@
+#pragma once
+
+#include <math.h>
+#include <string.h>
+#include <float.h>
+#include <stddef.h>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#if (__cplusplus >= 201103L)
+#include <atomic>
+#define GET_FASTMATH_ATOMIC_ACCURACY
+#endif
+
+namespace GET
+{
+
+	/** Fast approximations of elementary functions for pixel kernels.
+	 *
+	 * The functions of the C library (expf, logf, powf, atan2f, sinf, cosf) are computed for one
+	 * value at a time and handle many special cases. The approximations of this class use a
+	 * range reduction and a short polynomial (coefficients from the Cephes library) and process
+	 * 4 values per SSE2 instruction in the array kernels (doExp(), doLog(), ...). The scalar
+	 * functions (exp(), log(), ...) compute exactly the same values as the array kernels.
+	 *
+	 * Maximum errors (measured against double precision over the given ranges):
+	 *
+	 * - exp:   relative error < 1.5e-7 for x in [-87, 88]; x is clamped to [-87.34, 88.72]
+	 * - log:   absolute error < 1e-7 for x in [1/2, 2], relative error < 1e-7 otherwise;
+	 *          log(0) = -inf, log(x < 0) = NaN, arguments below FLT_MIN (denormals) give -inf
+	 * - pow:   relative error < (1 + |y * log(x)|) * 2.5e-7 (x > 0); pow(0, y) = 0 for y > 0, NaN for x < 0
+	 * - atan2: absolute error < 3e-7; atan2(0, 0) = 0
+	 * - sqrt:  relative error < 4e-7 (reciprocal square root estimate and one Newton step)
+	 * - sin, cos: absolute error < 1e-7 for |x| <= 8192 (the range reduction loses accuracy for larger |x|)
+	 *
+	 * The array kernels are only approximations if the accuracy has been switched to FAST with
+	 * setAccuracy() (opt-in). With the default ACCURATE they use the functions of the C library, so the
+	 * results of existing code do not change unless FAST is chosen explicitly.
+	 *
+	 * doPowInt() (integer exponents, e.g. Butterworth filters) is independent of this switch, since
+	 * exponentiation by squaring is both faster and at least as accurate as powf().
+	 */
+	class FastMath
+	{
+	public:
+		/** Accuracy of the array kernels */
+		enum Accuracy
+		{
+			ACCURATE, ///< functions of the C library (default)
+			FAST	  ///< approximations (see error bounds above)
+		};
+
+		/** Sets the accuracy of the array kernels (for all threads).
+		 *
+		 * The switch is atomic with C++11, i.e. it may be changed while other threads run kernels
+		 * (each call of a kernel uses the accuracy it reads at its start). Without C++11 it must
+		 * be set before other threads are started.
+		 *
+		 * @param accuracy new accuracy
+		 */
+		static inline void setAccuracy(Accuracy accuracy) { getAccuracyStorage() = accuracy; };
+
+		/** Returns the accuracy of the array kernels. */
+		static inline Accuracy getAccuracy() { return (Accuracy)(int)getAccuracyStorage(); };
+
+		/** Approximation of e^x */
+		static inline float exp(float x);
+
+		/** Approximation of the natural logarithm */
+		static inline float log(float x);
+
+		/** Approximation of x^y */
+		static inline float pow(float x, float y);
+
+		/** Approximation of atan2(y, x) */
+		static inline float atan2(float y, float x);
+
+		/** Approximation of the square root */
+		static inline float sqrt(float x);
+
+		/** Approximation of sin(x) and cos(x) */
+		static inline void sincos(float x, float &sine, float &cosine);
+
+		/** Approximation of sin(x) */
+		static inline float sin(float x)
+		{
+			float sine, cosine;
+			sincos(x, sine, cosine);
+			return sine;
+		};
+
+		/** Approximation of cos(x) */
+		static inline float cos(float x)
+		{
+			float sine, cosine;
+			sincos(x, sine, cosine);
+			return cosine;
+		};
+
+		/** result[i] = e^input[i] (result may be input) */
+		static inline void doExp(const float *input, float *result, ptrdiff_t size);
+
+		/** result[i] = log(input[i]) (result may be input) */
+		static inline void doLog(const float *input, float *result, ptrdiff_t size);
+
+		/** result[i] = input[i]^exponent (result may be input) */
+		static inline void doPow(const float *input, float exponent, float *result, ptrdiff_t size);
+
+		/** result[i] = input[i]^exponent by exponentiation by squaring (independent of getAccuracy(); result may be input) */
+		static inline void doPowInt(const float *input, int exponent, float *result, ptrdiff_t size);
+
+		/** result[i] = atan2(y[i], x[i]) (result may be y or x) */
+		static inline void doAtan2(const float *y, const float *x, float *result, ptrdiff_t size);
+
+		/** result[i] = sqrt(input[i]) (result may be input) */
+		static inline void doSqrt(const float *input, float *result, ptrdiff_t size);
+
+		/** sine[i] = sin(input[i]), cosine[i] = cos(input[i]) (one of the results may be input) */
+		static inline void doSinCos(const float *input, float *sine, float *cosine, ptrdiff_t size);
+
+	private:
+#ifdef GET_FASTMATH_ATOMIC_ACCURACY
+		typedef std::atomic<int> AccuracyStorage;
+#else
+		typedef int AccuracyStorage;
+#endif
+
+		/** Storage of the accuracy */
+		static inline AccuracyStorage &getAccuracyStorage()
+		{
+			static AccuracyStorage accuracy(ACCURATE);
+			return accuracy;
+		};
+
+		/** Reinterprets the bits of a float as int */
+		static inline int getBits(float x)
+		{
+			int bits;
+			memcpy(&bits, &x, sizeof(bits));
+			return bits;
+		};
+
+		/** Reinterprets the bits of an int as float */
+		static inline float getFloat(int bits)
+		{
+			float x;
+			memcpy(&x, &bits, sizeof(x));
+			return x;
+		};
+
+		/** x^n for n >= 0 by exponentiation by squaring */
+		static inline float getPowInt(float x, unsigned int n)
+		{
+			float result = 1.0f;
+			while (n)
+			{
+				if (n & 1)
+					result *= x;
+				x *= x;
+				n >>= 1;
+			}
+			return result;
+		};
+
+#if defined(__SSE2__)
+		/** 4 values of exp() */
+		static inline __m128 getExp4(__m128 x);
+
+		/** 4 values of log() */
+		static inline __m128 getLog4(__m128 x);
+
+		/** 4 values of atan2() */
+		static inline __m128 getAtan2_4(__m128 y, __m128 x);
+
+		/** 4 values of sqrt() */
+		static inline __m128 getSqrt4(__m128 x);
+
+		/** 4 values of sin() and cos() */
+		static inline void getSinCos4(__m128 x, __m128 &sine, __m128 &cosine);
+
+		/** mask ? a : b */
+		static inline __m128 doSelect(__m128 mask, __m128 a, __m128 b)
+		{
+			return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+		};
+#endif
+	};
+
+	/* ************************************************************************** */
+	/* *** Implementation of the inline methods ********************************* */
+	/* ************************************************************************** */
+
+	/* ************************************************************************** */
+	inline float FastMath::exp(float x)
+	/* ************************************************************************** */
+	{
+		// e^x = 2^n * e^r with |r| <= ln(2)/2
+		x = fminf(fmaxf(x, -87.336544f), 88.722839f);
+		float n = (float)lrintf(x * 1.44269504088896341f);
+		float r = x - n * 0.693359375f + n * 2.12194440e-4f;
+		float z = r * r;
+		float y = ((((1.9875691500e-4f * r + 1.3981999507e-3f) * r + 8.3334519073e-3f) * r + 4.1665795894e-2f) * r + 1.6666665459e-1f) * r + 5.0000001201e-1f;
+		y = y * z + r + 1.0f;
+
+		// 2^n in two factors (n may be 128)
+		int n1 = (int)n >> 1;
+		int n2 = (int)n - n1;
+		return y * getFloat((n1 + 127) << 23) * getFloat((n2 + 127) << 23);
+	}
+
+	/* ************************************************************************** */
+	inline float FastMath::log(float x)
+	/* ************************************************************************** */
+	{
+		// Special cases: x < FLT_MIN (-inf or NaN for x < 0), +inf and NaN
+		if (!((x >= FLT_MIN) && (x <= FLT_MAX)))
+			return ((x != x) || (x > FLT_MAX)) ? x : ((x < 0.0f) ? NAN : -INFINITY);
+
+		// x = m * 2^e with m in [sqrt(2)/2, sqrt(2))
+		int bits = getBits(x);
+		float e = (float)((bits >> 23) - 127);
+		float m = getFloat((bits & 0x007fffff) | 0x3f800000);
+		if (m > 1.41421356f)
+		{
+			m *= 0.5f;
+			e += 1.0f;
+		}
+		m -= 1.0f;
+
+		float z = m * m;
+		float y = (((((((7.0376836292e-2f * m - 1.1514610310e-1f) * m + 1.1676998740e-1f) * m - 1.2420140846e-1f) * m + 1.4249322787e-1f) * m - 1.6668057665e-1f) * m + 2.0000714765e-1f) * m - 2.4999993993e-1f) * m + 3.3333331174e-1f;
+		y = y * m * z;
+		y += -2.12194440e-4f * e;
+		y += -0.5f * z;
+		return m + y + 0.693359375f * e;
+	}
+
+	/* ************************************************************************** */
+	inline float FastMath::pow(float x, float y)
+	/* ************************************************************************** */
+	{
+		if (x == 0.0f)
+			return (y > 0.0f) ? 0.0f : ((y == 0.0f) ? 1.0f : INFINITY);
+		return exp(y * log(x));
+	}
+
+	/* ************************************************************************** */
+	inline float FastMath::atan2(float y, float x)
+	/* ************************************************************************** */
+	{
+		float ax = fabsf(x);
+		float ay = fabsf(y);
+		float maximum = fmaxf(ax, ay);
+		float t = (maximum > 0.0f) ? fminf(ax, ay) / maximum : 0.0f;
+
+		// Reduction to |t| <= tan(pi/8)
+		float offset = 0.0f;
+		if (t > 0.41421356f)
+		{
+			t = (t - 1.0f) / (t + 1.0f);
+			offset = 0.78539816f;
+		}
+
+		float z = t * t;
+		float a = (((8.05374449538e-2f * z - 1.38776856032e-1f) * z + 1.99777106478e-1f) * z - 3.33329491539e-1f) * z * t + t + offset;
+
+		if (ay > ax)
+			a = 1.57079633f - a;
+		if (x < 0.0f)
+			a = 3.14159265f - a;
+		return (y < 0.0f) ? -a : a;
+	}
+
+	/* ************************************************************************** */
+	inline float FastMath::sqrt(float x)
+	/* ************************************************************************** */
+	{
+#if defined(__SSE2__)
+		return _mm_cvtss_f32(getSqrt4(_mm_set_ss(x)));
+#else
+		return sqrtf(x);
+#endif
+	}
+
+	/* ************************************************************************** */
+	inline void FastMath::sincos(float x, float &sine, float &cosine)
+	/* ************************************************************************** */
+	{
+		// x = n * pi/2 + r with |r| <= pi/4 (Cody-Waite reduction)
+		float n = (float)lrintf(x * 0.63661977236758134f);
+		float r = ((x - n * 1.5703125f) - n * 4.837512969970703125e-4f) - n * 7.549789948768648e-8f;
+		float z = r * r;
+
+		float s = ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f) * z * r + r;
+		float c = ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f) * z * z - 0.5f * z + 1.0f;
+
+		switch ((int)n & 3)
+		{
+		case 0:
+			sine = s;
+			cosine = c;
+			break;
+		case 1:
+			sine = c;
+			cosine = -s;
+			break;
+		case 2:
+			sine = -s;
+			cosine = -c;
+			break;
+		default:
+			sine = -c;
+			cosine = s;
+			break;
+		}
+	}
+
+#if defined(__SSE2__)
+	/* ************************************************************************** */
+	inline __m128 FastMath::getExp4(__m128 x)
+	/* ************************************************************************** */
+	{
+		x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-87.336544f)), _mm_set1_ps(88.722839f));
+		__m128i ni = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)));
+		__m128 n = _mm_cvtepi32_ps(ni);
+		__m128 r = _mm_add_ps(_mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(0.693359375f))), _mm_mul_ps(n, _mm_set1_ps(2.12194440e-4f)));
+		__m128 z = _mm_mul_ps(r, r);
+		__m128 y = _mm_set1_ps(1.9875691500e-4f);
+		y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(1.3981999507e-3f));
+		y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(8.3334519073e-3f));
+		y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(4.1665795894e-2f));
+		y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(1.6666665459e-1f));
+		y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(5.0000001201e-1f));
+		y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(y, z), r), _mm_set1_ps(1.0f));
+
+		__m128i n1 = _mm_srai_epi32(ni, 1);
+		__m128i n2 = _mm_sub_epi32(ni, n1);
+		__m128i bias = _mm_set1_epi32(127);
+		y = _mm_mul_ps(y, _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(n1, bias), 23)));
+		return _mm_mul_ps(y, _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(n2, bias), 23)));
+	}
+
+	/* ************************************************************************** */
+	inline __m128 FastMath::getLog4(__m128 x)
+	/* ************************************************************************** */
+	{
+		__m128i bits = _mm_castps_si128(x);
+		__m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+		__m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f800000)));
+		__m128 large = _mm_cmpgt_ps(m, _mm_set1_ps(1.41421356f));
+		m = doSelect(large, _mm_mul_ps(m, _mm_set1_ps(0.5f)), m);
+		e = _mm_add_ps(e, _mm_and_ps(large, _mm_set1_ps(1.0f)));
+		m = _mm_sub_ps(m, _mm_set1_ps(1.0f));
+
+		__m128 z = _mm_mul_ps(m, m);
+		__m128 y = _mm_set1_ps(7.0376836292e-2f);
+		y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.1514610310e-1f));
+		y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(1.1676998740e-1f));
+		y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.2420140846e-1f));
+		y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(1.4249322787e-1f));
+		y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.6668057665e-1f));
+		y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(2.0000714765e-1f));
+		y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-2.4999993993e-1f));
+		y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(3.3333331174e-1f));
+		y = _mm_mul_ps(_mm_mul_ps(y, m), z);
+		y = _mm_add_ps(y, _mm_mul_ps(_mm_set1_ps(-2.12194440e-4f), e));
+		y = _mm_add_ps(y, _mm_mul_ps(_mm_set1_ps(-0.5f), z));
+		__m128 result = _mm_add_ps(_mm_add_ps(m, y), _mm_mul_ps(_mm_set1_ps(0.693359375f), e));
+
+		// Special cases: x < FLT_MIN (-inf or NaN for x < 0), +inf and NaN
+		__m128 valid = _mm_and_ps(_mm_cmpge_ps(x, _mm_set1_ps(FLT_MIN)), _mm_cmple_ps(x, _mm_set1_ps(FLT_MAX)));
+		__m128 special = doSelect(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_set1_ps(NAN), _mm_set1_ps(-INFINITY));
+		special = doSelect(_mm_cmpgt_ps(x, _mm_set1_ps(FLT_MAX)), x, special);
+		special = doSelect(_mm_cmpunord_ps(x, x), x, special);
+		return doSelect(valid, result, special);
+	}
+
+	/* ************************************************************************** */
+	inline __m128 FastMath::getAtan2_4(__m128 y, __m128 x)
+	/* ************************************************************************** */
+	{
+		__m128 sign_mask = _mm_set1_ps(-0.0f);
+		__m128 ax = _mm_andnot_ps(sign_mask, x);
+		__m128 ay = _mm_andnot_ps(sign_mask, y);
+		__m128 maximum = _mm_max_ps(ax, ay);
+		__m128 nonzero = _mm_cmpgt_ps(maximum, _mm_setzero_ps());
+		__m128 t = _mm_and_ps(nonzero, _mm_div_ps(_mm_min_ps(ax, ay), doSelect(nonzero, maximum, _mm_set1_ps(1.0f))));
+
+		__m128 reduce = _mm_cmpgt_ps(t, _mm_set1_ps(0.41421356f));
+		__m128 one = _mm_set1_ps(1.0f);
+		t = doSelect(reduce, _mm_div_ps(_mm_sub_ps(t, one), _mm_add_ps(t, one)), t);
+		__m128 offset = _mm_and_ps(reduce, _mm_set1_ps(0.78539816f));
+
+		__m128 z = _mm_mul_ps(t, t);
+		__m128 a = _mm_set1_ps(8.05374449538e-2f);
+		a = _mm_add_ps(_mm_mul_ps(a, z), _mm_set1_ps(-1.38776856032e-1f));
+		a = _mm_add_ps(_mm_mul_ps(a, z), _mm_set1_ps(1.99777106478e-1f));
+		a = _mm_add_ps(_mm_mul_ps(a, z), _mm_set1_ps(-3.33329491539e-1f));
+		a = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(a, z), t), t), offset);
+
+		a = doSelect(_mm_cmpgt_ps(ay, ax), _mm_sub_ps(_mm_set1_ps(1.57079633f), a), a);
+		a = doSelect(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps(3.14159265f), a), a);
+		return doSelect(_mm_cmplt_ps(y, _mm_setzero_ps()), _mm_xor_ps(a, sign_mask), a);
+	}
+
+	/* ************************************************************************** */
+	inline __m128 FastMath::getSqrt4(__m128 x)
+	/* ************************************************************************** */
+	{
+		// sqrt(x) = x / sqrt(x) with one Newton step for the reciprocal square root
+		__m128 estimate = _mm_rsqrt_ps(x);
+		__m128 correction = _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), x), _mm_mul_ps(estimate, estimate)));
+		__m128 result = _mm_mul_ps(x, _mm_mul_ps(estimate, correction));
+
+		// sqrt(0) = 0, sqrt(inf) = inf
+		__m128 special = _mm_or_ps(_mm_cmpeq_ps(x, _mm_setzero_ps()), _mm_cmpeq_ps(x, _mm_set1_ps(INFINITY)));
+		return doSelect(special, x, result);
+	}
+
+	/* ************************************************************************** */
+	inline void FastMath::getSinCos4(__m128 x, __m128 &sine, __m128 &cosine)
+	/* ************************************************************************** */
+	{
+		__m128i ni = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(0.63661977236758134f)));
+		__m128 n = _mm_cvtepi32_ps(ni);
+		__m128 r = _mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(1.5703125f)));
+		r = _mm_sub_ps(r, _mm_mul_ps(n, _mm_set1_ps(4.837512969970703125e-4f)));
+		r = _mm_sub_ps(r, _mm_mul_ps(n, _mm_set1_ps(7.549789948768648e-8f)));
+		__m128 z = _mm_mul_ps(r, r);
+
+		__m128 s = _mm_set1_ps(-1.9515295891e-4f);
+		s = _mm_add_ps(_mm_mul_ps(s, z), _mm_set1_ps(8.3321608736e-3f));
+		s = _mm_add_ps(_mm_mul_ps(s, z), _mm_set1_ps(-1.6666654611e-1f));
+		s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, z), r), r);
+
+		__m128 c = _mm_set1_ps(2.443315711809948e-5f);
+		c = _mm_add_ps(_mm_mul_ps(c, z), _mm_set1_ps(-1.388731625493765e-3f));
+		c = _mm_add_ps(_mm_mul_ps(c, z), _mm_set1_ps(4.166664568298827e-2f));
+		c = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(_mm_mul_ps(c, z), z), _mm_mul_ps(_mm_set1_ps(0.5f), z)), _mm_set1_ps(1.0f));
+
+		// Quadrant: odd quadrants swap sine and cosine, quadrants 2,3 negate the sine, 1,2 the cosine
+		__m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(ni, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+		__m128 sine_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(ni, _mm_set1_epi32(2)), 30));
+		__m128 cosine_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(ni, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+		sine = _mm_xor_ps(doSelect(swap, c, s), sine_sign);
+		cosine = _mm_xor_ps(doSelect(swap, s, c), cosine_sign);
+	}
+#endif
+
+	/* ************************************************************************** */
+	inline void FastMath::doExp(const float *input, float *result, ptrdiff_t size)
+	/* ************************************************************************** */
+	{
+		ptrdiff_t i = 0;
+		if (getAccuracy() == FAST)
+		{
+#if defined(__SSE2__)
+			for (; i + 4 <= size; i += 4)
+				_mm_storeu_ps(result + i, getExp4(_mm_loadu_ps(input + i)));
+#endif
+			for (; i < size; ++i)
+				result[i] = exp(input[i]);
+		}
+		else
+			for (; i < size; ++i)
+				result[i] = expf(input[i]);
+	}
+
+	/* ************************************************************************** */
+	inline void FastMath::doLog(const float *input, float *result, ptrdiff_t size)
+	/* ************************************************************************** */
+	{
+		ptrdiff_t i = 0;
+		if (getAccuracy() == FAST)
+		{
+#if defined(__SSE2__)
+			for (; i + 4 <= size; i += 4)
+				_mm_storeu_ps(result + i, getLog4(_mm_loadu_ps(input + i)));
+#endif
+			for (; i < size; ++i)
+				result[i] = log(input[i]);
+		}
+		else
+			for (; i < size; ++i)
+				result[i] = logf(input[i]);
+	}
+
+	/* ************************************************************************** */
+	inline void FastMath::doPow(const float *input, float exponent, float *result, ptrdiff_t size)
+	/* ************************************************************************** */
+	{
+		ptrdiff_t i = 0;
+		if (getAccuracy() == FAST)
+		{
+#if defined(__SSE2__)
+			__m128 exponent4 = _mm_set1_ps(exponent);
+			__m128 zero_result = _mm_set1_ps(pow(0.0f, exponent));
+			for (; i + 4 <= size; i += 4)
+			{
+				__m128 x = _mm_loadu_ps(input + i);
+				__m128 y = getExp4(_mm_mul_ps(exponent4, getLog4(x)));
+				_mm_storeu_ps(result + i, doSelect(_mm_cmpeq_ps(x, _mm_setzero_ps()), zero_result, y));
+			}
+#endif
+			for (; i < size; ++i)
+				result[i] = pow(input[i], exponent);
+		}
+		else
+			for (; i < size; ++i)
+				result[i] = powf(input[i], exponent);
+	}
+
+	/* ************************************************************************** */
+	inline void FastMath::doPowInt(const float *input, int exponent, float *result, ptrdiff_t size)
+	/* ************************************************************************** */
+	{
+		unsigned int n = (exponent < 0) ? -(unsigned int)exponent : (unsigned int)exponent;
+		ptrdiff_t i = 0;
+
+#if defined(__SSE2__)
+		for (; i + 4 <= size; i += 4)
+		{
+			__m128 x = _mm_loadu_ps(input + i);
+			__m128 y = _mm_set1_ps(1.0f);
+			for (unsigned int k = n; k; k >>= 1)
+			{
+				if (k & 1)
+					y = _mm_mul_ps(y, x);
+				x = _mm_mul_ps(x, x);
+			}
+			if (exponent < 0)
+				y = _mm_div_ps(_mm_set1_ps(1.0f), y);
+			_mm_storeu_ps(result + i, y);
+		}
+#endif
+		for (; i < size; ++i)
+		{
+			float y = getPowInt(input[i], n);
+			result[i] = (exponent < 0) ? 1.0f / y : y;
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void FastMath::doAtan2(const float *y, const float *x, float *result, ptrdiff_t size)
+	/* ************************************************************************** */
+	{
+		ptrdiff_t i = 0;
+		if (getAccuracy() == FAST)
+		{
+#if defined(__SSE2__)
+			for (; i + 4 <= size; i += 4)
+				_mm_storeu_ps(result + i, getAtan2_4(_mm_loadu_ps(y + i), _mm_loadu_ps(x + i)));
+#endif
+			for (; i < size; ++i)
+				result[i] = atan2(y[i], x[i]);
+		}
+		else
+			for (; i < size; ++i)
+				result[i] = atan2f(y[i], x[i]);
+	}
+
+	/* ************************************************************************** */
+	inline void FastMath::doSqrt(const float *input, float *result, ptrdiff_t size)
+	/* ************************************************************************** */
+	{
+		ptrdiff_t i = 0;
+		bool fast = (getAccuracy() == FAST);
+#if defined(__SSE2__)
+		if (fast)
+		{
+			for (; i + 4 <= size; i += 4)
+				_mm_storeu_ps(result + i, getSqrt4(_mm_loadu_ps(input + i)));
+		}
+		else
+		{
+			// The square root instruction is exact and already vectorised
+			for (; i + 4 <= size; i += 4)
+				_mm_storeu_ps(result + i, _mm_sqrt_ps(_mm_loadu_ps(input + i)));
+		}
+#endif
+		for (; i < size; ++i)
+			result[i] = fast ? sqrt(input[i]) : sqrtf(input[i]);
+	}
+
+	/* ************************************************************************** */
+	inline void FastMath::doSinCos(const float *input, float *sine, float *cosine, ptrdiff_t size)
+	/* ************************************************************************** */
+	{
+		ptrdiff_t i = 0;
+		if (getAccuracy() == FAST)
+		{
+#if defined(__SSE2__)
+			for (; i + 4 <= size; i += 4)
+			{
+				__m128 s, c;
+				getSinCos4(_mm_loadu_ps(input + i), s, c);
+				_mm_storeu_ps(sine + i, s);
+				_mm_storeu_ps(cosine + i, c);
+			}
+#endif
+			for (; i < size; ++i)
+			{
+				float x = input[i];
+				sincos(x, sine[i], cosine[i]);
+			}
+		}
+		else
+			for (; i < size; ++i)
+			{
+				float x = input[i];
+				sine[i] = sinf(x);
+				cosine[i] = cosf(x);
+			}
+	}
+
+} /* namespace GET */
@@ -2,11 +2,38 @@
 #define __GET__FREQUENCYDOMAINFILTERING_BASETEMPLATE_H
 
 #include "image.h"
+#include "complexkernels.h"
+#include "fastmath.h"
+#include "imagesequence.h"
+#include "parallel.h"
 #include "fft.h"
+#include "splitfft.h"
+#include "spectrumcache.h"
+
+#include <algorithm>
+#include <vector>
 
 namespace GET
 {
 
+	/**
+	 * Traeger einer Filtermaske im Frequenzraum.
+	 *
+	 * Rechteck [x0,x1) x [y0,y1), ausserhalb dessen alle Werte einer (zentrierten) Filtermaske
+	 * vernachlaessigbar sind. Bandpass-Filter wie Gabor-Filter sind nur in einem kleinen Bereich
+	 * des Frequenzraums ungleich 0, die Filterung muss daher nur innerhalb dieses Bereichs
+	 * berechnet werden.
+	 *
+	 * @see FrequencyDomainFilteringBaseTemplate::doComputeSupport()
+	 */
+	struct SpectralSupport
+	{
+		int x0; ///< erste Spalte des Traegers
+		int y0; ///< erste Zeile des Traegers
+		int x1; ///< Spalte hinter der letzten Spalte des Traegers
+		int y1; ///< Zeile hinter der letzten Zeile des Traegers
+	};
+
 	/**
 	 * Gemeinsame Basisklasse f�r FrequencyDomainFiltering und FastFrequencyDomainFiltering.
 	 *
@@ -67,10 +94,43 @@ namespace GET
 		 */
 		Image<Complex> m_tmp2;
 
+	public:
+		/** Auffuellen von Bildern im Ortsraum auf eine Groesse, fuer die die FFT schnell ist.
+		 *
+		 * Das Bild wird in die linke obere Ecke eines Quadrats mit der naechsten Zweierpotenz
+		 * als Kantenlaenge gelegt (siehe getPaddedSize()). Die restlichen Pixel jeder Zeile (Spalte)
+		 * werden vom naeheren Bildrand aus aufgefuellt. Dabei wird beruecksichtigt, dass die Faltung
+		 * zyklisch ist, die letzte aufgefuellte Spalte also Nachbar der ersten Bildspalte ist.
+		 *
+		 * @see doConvolutionWithImage( const Image<Complex>&, Image<Complex>&, PaddingMode )
+		 */
+		enum PaddingMode
+		{
+			NO_PADDING,		  ///< kein Auffuellen (die Bildgroesse muss fuer die FFT zulaessig sein)
+			ZERO_PADDING,	  ///< Auffuellen mit Nullen
+			MIRROR_PADDING,	  ///< Spiegelung am Bildrand (das Randpixel wird wiederholt)
+			REPLICATE_PADDING ///< Wiederholung des Randpixels
+		};
+
 	public:
 		/** Standardkonstruktor. */
 		FrequencyDomainFilteringBaseTemplate();
 
+		/** Liefert die aufgefuellte Groesse eines Bildes (die FFT ist fuer quadratische Bilder
+		 * schnell, deren Kantenlaenge eine Zweierpotenz ist).
+		 *
+		 * @param width Breite des Bildes
+		 * @param height Hoehe des Bildes
+		 * @return Breite und Hoehe des aufgefuellten Bildes
+		 */
+		static inline int getPaddedSize(int width, int height)
+		{
+			int size = 1;
+			while ((size < width) || (size < height))
+				size *= 2;
+			return size;
+		};
+
 		/** Setzt eine neue Filtermaske.
 		 *
 		 * @param filter_mask Image-Objekt in dem die neue Filtermaske �bergeben wird (Frequenzraum)
@@ -189,6 +249,41 @@ namespace GET
 		 */
 		void setButterworthHighpassMask(float d0, int n, int width, int height);
 
+		/** Setzt die Maske eines idealen Tiefpass-Filters und holt sie dazu aus einem Cache berechneter Masken.
+		 *
+		 * Wie setIdealLowpassMask( float, int, int ), die Maske wird aber nur erzeugt, wenn cache noch
+		 * keine Maske mit denselben Parametern (Filtertyp, d0, width, height) enthaelt. Eine erzeugte
+		 * Maske wird in cache gespeichert. Das lohnt sich, wenn dieselben wenigen Filter auf viele
+		 * Bilder angewendet werden.
+		 *
+		 * @param d0 Grenzfrequenz des idealen Tiefpass
+		 * @param width Breite der Filtermaske
+		 * @param height Hoehe der Filtermaske
+		 * @param cache Cache berechneter Masken, z.B. SpectrumCache<MASKTYPE>::getSharedCache()
+		 */
+		inline void setIdealLowpassMask(float d0, int width, int height, SpectrumCache<MASKTYPE> &cache);
+
+		/** Setzt die Maske eines idealen Hochpass-Filters und holt sie dazu aus einem Cache berechneter Masken.
+		 *
+		 * @see setIdealLowpassMask( float, int, int, SpectrumCache<MASKTYPE>& )
+		 */
+		inline void setIdealHighpassMask(float d0, int width, int height, SpectrumCache<MASKTYPE> &cache);
+
+		/** Setzt die Maske eines Butterworth-Tiefpass-Filters und holt sie dazu aus einem Cache berechneter Masken.
+		 *
+		 * Der Schluessel der Maske besteht aus Filtertyp, d0, n, width und height. Eine Maske, die nicht
+		 * im Cache ist, wird zeilenweise mit FastMath::doPowInt() erzeugt (siehe doCreateButterworthMask()).
+		 *
+		 * @see setIdealLowpassMask( float, int, int, SpectrumCache<MASKTYPE>& )
+		 */
+		inline void setButterworthLowpassMask(float d0, int n, int width, int height, SpectrumCache<MASKTYPE> &cache);
+
+		/** Setzt die Maske eines Butterworth-Hochpass-Filters und holt sie dazu aus einem Cache berechneter Masken.
+		 *
+		 * @see setButterworthLowpassMask( float, int, int, int, SpectrumCache<MASKTYPE>& )
+		 */
+		inline void setButterworthHighpassMask(float d0, int n, int width, int height, SpectrumCache<MASKTYPE> &cache);
+
 		/** Liefert die derzeitige Filtermaske in ihrer Ortrepr�sentation.
 		 * Die aktuelle Filtermaske wird mittels inverser Fourier-Transformation
 		 * in den Ortsraum zur�ck transformiert und dann an den Aufrufer zur�ckgeliefert.
@@ -248,6 +343,52 @@ namespace GET
 		 */
 		void doConvolutionWithImage(const Image<Complex> &input_image, Image<Complex> &result);
 
+		/** Faltung mit der vorher gesetzten Filtermaske, wobei das Bild auf eine fuer die FFT
+		 * guenstige Groesse aufgefuellt wird.
+		 *
+		 * Wie doConvolutionWithImage( const Image<Complex>&, Image<Complex>& ), das Bild wird aber vor
+		 * der Transformation auf getPaddedSize() aufgefuellt und das Ergebnis wieder auf die Bildgroesse
+		 * beschnitten. Auffuellen und Beschneiden geschehen zusammen mit der Nyquist-Modulation, so dass
+		 * keine zusaetzlichen Kopien des Bildes noetig sind.
+		 *
+		 * Die Filtermaske darf die Groesse des Bildes oder die aufgefuellte Groesse haben. Eine Maske
+		 * in der Groesse des Bildes wird vor der Filterung (bilinear) auf die aufgefuellte Groesse
+		 * umgerechnet; wird die Maske direkt in der aufgefuellten Groesse erzeugt, entfaellt die Interpolation.
+		 *
+		 * @param input_image Eingabebild, das gefiltert werden soll (Ortsraum, beliebige Groesse)
+		 * @param result Filterergebnis (Ortsraum, Groesse von input_image)
+		 * @param padding Art des Auffuellens (NO_PADDING: kein Auffuellen, die Bildgroesse muss fuer die FFT zulaessig sein)
+		 *
+		 * @see setMask()
+		 */
+		inline void doConvolutionWithImage(const Image<Complex> &input_image, Image<Complex> &result, PaddingMode padding);
+
+		/** Filterung eines Bildes im geteilten Format mit der vorher gesetzten Filtermaske (Frequenzraum).
+		 *
+		 * @param input_image Eingabebild, das gefiltert werden soll (Frequenzraum, geteiltes Format)
+		 * @param result Filterergebnis (Frequenzraum, geteiltes Format); darf input_image sein
+		 *
+		 * @see setMask()
+		 */
+		inline void doFilteringWithImage(const SplitComplexImage &input_image, SplitComplexImage &result);
+
+		/** Faltung eines Bildes im geteilten Format mit der vorher gesetzten Filtermaske.
+		 *
+		 * Wie doConvolutionWithImage( const Image<Complex>&, Image<Complex>& ), das Bild bleibt aber waehrend
+		 * der gesamten Filterung im geteilten Format (SplitFFT), eine Umwandlung in das verschraenkte Format
+		 * entfaellt. Ein reelles Bild wird gefiltert, indem es in result kopiert wird
+		 * (SplitComplexImage::copy( const Image<float>& )) und result als input_image uebergeben wird;
+		 * der Realteil des Ergebnisses steht ueber SplitComplexImage::getReal() zur Verfuegung.
+		 *
+		 * Breite und Hoehe des Bildes muessen Zweierpotenzen sein; Bilder werden nicht aufgefuellt (siehe PaddingMode).
+		 *
+		 * @param input_image Eingabebild, das gefiltert werden soll (Ortsraum, geteiltes Format)
+		 * @param result Filterergebnis (Ortsraum, geteiltes Format); darf input_image sein
+		 *
+		 * @see setMask()
+		 */
+		inline void doConvolutionWithImage(const SplitComplexImage &input_image, SplitComplexImage &result);
+
 		/** Filterung(Faltung) ausf�hren.
 		 *
 		 * Es wird das vorher gesetzte Eingabebild mit der direkt �bergebenen Filtermaske
@@ -260,6 +401,90 @@ namespace GET
 		 */
 		void doFilteringWithMaskGiveSpatialResult(const Image<MASKTYPE> &filter_mask, Image<Complex> &result);
 
+		/** Filterbank: Filterung mit mehreren Filtermasken und Ergebnissen im Ortsraum.
+		 *
+		 * Das vorher gesetzte Eingabebild wird mit jeder der uebergebenen Filtermasken gefiltert und
+		 * die Ergebnisse werden in den Ortsraum ruecktransformiert. Das Eingabebild wird nur einmal
+		 * in den Frequenzraum transformiert (setSpatialImage()); pro Maske werden nur die Multiplikation
+		 * mit der Maske und die inverse Fourier-Transformation ausgefuehrt. Die Masken werden parallel
+		 * bearbeitet (OpenMP).
+		 *
+		 * @param filter_masks Filtermasken, mit denen gefiltert wird (Frequenzraum, Groesse des Eingabebildes)
+		 * @param results Sequenz mit einem Filterergebnis pro Maske (Ortsraum)
+		 *
+		 * @see setSpatialImage()
+		 * @see doFilteringWithMaskGiveSpatialResult()
+		 */
+		inline void doFilteringWithMasksGiveSpatialResult(const ImageSequence<MASKTYPE> &filter_masks, ImageSequence<Complex> &results);
+
+		/** Filterbank: Filterung mit mehreren Filtermasken und Ergebnissen im Ortsraum.
+		 *
+		 * Wie doFilteringWithMasksGiveSpatialResult( const ImageSequence<MASKTYPE>&, ImageSequence<Complex>& ),
+		 * es wird aber nur der Realteil der Ergebnisse im Ortsraum zurueckgeliefert.
+		 *
+		 * @param filter_masks Filtermasken, mit denen gefiltert wird (Frequenzraum, Groesse des Eingabebildes)
+		 * @param results Sequenz mit dem Realteil eines Filterergebnisses pro Maske (Ortsraum)
+		 */
+		inline void doFilteringWithMasksGiveSpatialResult(const ImageSequence<MASKTYPE> &filter_masks, ImageSequence<float> &results);
+
+		/** Filterbank, beschraenkt auf den Traeger der Filtermasken.
+		 *
+		 * Wie doFilteringWithMasksGiveSpatialResult( const ImageSequence<MASKTYPE>&, ImageSequence<Complex>& ),
+		 * das Spektrum wird aber nur innerhalb des Traegers jeder Maske multipliziert und ausserhalb
+		 * als 0 angenommen.
+		 *
+		 * Ist reduced_resolution true, werden die Ergebnisse mit reduzierter Aufloesung berechnet:
+		 * Breite und Hoehe werden durch die groesste Zweierpotenz geteilt, fuer die die Traeger aller
+		 * Masken noch in den reduzierten Frequenzraum passen. Da das gefilterte Spektrum ausserhalb
+		 * des Traegers 0 ist, enthaelt das reduzierte Ergebnis genau die Werte des vollen Ergebnisses
+		 * an jedem r-ten Pixel in x- und y-Richtung, benoetigt aber nur eine inverse
+		 * Fourier-Transformation der reduzierten Groesse.
+		 *
+		 * @param filter_masks Filtermasken, mit denen gefiltert wird (Frequenzraum, Groesse des Eingabebildes)
+		 * @param supports Traeger jeder Filtermaske (siehe doComputeSupport())
+		 * @param reduced_resolution true: Ergebnisse mit reduzierter Aufloesung berechnen
+		 * @param results Sequenz mit einem Filterergebnis pro Maske (Ortsraum)
+		 */
+		inline void doFilteringWithMasksGiveSpatialResult(const ImageSequence<MASKTYPE> &filter_masks, const std::vector<SpectralSupport> &supports,
+														  bool reduced_resolution, ImageSequence<Complex> &results);
+
+		/** Filterbank, beschraenkt auf den Traeger der Filtermasken (nur Realteil der Ergebnisse).
+		 *
+		 * @see doFilteringWithMasksGiveSpatialResult( const ImageSequence<MASKTYPE>&, const std::vector<SpectralSupport>&, bool, ImageSequence<Complex>& )
+		 */
+		inline void doFilteringWithMasksGiveSpatialResult(const ImageSequence<MASKTYPE> &filter_masks, const std::vector<SpectralSupport> &supports,
+														  bool reduced_resolution, ImageSequence<float> &results);
+
+		/** Filterbank mit Energiebildern als Ergebnis.
+		 *
+		 * Die Filtermasken werden in Gruppen von je group_size aufeinanderfolgenden Masken eingeteilt
+		 * (z.B. alle Orientierungen einer Skala einer Gabor-Filterbank). Fuer jede Gruppe wird das
+		 * Energiebild sum_i |r_i|^2 der komplexen Filterergebnisse r_i (Ortsraum) ihrer Masken berechnet.
+		 * Die komplexen Filterergebnisse selbst werden nie gespeichert; pro Thread wird immer nur ein
+		 * Ergebnis im Speicher gehalten.
+		 *
+		 * @param filter_masks Filtermasken, mit denen gefiltert wird (Frequenzraum, Groesse des Eingabebildes)
+		 * @param supports Traeger jeder Filtermaske (siehe doComputeSupport())
+		 * @param group_size Anzahl der Masken pro Energiebild (die Anzahl der Masken muss ein Vielfaches davon sein)
+		 * @param reduced_resolution true: Energiebilder mit reduzierter Aufloesung berechnen
+		 * @param energy_results Sequenz mit einem Energiebild pro Gruppe von Masken (Ortsraum)
+		 *
+		 * @see doFilteringWithMasksGiveSpatialResult( const ImageSequence<MASKTYPE>&, const std::vector<SpectralSupport>&, bool, ImageSequence<Complex>& )
+		 */
+		inline void doFilteringWithMasksGiveEnergy(const ImageSequence<MASKTYPE> &filter_masks, const std::vector<SpectralSupport> &supports, int group_size,
+												   bool reduced_resolution, ImageSequence<float> &energy_results);
+
+		/** Bestimmt den Traeger einer Filtermaske.
+		 *
+		 * Der Traeger ist das umschliessende Rechteck aller Maskenwerte, deren Betrag mindestens
+		 * threshold mal dem maximalen Betrag der Maske ist.
+		 *
+		 * @param filter_mask Filtermaske (Frequenzraum)
+		 * @param threshold relativer Schwellwert fuer vernachlaessigbare Maskenwerte
+		 * @return Traeger der Maske (leer, wenn alle Werte 0 sind)
+		 */
+		static inline SpectralSupport doComputeSupport(const Image<MASKTYPE> &filter_mask, float threshold);
+
 	protected:
 		/** Implementation der Filterung.
 		 *
@@ -276,6 +501,129 @@ namespace GET
 		 * @todo Multiplikation und Zuweisung in der Schleife durch eine Operation ersetzen (Geschwindigkeit)
 		 */
 		void doFiltering(const Image<Complex> &input_image, const Image<MASKTYPE> &filter_mask, Image<Complex> &result);
+
+		/** Implementation der Filterung fuer Bilder im geteilten Format.
+		 *
+		 * @see doFiltering( const Image<Complex>&, const Image<MASKTYPE>&, Image<Complex>& )
+		 */
+		static inline void doFiltering(const SplitComplexImage &input_image, const Image<MASKTYPE> &filter_mask, SplitComplexImage &result);
+
+		/** Vektorisierte Implementation der Filterung (siehe ComplexKernels).
+		 *
+		 * Berechnet dasselbe Produkt wie doFiltering( const Image<Complex>&, const Image<MASKTYPE>&, Image<Complex>& ),
+		 * deren skalare Schleife in der vorkompilierten Bibliothek steckt. Wird von der Filterung genutzt,
+		 * die in diesem Header kompiliert wird (Filterbank, Faltung mit Auffuellen).
+		 *
+		 * @param input_image Eingabebild (Frequenzraum)
+		 * @param filter_mask Filtermaske (Frequenzraum, Groesse von input_image)
+		 * @param result Filterergebnis (Frequenzraum); darf input_image sein
+		 */
+		static inline void doMultiplySpectrum(const Image<Complex> &input_image, const Image<MASKTYPE> &filter_mask, Image<Complex> &result);
+
+		/** Implementation der Filterbank.
+		 *
+		 * Genau eines von complex_results, real_results und energy_results muss angegeben werden (die anderen sind NULL).
+		 *
+		 * @param filter_masks Filtermasken, mit denen gefiltert wird (Frequenzraum)
+		 * @param supports Traeger jeder Maske oder NULL (Filterung im gesamten Frequenzraum)
+		 * @param reduced_resolution true: Ergebnisse mit reduzierter Aufloesung berechnen (nur mit supports)
+		 * @param complex_results komplexe Filterergebnisse (Ortsraum) oder NULL
+		 * @param real_results Realteile der Filterergebnisse (Ortsraum) oder NULL
+		 * @param energy_results Energiebilder von Gruppen aus je group_size Masken (Ortsraum) oder NULL
+		 * @param group_size Anzahl der Masken pro Energiebild (nur energy_results)
+		 *
+		 * @see doFilteringWithMasksGiveSpatialResult(), doFilteringWithMasksGiveEnergy()
+		 */
+		inline void doFilterBank(const ImageSequence<MASKTYPE> &filter_masks, const std::vector<SpectralSupport> *supports, bool reduced_resolution,
+						  ImageSequence<Complex> *complex_results, ImageSequence<float> *real_results,
+						  ImageSequence<float> *energy_results = NULL, int group_size = 1);
+
+		/** Filterung innerhalb des Traegers einer Maske.
+		 *
+		 * Das Produkt von Eingabebild und Filtermaske wird nur innerhalb des Traegers berechnet. Das
+		 * Ergebnis ist das zentrierte Fenster der Groesse (width/reduction)*(height/reduction) des Produkts;
+		 * alle Werte ausserhalb des Traegers werden auf 0 gesetzt.
+		 *
+		 * @param input_image Eingabebild (Frequenzraum)
+		 * @param filter_mask Filtermaske (Frequenzraum)
+		 * @param support Traeger der Filtermaske
+		 * @param reduction Faktor, um den Breite und Hoehe des Ergebnisses verkleinert werden
+		 * @param factor Faktor, mit dem alle Werte des Ergebnisses multipliziert werden
+		 * @param result gefiltertes (und beschnittenes) Spektrum
+		 */
+		static inline void doFilteringInSupport(const Image<Complex> &input_image, const Image<MASKTYPE> &filter_mask, const SpectralSupport &support,
+										 int reduction, float factor, Image<Complex> &result);
+
+		/** Holt die Filtermaske aus einem Cache berechneter Masken.
+		 *
+		 * @param cache Cache berechneter Masken
+		 * @param key Schluessel der Filtermaske
+		 * @return true, wenn die Maske gefunden und als neue Filtermaske gesetzt wurde
+		 */
+		inline bool doLookupMask(SpectrumCache<MASKTYPE> &cache, const typename SpectrumCache<MASKTYPE>::Key &key);
+
+		/** Speichert die aktuelle Filtermaske in einem Cache berechneter Masken.
+		 *
+		 * @param cache Cache berechneter Masken
+		 * @param key Schluessel der Filtermaske
+		 */
+		inline void doStoreMask(SpectrumCache<MASKTYPE> &cache, const typename SpectrumCache<MASKTYPE>::Key &key);
+
+		/** Erzeugt die Maske eines Butterworth-Filters mit vektorisierten ganzzahligen Potenzen.
+		 *
+		 * Dieselbe Maske wie setButterworthLowpassMask( float, int, int, int ) und setButterworthHighpassMask( float, int, int, int ),
+		 * die Potenzen werden aber zeilenweise mit FastMath::doPowInt() statt mit powf() pro Pixel berechnet
+		 * (relative Abweichung unter 1e-6).
+		 *
+		 * @param d0 Grenzfrequenz
+		 * @param n Ordnung des Filters
+		 * @param width Breite der Filtermaske
+		 * @param height Hoehe der Filtermaske
+		 * @param highpass true: Hochpass, false: Tiefpass
+		 */
+		inline void doCreateButterworthMask(float d0, int n, int width, int height, bool highpass);
+
+		/** Quadrierter Betrag eines reellen Maskenwerts */
+		static inline float getSquaredMagnitude(float value) { return value * value; };
+
+		/** Quadrierter Betrag eines komplexen Maskenwerts */
+		static inline float getSquaredMagnitude(const Complex &value) { return value.re * value.re + value.im * value.im; };
+
+		/** Fuellt ein Bild im Ortsraum auf und fuehrt die Nyquist-Modulation aus.
+		 *
+		 * @param image Bild im Ortsraum
+		 * @param padding Art des Auffuellens (nicht NO_PADDING)
+		 * @param padded aufgefuelltes und moduliertes Bild (getPaddedSize() * getPaddedSize())
+		 */
+		static inline void doPadding(const Image<Complex> &image, PaddingMode padding, Image<Complex> &padded);
+
+		/** Beschneidet ein aufgefuelltes Ergebnis im Ortsraum und fuehrt die Nyquist-Modulation aus.
+		 *
+		 * @param padded Ergebnis der inversen Fourier-Transformation
+		 * @param width Breite des beschnittenen Ergebnisses
+		 * @param height Hoehe des beschnittenen Ergebnisses
+		 * @param result beschnittenes und moduliertes Ergebnis
+		 */
+		static inline void doCropping(const Image<Complex> &padded, int width, int height, Image<Complex> &result);
+
+		/** Beschneidet ein aufgefuelltes Ergebnis im Ortsraum und fuehrt die Nyquist-Modulation aus (nur Realteil).
+		 *
+		 * @see doCropping( const Image<Complex>&, int, int, Image<Complex>& )
+		 */
+		static inline void doCropping(const Image<Complex> &padded, int width, int height, Image<float> &result);
+
+		/** Liefert eine Filtermaske in der Groesse des aufgefuellten Bildes.
+		 *
+		 * Masken in der Groesse width*height des nicht aufgefuellten Bildes werden in buffer
+		 * umgerechnet, alle anderen Masken werden unveraendert zurueckgeliefert.
+		 *
+		 * @param filter_mask Filtermaske (Frequenzraum)
+		 * @param width Breite des nicht aufgefuellten Bildes
+		 * @param height Hoehe des nicht aufgefuellten Bildes
+		 * @param buffer Speicher fuer die umgerechnete Maske
+		 * @return Filtermaske, mit der das aufgefuellte Bild gefiltert wird
+		 */
+		static inline const Image<MASKTYPE> &getPaddedMask(const Image<MASKTYPE> &filter_mask, int width, int height, Image<MASKTYPE> &buffer);
 	};
 
 	/* *********************************************************************************** */
@@ -323,6 +671,729 @@ namespace GET
 		};
 	}
 
+	/* *********************************************************************************** */
+	/* Maske eines idealen Tiefpass aus dem Cache holen oder erzeugen. */
+	template <typename MASKTYPE>
+	inline void FrequencyDomainFilteringBaseTemplate<MASKTYPE>::setIdealLowpassMask(float d0, int width, int height, SpectrumCache<MASKTYPE> &cache)
+	/* *********************************************************************************** */
+	{
+		typename SpectrumCache<MASKTYPE>::Key key = SpectrumCache<MASKTYPE>::makeKey(SpectrumCache<MASKTYPE>::IDEAL_LOWPASS, d0, 0, width, height);
+		if (doLookupMask(cache, key))
+			return;
+
+		setIdealLowpassMask(d0, width, height);
+		doStoreMask(cache, key);
+	}
+
+	/* *********************************************************************************** */
+	/* Maske eines idealen Hochpass aus dem Cache holen oder erzeugen. */
+	template <typename MASKTYPE>
+	inline void FrequencyDomainFilteringBaseTemplate<MASKTYPE>::setIdealHighpassMask(float d0, int width, int height, SpectrumCache<MASKTYPE> &cache)
+	/* *********************************************************************************** */
+	{
+		typename SpectrumCache<MASKTYPE>::Key key = SpectrumCache<MASKTYPE>::makeKey(SpectrumCache<MASKTYPE>::IDEAL_HIGHPASS, d0, 0, width, height);
+		if (doLookupMask(cache, key))
+			return;
+
+		setIdealHighpassMask(d0, width, height);
+		doStoreMask(cache, key);
+	}
+
+	/* *********************************************************************************** */
+	/* Maske eines Butterworth-Tiefpass aus dem Cache holen oder erzeugen. */
+	template <typename MASKTYPE>
+	inline void FrequencyDomainFilteringBaseTemplate<MASKTYPE>::setButterworthLowpassMask(float d0, int n, int width, int height, SpectrumCache<MASKTYPE> &cache)
+	/* *********************************************************************************** */
+	{
+		typename SpectrumCache<MASKTYPE>::Key key = SpectrumCache<MASKTYPE>::makeKey(SpectrumCache<MASKTYPE>::BUTTERWORTH_LOWPASS, d0, n, width, height);
+		if (doLookupMask(cache, key))
+			return;
+
+		doCreateButterworthMask(d0, n, width, height, false);
+		doStoreMask(cache, key);
+	}
+
+	/* *********************************************************************************** */
+	/* Maske eines Butterworth-Hochpass aus dem Cache holen oder erzeugen. */
+	template <typename MASKTYPE>
+	inline void FrequencyDomainFilteringBaseTemplate<MASKTYPE>::setButterworthHighpassMask(float d0, int n, int width, int height, SpectrumCache<MASKTYPE> &cache)
+	/* *********************************************************************************** */
+	{
+		typename SpectrumCache<MASKTYPE>::Key key = SpectrumCache<MASKTYPE>::makeKey(SpectrumCache<MASKTYPE>::BUTTERWORTH_HIGHPASS, d0, n, width, height);
+		if (doLookupMask(cache, key))
+			return;
+
+		doCreateButterworthMask(d0, n, width, height, true);
+		doStoreMask(cache, key);
+	}
+
+	/* *********************************************************************************** */
+	/* Maske eines Butterworth-Filters mit vektorisierten Potenzen erzeugen. */
+	template <typename MASKTYPE>
+	inline void FrequencyDomainFilteringBaseTemplate<MASKTYPE>::doCreateButterworthMask(float d0, int n, int width, int height, bool highpass)
+	/* *********************************************************************************** */
+	{
+		if ((width > 0) && (height > 0))
+		{
+			// Adjust mask size
+			m_filter_mask.resize(width, height);
+
+			// Calculate the center of the image exactly
+			float mx = (float)width / 2.0f;
+			float my = (float)height / 2.0f;
+
+			float radius2 = d0 * d0;
+			std::vector<float> row(width);
+
+			for (int y = 0; y < height; ++y)
+			{
+				// (D(u,v)/d0)^2 (lowpass) or (d0/D(u,v))^2 (highpass), d0 and D(u,v) are already squared
+				float disty = y - my;
+				for (int x = 0; x < width; ++x)
+				{
+					float distx = x - mx;
+					float dist2 = distx * distx + disty * disty;
+					row[x] = highpass ? radius2 / dist2 : dist2 / radius2;
+				}
+
+				// Integer power of the whole row (vectorised)
+				FastMath::doPowInt(&row[0], n, &row[0], width);
+
+				// Weight calculation for 1 / (1 + (...) ^ 2n )
+				MASKTYPE *mdata = m_filter_mask.getRow(y);
+				for (int x = 0; x < width; ++x)
+					mdata[x] = 1.0f / (1.0f + row[x]);
+			}
+
+			// Filter mask prepared
+			m_filter_mask_available = true;
+		}
+		else
+			m_filter_mask_available = false;
+	}
+
+	/* *********************************************************************************** */
+	/* Filtermaske aus dem Cache holen. */
+	template <typename MASKTYPE>
+	inline bool FrequencyDomainFilteringBaseTemplate<MASKTYPE>::doLookupMask(SpectrumCache<MASKTYPE> &cache, const typename SpectrumCache<MASKTYPE>::Key &key)
+	/* *********************************************************************************** */
+	{
+		if (cache.doLookup(key, m_filter_mask))
+		{
+			m_filter_mask_available = true;
+			return true;
+		}
+		return false;
+	}
+
+	/* *********************************************************************************** */
+	/* Filtermaske im Cache speichern. */
+	template <typename MASKTYPE>
+	inline void FrequencyDomainFilteringBaseTemplate<MASKTYPE>::doStoreMask(SpectrumCache<MASKTYPE> &cache, const typename SpectrumCache<MASKTYPE>::Key &key)
+	/* *********************************************************************************** */
+	{
+		if (m_filter_mask_available)
+			cache.doInsert(key, m_filter_mask);
+	}
+
+	/* *********************************************************************************** */
+	/* Filterbank mit Ergebnissen im Ortsraum. */
+	template <typename MASKTYPE>
+	inline void FrequencyDomainFilteringBaseTemplate<MASKTYPE>::doFilteringWithMasksGiveSpatialResult(const ImageSequence<MASKTYPE> &filter_masks, ImageSequence<Complex> &results)
+	/* *********************************************************************************** */
+	{
+		doFilterBank(filter_masks, NULL, false, &results, NULL);
+	}
+
+	/* *********************************************************************************** */
+	/* Filterbank mit Ergebnissen im Ortsraum (nur Realteil). */
+	template <typename MASKTYPE>
+	inline void FrequencyDomainFilteringBaseTemplate<MASKTYPE>::doFilteringWithMasksGiveSpatialResult(const ImageSequence<MASKTYPE> &filter_masks, ImageSequence<float> &results)
+	/* *********************************************************************************** */
+	{
+		doFilterBank(filter_masks, NULL, false, NULL, &results);
+	}
+
+	/* *********************************************************************************** */
+	/* Filterung innerhalb des Traegers einer Maske. */
+	template <typename MASKTYPE>
+	inline void FrequencyDomainFilteringBaseTemplate<MASKTYPE>::doFilteringInSupport(const Image<Complex> &input_image, const Image<MASKTYPE> &filter_mask,
+																			         const SpectralSupport &support, int reduction, float factor, Image<Complex> &result)
+	/* *********************************************************************************** */
+	{
+		int width = input_image.getWidth();
+		int height = input_image.getHeight();
+		int result_width = width / reduction;
+		int result_height = height / reduction;
+
+		if ((result.getWidth() != result_width) || (result.getHeight() != result_height))
+			result.resize(result_width, result_height);
+		result.fill(0.0f);
+
+		// Position of the result window in the (centred) spectrum
+		int offset_x = width / 2 - result_width / 2;
+		int offset_y = height / 2 - result_height / 2;
+
+		int x0 = std::max(support.x0, offset_x);
+		int x1 = std::min(support.x1, offset_x + result_width);
+		int y0 = std::max(support.y0, offset_y);
+		int y1 = std::min(support.y1, offset_y + result_height);
+
+		const Complex *input = input_image.getData();
+		const MASKTYPE *mask = filter_mask.getData();
+		Complex *output = result.getData();
+
+		for (int y = y0; y < y1; ++y)
+		{
+			const Complex *input_line = input + y * width;
+			const MASKTYPE *mask_line = mask + y * width;
+			Complex *output_line = output + (y - offset_y) * result_width - offset_x;
+
+			ComplexKernels::doMultiply(input_line + x0, mask_line + x0, output_line + x0, x1 - x0);
+			if (factor != 1.0f)
+				ComplexKernels::doScale(output_line + x0, factor, x1 - x0);
+		}
+	}
+
+	/* *********************************************************************************** */
+	/* Filterbank (Implementierung). */
+	template <typename MASKTYPE>
+	inline void FrequencyDomainFilteringBaseTemplate<MASKTYPE>::doFilterBank(const ImageSequence<MASKTYPE> &filter_masks, const std::vector<SpectralSupport> *supports, bool reduced_resolution,
+																	         ImageSequence<Complex> *complex_results, ImageSequence<float> *real_results,
+																	         ImageSequence<float> *energy_results, int group_size)
+	/* *********************************************************************************** */
+	{
+		if (!m_input_image_available)
+		{
+			gerr << "Error in FrequencyFiltering::doFilteringWithMasksGiveSpatialResult( const ImageSequence<MASKTYPE> &filter_masks, ImageSequence<...> &results )" << endl;
+			gerr << "Input image does not exist." << endl;
+			return;
+		}
+
+		int width = m_input_image.getWidth();
+		int height = m_input_image.getHeight();
+		int masks = filter_masks.getSize();
+
+		//
+		// Test sizes (before the parallel loop, which must not throw)
+		//
+		if ((masks > 0) && ((filter_masks.getImageWidth() != width) || (filter_masks.getImageHeight() != height)))
+		{
+			throw GException(
+				"FrequencyFiltering::doFilteringWithMasksGiveSpatialResult( const ImageSequence<MASKTYPE> &filter_masks, ImageSequence<...> &results )",
+				"Filter masks and image must be the same size.");
+		}
+		if (supports && ((int)supports->size() != masks))
+		{
+			throw GException(
+				"FrequencyFiltering::doFilteringWithMasksGiveSpatialResult( const ImageSequence<MASKTYPE> &filter_masks, const std::vector<SpectralSupport> &supports, ... )",
+				"Number of supports and filter masks must be the same.");
+		}
+		if (energy_results && ((group_size < 1) || (masks % group_size != 0)))
+		{
+			throw GException(
+				"FrequencyFiltering::doFilteringWithMasksGiveEnergy( const ImageSequence<MASKTYPE> &filter_masks, ..., int group_size, ... )",
+				"Number of filter masks must be a multiple of the group size.");
+		}
+
+		//
+		// Reduction of the resolution: largest power of two, for which the supports
+		// of all masks lie within the centred window of the reduced spectrum
+		//
+		int reduction = 1;
+		if (supports && reduced_resolution)
+		{
+			int extent_x = 1;
+			int extent_y = 1;
+			for (int i = 0; i < masks; ++i)
+			{
+				const SpectralSupport &support = (*supports)[i];
+				if (support.x1 <= support.x0)
+					continue;
+				extent_x = std::max(extent_x, std::max(width / 2 - support.x0, support.x1 - width / 2));
+				extent_y = std::max(extent_y, std::max(height / 2 - support.y0, support.y1 - height / 2));
+			}
+			while ((width % (4 * reduction) == 0) && (height % (4 * reduction) == 0) &&
+				   (width / (2 * reduction) >= 2 * extent_x) && (height / (2 * reduction) >= 2 * extent_y))
+				reduction *= 2;
+		}
+		int result_width = width / reduction;
+		int result_height = height / reduction;
+
+		// Compensation of the scaling of the smaller inverse transformation
+		float factor = 1.0f;
+		switch (a_fft.getScaling())
+		{
+		case DFT::NOSCALING:
+		case DFT::SCALE_ON_TRANSFORMATION:
+			break;
+		case DFT::SYMMETRICAL_SCALING:
+			factor = 1.0f / reduction;
+			break;
+		case DFT::SCALE_ON_RETRANSFORMATION:
+			factor = 1.0f / (reduction * reduction);
+			break;
+		}
+
+		if (complex_results)
+		{
+			if ((complex_results->getSize() != masks) || (complex_results->getImageWidth() != result_width) || (complex_results->getImageHeight() != result_height))
+				complex_results->doReSize(masks, result_width, result_height);
+		}
+		else if (real_results)
+		{
+			if ((real_results->getSize() != masks) || (real_results->getImageWidth() != result_width) || (real_results->getImageHeight() != result_height))
+				real_results->doReSize(masks, result_width, result_height);
+		}
+		else
+		{
+			int groups = masks / group_size;
+			if ((energy_results->getSize() != groups) || (energy_results->getImageWidth() != result_width) || (energy_results->getImageHeight() != result_height))
+				energy_results->doReSize(groups, result_width, result_height);
+			for (int i = 0; i < groups; ++i)
+				(*energy_results)[i].fill(0.0f);
+		}
+
+		//
+		// Working memory per thread (the FFT objects are created here, so that their
+		// tables are computed before the parallel loop)
+		//
+		int threads = std::max(1, std::min(Parallel::getMaxThreads(), masks));
+		std::vector<FFT> ffts(threads, FFT(std::max(width, height) / reduction, a_fft.getScaling()));
+		std::vector<Image<Complex> > spectra(threads);
+		std::vector<Image<Complex> > responses(energy_results ? threads : 0);
+
+		//
+		// Multiply with each mask and transform back
+		//
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(threads)
+#endif
+		for (int i = 0; i < masks; ++i)
+		{
+			int thread = Parallel::getThreadNumber();
+			FFT &fft = ffts[thread];
+			Image<Complex> &spectrum = spectra[thread];
+
+			// Perform filtering (only within the support of the mask, if known)
+			if (supports)
+				doFilteringInSupport(m_input_image, filter_masks[i], (*supports)[i], reduction, factor, spectrum);
+			else
+				doMultiplySpectrum(m_input_image, filter_masks[i], spectrum);
+
+			if (complex_results)
+			{
+				// Transform the result back into position space
+				fft.doInvFourierTransform2D(spectrum, (*complex_results)[i]);
+				// Nyquist Modulation
+				fft.doNyquistModulation((*complex_results)[i]);
+			}
+			else if (real_results)
+			{
+				// Transform the result back into position space (real part only)
+				fft.doInvFourierTransform2D(spectrum, (*real_results)[i]);
+				// Nyquist Modulation
+				fft.doNyquistModulation((*real_results)[i]);
+			}
+			else
+			{
+				Image<Complex> &response = responses[thread];
+				// Transform the result back into position space (the modulation
+				// only changes signs and does not affect the energy)
+				fft.doInvFourierTransform2D(spectrum, response);
+
+#ifdef _OPENMP
+#pragma omp critical(getlib_filter_bank_energy)
+#endif
+				{
+					float *energy = (*energy_results)[i / group_size].getData();
+					for (int y = 0; y < result_height; ++y)
+					{
+						const Complex *data = response.getData() + y * response.getWidth();
+						for (int x = 0; x < result_width; ++x, ++energy)
+							*energy += data[x].re * data[x].re + data[x].im * data[x].im;
+					}
+				}
+			}
+		}
+	}
+
+	/* *********************************************************************************** */
+	/* Filterbank im Traeger der Masken. */
+	template <typename MASKTYPE>
+	inline void FrequencyDomainFilteringBaseTemplate<MASKTYPE>::doFilteringWithMasksGiveSpatialResult(const ImageSequence<MASKTYPE> &filter_masks, const std::vector<SpectralSupport> &supports,
+																							          bool reduced_resolution, ImageSequence<Complex> &results)
+	/* *********************************************************************************** */
+	{
+		doFilterBank(filter_masks, &supports, reduced_resolution, &results, NULL);
+	}
+
+	/* *********************************************************************************** */
+	/* Filterbank im Traeger der Masken (nur Realteil). */
+	template <typename MASKTYPE>
+	inline void FrequencyDomainFilteringBaseTemplate<MASKTYPE>::doFilteringWithMasksGiveSpatialResult(const ImageSequence<MASKTYPE> &filter_masks, const std::vector<SpectralSupport> &supports,
+																							          bool reduced_resolution, ImageSequence<float> &results)
+	/* *********************************************************************************** */
+	{
+		doFilterBank(filter_masks, &supports, reduced_resolution, NULL, &results);
+	}
+
+	/* *********************************************************************************** */
+	/* Filterbank mit Energiebildern als Ergebnis. */
+	template <typename MASKTYPE>
+	inline void FrequencyDomainFilteringBaseTemplate<MASKTYPE>::doFilteringWithMasksGiveEnergy(const ImageSequence<MASKTYPE> &filter_masks, const std::vector<SpectralSupport> &supports,
+																						       int group_size, bool reduced_resolution, ImageSequence<float> &energy_results)
+	/* *********************************************************************************** */
+	{
+		doFilterBank(filter_masks, &supports, reduced_resolution, NULL, NULL, &energy_results, group_size);
+	}
+
+	/* *********************************************************************************** */
+	/* Traeger einer Filtermaske bestimmen. */
+	template <typename MASKTYPE>
+	inline SpectralSupport FrequencyDomainFilteringBaseTemplate<MASKTYPE>::doComputeSupport(const Image<MASKTYPE> &filter_mask, float threshold)
+	/* *********************************************************************************** */
+	{
+		int width = filter_mask.getWidth();
+		int height = filter_mask.getHeight();
+		const MASKTYPE *mask = filter_mask.getData();
+
+		// Maximum magnitude of the mask (compared squared)
+		float max_value = 0.0f;
+		for (int i = 0; i < filter_mask.getSize(); ++i)
+			max_value = std::max(max_value, getSquaredMagnitude(mask[i]));
+
+		SpectralSupport support;
+		support.x0 = width;
+		support.y0 = height;
+		support.x1 = 0;
+		support.y1 = 0;
+
+		if (max_value > 0.0f)
+		{
+			float limit = threshold * threshold * max_value;
+			for (int y = 0; y < height; ++y)
+			{
+				for (int x = 0; x < width; ++x, ++mask)
+				{
+					float value = getSquaredMagnitude(*mask);
+					if ((value > 0.0f) && (value >= limit))
+					{
+						support.x0 = std::min(support.x0, x);
+						support.x1 = std::max(support.x1, x + 1);
+						support.y0 = std::min(support.y0, y);
+						support.y1 = std::max(support.y1, y + 1);
+					}
+				}
+			}
+		}
+
+		// Empty support
+		if (support.x1 <= support.x0)
+			support.x0 = support.y0 = support.x1 = support.y1 = 0;
+
+		return support;
+	}
+
+	/* *********************************************************************************** */
+	/* Filterung eines Bildes im geteilten Format. */
+	template <typename MASKTYPE>
+	inline void FrequencyDomainFilteringBaseTemplate<MASKTYPE>::doFilteringWithImage(const SplitComplexImage &input_image, SplitComplexImage &result)
+	/* *********************************************************************************** */
+	{
+		if (m_filter_mask_available)
+			doFiltering(input_image, m_filter_mask, result);
+		else
+		{
+			gerr << "Error in FrequencyFiltering::doFilteringWithImage( const SplitComplexImage &input_image, SplitComplexImage &result )" << endl;
+			gerr << "Filter mask does not exist." << endl;
+		};
+	}
+
+	/* *********************************************************************************** */
+	/* Faltung eines Bildes im geteilten Format. */
+	template <typename MASKTYPE>
+	inline void FrequencyDomainFilteringBaseTemplate<MASKTYPE>::doConvolutionWithImage(const SplitComplexImage &input_image, SplitComplexImage &result)
+	/* *********************************************************************************** */
+	{
+		if (m_filter_mask_available)
+		{
+			// FFT for the split layout (with the scaling of the FFT for the interleaved layout)
+			SplitFFT fft(a_fft.getScaling());
+
+			// The whole filtering is done in place in result
+			result.copy(input_image);
+			// Nyquist Modulation
+			fft.doNyquistModulation(result);
+			// Transform the image into the frequency domain
+			fft.doFourierTransform2D(result);
+			// Perform filtering
+			doFiltering(result, m_filter_mask, result);
+			// Transform the result back into position space
+			fft.doInvFourierTransform2D(result);
+			// Nyquist Modulation
+			fft.doNyquistModulation(result);
+		}
+		else
+		{
+			gerr << "Error in FrequencyFiltering::doConvolutionWithImage( const SplitComplexImage &input_image, SplitComplexImage &result )" << endl;
+			gerr << "Filter mask does not exist." << endl;
+		};
+	}
+
+	/* *********************************************************************************** */
+	/* Filterung im geteilten Format (Implementierung). */
+	template <typename MASKTYPE>
+	inline void FrequencyDomainFilteringBaseTemplate<MASKTYPE>::doFiltering(const SplitComplexImage &input_image, const Image<MASKTYPE> &filter_mask, SplitComplexImage &result)
+	/* *********************************************************************************** */
+	{
+		//
+		// Test sizes
+		//
+		if ((input_image.getWidth() != filter_mask.getWidth()) || (input_image.getHeight() != filter_mask.getHeight()))
+		{
+			throw GException(
+				"FrequencyFiltering::doFiltering( const SplitComplexImage &input_image, const Image<float> &filter_mask, SplitComplexImage &result )",
+				"Filter mask and image must be the same size.");
+		}
+		result.resize(input_image.getWidth(), input_image.getHeight());
+
+		//
+		// Multiply the entire image area (vectorised, no shuffles for real masks)
+		//
+		ComplexKernels::doMultiply(input_image.getReal().getData(), input_image.getImag().getData(), filter_mask.getData(),
+								   result.getReal().getData(), result.getImag().getData(), filter_mask.getSize());
+	}
+
+	/* *********************************************************************************** */
+	/* Filterung (vektorisiert). */
+	template <typename MASKTYPE>
+	inline void FrequencyDomainFilteringBaseTemplate<MASKTYPE>::doMultiplySpectrum(const Image<Complex> &input_image, const Image<MASKTYPE> &filter_mask, Image<Complex> &result)
+	/* *********************************************************************************** */
+	{
+		//
+		// Test sizes
+		//
+		if ((input_image.getWidth() != filter_mask.getWidth()) || (input_image.getHeight() != filter_mask.getHeight()))
+		{
+			throw GException(
+				"FrequencyFiltering::doMultiplySpectrum( const Image<Complex> &input_image, const Image<MASKTYPE> &filter_mask, Image<Complex> &result )",
+				"Filter mask and image must be the same size.");
+		}
+		if ((input_image.getWidth() != result.getWidth()) || (input_image.getHeight() != result.getHeight()))
+		{
+			result.resize(input_image.getWidth(), input_image.getHeight());
+		}
+
+		//
+		// Multiply row by row (the images may be views with a row pitch)
+		//
+		for (int y = 0; y < input_image.getHeight(); ++y)
+			ComplexKernels::doMultiply(input_image.getRow(y), filter_mask.getRow(y), result.getRow(y), input_image.getWidth());
+	}
+
+	/* *********************************************************************************** */
+	/* Faltung mit aufgefuelltem Eingabebild. */
+	template <typename MASKTYPE>
+	inline void FrequencyDomainFilteringBaseTemplate<MASKTYPE>::doConvolutionWithImage(const Image<Complex> &input_image, Image<Complex> &result, PaddingMode padding)
+	/* *********************************************************************************** */
+	{
+		if (padding == NO_PADDING)
+		{
+			doConvolutionWithImage(input_image, result);
+			return;
+		}
+
+		if (m_filter_mask_available)
+		{
+			// Padding and Nyquist Modulation
+			doPadding(input_image, padding, m_tmp1);
+			// Bild in den Frequenzraum transformieren
+			a_fft.doFourierTransform2D(m_tmp1, m_tmp2);
+			// Perform filtering (with the mask resampled to the padded size, if necessary)
+			Image<MASKTYPE> padded_mask;
+			doMultiplySpectrum(m_tmp2, getPaddedMask(m_filter_mask, input_image.getWidth(), input_image.getHeight(), padded_mask), m_tmp1);
+			// Transform the result back into position space
+			a_fft.doInvFourierTransform2D(m_tmp1);
+			// Nyquist Modulation and cropping
+			doCropping(m_tmp1, input_image.getWidth(), input_image.getHeight(), result);
+		}
+		else
+		{
+			gerr << "Error in FrequencyFiltering::doConvolutionWithImage( const Image<Complex> &input_image, Image<Complex> &result, PaddingMode padding )" << endl;
+			gerr << "Filter mask does not exist." << endl;
+		};
+	}
+
+	/* *********************************************************************************** */
+	/* Bild im Ortsraum auffuellen und modulieren. */
+	template <typename MASKTYPE>
+	inline void FrequencyDomainFilteringBaseTemplate<MASKTYPE>::doPadding(const Image<Complex> &image, PaddingMode padding, Image<Complex> &padded)
+	/* *********************************************************************************** */
+	{
+		int width = image.getWidth();
+		int height = image.getHeight();
+		int size = getPaddedSize(width, height);
+
+		if ((padded.getWidth() != size) || (padded.getHeight() != size))
+			padded.resize(size, size);
+
+		//
+		// Source column (row) of each padded column (row); -1: zero.
+		// Padded pixels behind the image are taken from the nearer border, where the
+		// first image column follows the last padded column (cyclic convolution).
+		//
+		std::vector<int> columns(size);
+		std::vector<int> rows(size);
+		for (int pass = 0; pass < 2; ++pass)
+		{
+			std::vector<int> &index = pass ? rows : columns;
+			int length = pass ? height : width;
+
+			for (int i = 0; i < size; ++i)
+			{
+				if (i < length)
+				{
+					index[i] = i;
+					continue;
+				}
+
+				int distance_end = i - length + 1; // distance to the last image pixel
+				int distance_begin = size - i;	   // distance to the first image pixel (cyclic)
+
+				switch (padding)
+				{
+				case MIRROR_PADDING:
+					if (distance_end <= distance_begin)
+						index[i] = std::max(length - distance_end, 0);
+					else
+						index[i] = std::min(distance_begin - 1, length - 1);
+					break;
+				case REPLICATE_PADDING:
+					index[i] = (distance_end <= distance_begin) ? length - 1 : 0;
+					break;
+				default:
+					index[i] = -1;
+					break;
+				}
+			}
+		}
+
+		//
+		// Copy with Nyquist modulation (multiplication with (-1)^(x+y))
+		//
+		Complex *res = padded.getData();
+
+		for (int y = 0; y < size; ++y)
+		{
+			if (rows[y] < 0)
+			{
+				for (int x = 0; x < size; ++x, ++res)
+					*res = 0.0f;
+				continue;
+			}
+
+			const Complex *inp = image.getRow(rows[y]);
+			float sign = (y & 1) ? -1.0f : 1.0f;
+
+			for (int x = 0; x < size; ++x, ++res, sign = -sign)
+			{
+				if (columns[x] < 0)
+					*res = 0.0f;
+				else
+					*res = inp[columns[x]] * sign;
+			}
+		}
+	}
+
+	/* *********************************************************************************** */
+	/* Ergebnis im Ortsraum beschneiden und modulieren. */
+	template <typename MASKTYPE>
+	inline void FrequencyDomainFilteringBaseTemplate<MASKTYPE>::doCropping(const Image<Complex> &padded, int width, int height, Image<Complex> &result)
+	/* *********************************************************************************** */
+	{
+		if ((result.getWidth() != width) || (result.getHeight() != height))
+			result.resize(width, height);
+
+		Complex *res = result.getData();
+		for (int y = 0; y < height; ++y)
+		{
+			const Complex *inp = padded.getData() + y * padded.getWidth();
+			float sign = (y & 1) ? -1.0f : 1.0f;
+
+			for (int x = 0; x < width; ++x, ++res, sign = -sign)
+				*res = inp[x] * sign;
+		}
+	}
+
+	/* *********************************************************************************** */
+	/* Ergebnis im Ortsraum beschneiden und modulieren (nur Realteil). */
+	template <typename MASKTYPE>
+	inline void FrequencyDomainFilteringBaseTemplate<MASKTYPE>::doCropping(const Image<Complex> &padded, int width, int height, Image<float> &result)
+	/* *********************************************************************************** */
+	{
+		if ((result.getWidth() != width) || (result.getHeight() != height))
+			result.resize(width, height);
+
+		float *res = result.getData();
+		for (int y = 0; y < height; ++y)
+		{
+			const Complex *inp = padded.getData() + y * padded.getWidth();
+			float sign = (y & 1) ? -1.0f : 1.0f;
+
+			for (int x = 0; x < width; ++x, ++res, sign = -sign)
+				*res = inp[x].re * sign;
+		}
+	}
+
+	/* *********************************************************************************** */
+	/* Filtermaske auf die aufgefuellte Groesse bringen. */
+	template <typename MASKTYPE>
+	inline const Image<MASKTYPE> &FrequencyDomainFilteringBaseTemplate<MASKTYPE>::getPaddedMask(const Image<MASKTYPE> &filter_mask, int width, int height, Image<MASKTYPE> &buffer)
+	/* *********************************************************************************** */
+	{
+		int size = getPaddedSize(width, height);
+
+		if ((filter_mask.getWidth() != width) || (filter_mask.getHeight() != height) || ((width == size) && (height == size)))
+			return filter_mask;
+
+		if ((buffer.getWidth() != size) || (buffer.getHeight() != size))
+			buffer.resize(size, size);
+
+		//
+		// Bilinear interpolation at the same frequencies: the padded mask pixel X
+		// corresponds to the frequency (X - size/2) / size, the mask pixel x to (x - width/2) / width
+		//
+		const MASKTYPE *mask = filter_mask.getData();
+		MASKTYPE *res = buffer.getData();
+		float scale_x = (float)width / size;
+		float scale_y = (float)height / size;
+
+		for (int y = 0; y < size; ++y)
+		{
+			float fy = std::min(std::max(height / 2 + (y - size / 2) * scale_y, 0.0f), (float)(height - 1));
+			int y0 = (int)fy;
+			int y1 = std::min(y0 + 1, height - 1);
+			float wy = fy - y0;
+
+			const MASKTYPE *line0 = mask + y0 * width;
+			const MASKTYPE *line1 = mask + y1 * width;
+
+			for (int x = 0; x < size; ++x, ++res)
+			{
+				float fx = std::min(std::max(width / 2 + (x - size / 2) * scale_x, 0.0f), (float)(width - 1));
+				int x0 = (int)fx;
+				int x1 = std::min(x0 + 1, width - 1);
+				float wx = fx - x0;
+
+				*res = (line0[x0] * (1.0f - wx) + line0[x1] * wx) * (1.0f - wy) +
+					   (line1[x0] * (1.0f - wx) + line1[x1] * wx) * wy;
+			}
+		}
+
+		return buffer;
+	}
+
 }
 
 #endif /*__GET__FREQUENCYDOMAINFILTERING_BASETEMPLATE_H*/
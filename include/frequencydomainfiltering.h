@@ -60,6 +60,17 @@ class FrequencyDomainFiltering : public FrequencyDomainFilteringBaseTemplate<Com
 	 */
 	void setSpatialMask( const Image<Complex> &filter_mask );
 
+	/** Setzt eine neue Orts-Filtermaske, deren Fourier-Transformierte einem Cache entnommen wird.
+	 * 
+	 * Wie setSpatialMask( const Image<Complex>& ), die Fourier-Transformation wird aber nur
+	 * ausgefhrt, wenn cache noch keine Transformierte derselben Ortsmaske (alle Pixel) enthlt.
+	 * Die berechnete Transformierte wird in cache abgelegt.
+	 * 
+	 * @param filter_mask Image-Objekt in dem die neue Filtermaske bergeben wird (Ortsraum)
+	 * @param cache Cache berechneter Masken, z.B. SpectrumCache<Complex>::getSharedCache()
+	 */
+	inline void setSpatialMask( const Image<Complex> &filter_mask, SpectrumCache<Complex> &cache );
+
 	/** Filterung im Ortsraum(Faltung) ausfhren.
 	 * 
 	 * Die Filtermaske wird als Ortsfiltermaske bergeben und zunchst in den
@@ -82,6 +93,22 @@ class FrequencyDomainFiltering : public FrequencyDomainFilteringBaseTemplate<Com
 
 
 
+/* *********************************************************************************** */
+/* Setzt eine neue Orts-Filtermaske (Transformierte aus dem Cache). */
+inline void FrequencyDomainFiltering::setSpatialMask( const Image<Complex> &filter_mask, SpectrumCache<Complex> &cache )
+/* *********************************************************************************** */
+{
+	// Fourier-Transformierte wiederverwenden, falls dieselbe Ortsmaske bereits transformiert wurde
+	SpectrumCache<Complex>::Key key = SpectrumCache<Complex>::makeSpatialKey( filter_mask );
+	if ( doLookupMask( cache, key ) )
+		return;
+
+	setSpatialMask( filter_mask );
+	doStoreMask( cache, key );
+}
+
+
+
 }
 
 #endif /*__GET__FREQUENCYFILTERING_H*/
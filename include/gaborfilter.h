@@ -22,6 +22,7 @@ namespace GET
  * parametrisiert werden kann. \n
  * Mittels doGaborFiltering() kann das Ergebnis der Gaborfilterung (Liste mit
  * Filterergebnissen der einzelnen Orientierungen) bestimmt werden.
+ * doGaborFilteringInSupport() filtert schneller nur im Trger der Filtermasken.
  * 
  * Diese Klasse arbeitet nur mit quadratischen Filtermasken (siehe m_width)
  * 
@@ -233,6 +234,53 @@ class GaborFilter
 
 
 
+/**
+ * Fhrt die Gaborfilterung nur im Trger der Filtermasken durch.
+ * 
+ * Wie GaborFilter::doGaborFiltering(), aber das Eingabebild wird nur einmal
+ * fouriertransformiert, das Spektrum wird nur innerhalb des Trgers der einzelnen
+ * Filtermasken multipliziert und die Orientierungen werden parallel zurcktransformiert
+ * (siehe FrequencyDomainFilteringBaseTemplate::doFilteringWithMasksGiveSpatialResult()).
+ * 
+ * Der Trger einer Filtermaske ist das umschlieende Rechteck aller Filterwerte, deren
+ * Betrag mindestens threshold mal dem Maximum der Filtermaske betrgt. Bei threshold = 0
+ * wird mit der vollstndigen Filtermaske gefiltert.
+ * 
+ * Mit reduced_resolution = true werden Breite und Hhe der Filterergebnisse durch die
+ * grte Zweierpotenz r geteilt, bei der die Trger aller Filtermasken noch vollstndig
+ * im verkleinerten Frequenzraum liegen. Die Filterergebnisse enthalten dann genau jeden
+ * r-ten Wert (in x- und y-Richtung) der Ergebnisse in voller Auflsung.
+ * 
+ * @param gabor_filter Gaborfilter, dessen Filterbank verwendet wird
+ * @param image Eingabebild - Bild im Ortsraum (Input)
+ * @param filter_result Liste der Filterergebnisse fr die verschiedenen Orientierungen (Ouput)
+ * @param threshold relative Schwelle fr vernachlssigbare Filterwerte (z.B. 1e-3)
+ * @param reduced_resolution true: Ergebnisse mit reduzierter Auflsung berechnen
+ */
+/* ************************************************************************** */
+inline void doGaborFilteringInSupport( GaborFilter &gabor_filter, const Image<Complex> &image, ImageSequence<Complex> &filter_result,
+									   float threshold, bool reduced_resolution = false )
+/* ************************************************************************** */
+{
+	const ImageSequence<float> &filterbank = gabor_filter.getFilterbank();
+
+	// Trger der Filtermasken aller Orientierungen
+	std::vector<SpectralSupport> supports( filterbank.getSize() );
+	for ( int i = 0; i < filterbank.getSize(); ++i )
+	{
+		supports[i] = FastFrequencyDomainFiltering::doComputeSupport( filterbank[i], threshold );
+	}
+
+	// Eingabebild nur einmal in den Frequenzraum transformieren
+	FastFrequencyDomainFiltering filtering;
+	filtering.setSpatialImage( image );
+
+	// Multiplikation nur im Trger, Rcktransformation aller Orientierungen parallel
+	filtering.doFilteringWithMasksGiveSpatialResult( filterbank, supports, reduced_resolution, filter_result );
+}
+
+
+
 } /* namespace GET */
 
 #endif /* __IMAGE_H */
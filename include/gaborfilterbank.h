@@ -0,0 +1,442 @@
+#pragma once
+
+#include "image.h"
+#include "imagesequence.h"
+#include "frequencydomainfiltering.h"
+
+#include <math.h>
+#include <algorithm>
+#include <list>
+#include <vector>
+
+namespace GET
+{
+
+	/** Multi-scale, multi-orientation Gabor and log-Gabor filter bank.
+	 *
+	 * In contrast to GaborFilter (one centroid frequency, several orientations), this filter bank
+	 * covers several scales. The centroid frequency of scale s is
+	 *
+	 *   k_s = max_frequency / scale_factor^s
+	 *
+	 * and the orientations are theta_o = o * pi / orientations. The filters are defined in the
+	 * (centred) frequency domain with frequencies in radians per pixel:
+	 *
+	 * - GABOR: Gaussian around k_s * (cos theta_o, sin theta_o) with a radial and a tangential
+	 *   standard deviation derived from the bandwidth and the angular spread.
+	 * - LOG_GABOR: exp(-ln(|k|/k_s)^2 / (2 ln(sigma)^2)) * exp(-(phi - theta_o)^2 / (2 sigma_theta^2)).
+	 *   Log-Gabor filters have no DC component and a symmetric bandwidth on a logarithmic
+	 *   frequency scale, so they cover several scales more evenly than Gabor filters.
+	 *
+	 * The input image is transformed into the frequency domain only once for all filters. The
+	 * filters are multiplied only within their support and processed in parallel (see
+	 * FrequencyDomainFilteringBaseTemplate::doFilteringWithMasksGiveSpatialResult()). The filters
+	 * are created on first use for an image size and kept for the next images of the same size.
+	 *
+	 * doEnergy() returns one energy map per scale (sum of the squared magnitudes of the filter
+	 * results of all orientations) without storing the complex filter results.
+	 *
+	 * @see GaborFilter
+	 * @note Source: D. J. Field - Relations between the statistics of natural images and the
+	 *       response properties of cortical cells. J. Opt. Soc. Am. A 4(12), 1987.
+	 */
+	class GaborFilterBank
+	{
+	public:
+		/** Filter types */
+		enum FilterType
+		{
+			GABOR,	  ///< Gabor filters (Gaussians in the frequency domain)
+			LOG_GABOR ///< log-Gabor filters (Gaussians on a logarithmic frequency scale)
+		};
+
+	private:
+		/** Filters and their supports for one image size */
+		struct FilterSet
+		{
+			int width;
+			int height;
+			ImageSequence<float> *filters;
+			std::vector<SpectralSupport> supports;
+		};
+
+		/** Filter type */
+		FilterType m_type;
+
+		/** Number of scales */
+		int m_scales;
+
+		/** Number of orientations per scale */
+		int m_orientations;
+
+		/** Centroid frequency of the finest scale (radians per pixel) */
+		float m_max_frequency;
+
+		/** Ratio between the centroid frequencies of successive scales */
+		float m_scale_factor;
+
+		/** Radial bandwidth of the filters at half maximum in octaves */
+		float m_bandwidth;
+
+		/** Angular standard deviation of the filters relative to the angle between two orientations */
+		float m_angular_spread;
+
+		/** Relative threshold for negligible filter values (see GaborFilter::setSupportThreshold()) */
+		float m_support_threshold;
+
+		/** Compute the results with reduced resolution (see GaborFilter::setReducedResolution()) */
+		bool m_reduced_resolution;
+
+		/** Filters for the recently used image sizes, the most recently used first */
+		std::list<FilterSet> m_filter_sets;
+
+		/** Maximum number of image sizes whose filters are kept */
+		int m_max_filter_sets;
+
+		/** Algorithm for filtering in the frequency domain */
+		FastFrequencyDomainFiltering a_filtering;
+
+	public:
+		/** Constructor.
+		 *
+		 * The filters are not created before the first filtering (or getFilters()).
+		 *
+		 * @param scales number of scales
+		 * @param orientations number of orientations per scale
+		 * @param max_frequency centroid frequency of the finest scale (radians per pixel, at most pi)
+		 * @param scale_factor ratio between the centroid frequencies of successive scales
+		 * @param type filter type
+		 */
+		inline GaborFilterBank(int scales = 4, int orientations = 6, float max_frequency = (float)(M_PI / 2.0),
+							   float scale_factor = 2.0f, FilterType type = LOG_GABOR);
+
+		/** Destructor. */
+		inline ~GaborFilterBank();
+
+		/** Sets the parameters of the filter bank.
+		 *
+		 * @see GaborFilterBank()
+		 */
+		inline void setParameters(int scales, int orientations, float max_frequency, float scale_factor = 2.0f, FilterType type = LOG_GABOR);
+
+		/** Sets the radial bandwidth (full width at half maximum) of the filters in octaves (default: 1). */
+		inline void setBandwidth(float octaves);
+
+		/** Sets the angular standard deviation of the filters relative to the angle pi/orientations
+		 * between two orientations (default: 0.6).
+		 */
+		inline void setAngularSpread(float spread);
+
+		/** Sets the relative threshold for negligible filter values (default: 1e-3).
+		 *
+		 * @see GaborFilter::setSupportThreshold()
+		 */
+		inline void setSupportThreshold(float threshold);
+
+		/** Switches the computation with reduced resolution on or off (default: off).
+		 *
+		 * The reduction is limited by the finest scale.
+		 *
+		 * @see GaborFilter::setReducedResolution()
+		 */
+		inline void setReducedResolution(bool reduced_resolution) { m_reduced_resolution = reduced_resolution; };
+
+		/** Sets the number of image sizes whose filters are kept (default: 4). */
+		inline void setMaxFilterSets(int filter_sets);
+
+		/** Deletes all created filters. */
+		inline void clearFilters();
+
+		/** Returns the filter type. */
+		inline FilterType getType() const { return m_type; };
+
+		/** Returns the number of scales. */
+		inline int getScales() const { return m_scales; };
+
+		/** Returns the number of orientations per scale. */
+		inline int getOrientations() const { return m_orientations; };
+
+		/** Returns the radial bandwidth in octaves. */
+		inline float getBandwidth() const { return m_bandwidth; };
+
+		/** Returns the relative angular spread. */
+		inline float getAngularSpread() const { return m_angular_spread; };
+
+		/** Returns the relative threshold for negligible filter values. */
+		inline float getSupportThreshold() const { return m_support_threshold; };
+
+		/** Returns whether the results are computed with reduced resolution. */
+		inline bool getReducedResolution() const { return m_reduced_resolution; };
+
+		/** Returns the centroid frequency of a scale (radians per pixel). */
+		inline float getFrequency(int scale) const { return m_max_frequency / powf(m_scale_factor, (float)scale); };
+
+		/** Returns the angle of an orientation (radians). */
+		inline float getAngle(int orientation) const { return (float)(M_PI * orientation / m_orientations); };
+
+		/** Returns the index of the filter (and filter result) of a scale and orientation. */
+		inline int getFilterIndex(int scale, int orientation) const { return scale * m_orientations + orientation; };
+
+		/** Returns the filters for an image size.
+		 *
+		 * The filter of scale s and orientation o has the index getFilterIndex(s, o).
+		 *
+		 * @param width width of the image
+		 * @param height height of the image
+		 * @return filters (frequency domain, centred)
+		 */
+		inline const ImageSequence<float> &getFilters(int width, int height);
+
+		/** Filters an image with all filters of the filter bank.
+		 *
+		 * @param image input image (position space)
+		 * @param results complex filter results (position space), the result of scale s and
+		 *        orientation o has the index getFilterIndex(s, o)
+		 */
+		inline void doFiltering(const Image<Complex> &image, ImageSequence<Complex> &results);
+
+		/** Computes the energy maps of all scales.
+		 *
+		 * The energy map of scale s is sum_o |r_so|^2, where r_so is the complex filter result
+		 * of scale s and orientation o.
+		 *
+		 * @param image input image (position space)
+		 * @param energy one energy map per scale (position space)
+		 */
+		inline void doEnergy(const Image<Complex> &image, ImageSequence<float> &energy);
+
+	private:
+		/** Returns the filters for an image size (created if necessary). */
+		inline FilterSet &doGetFilterSet(int width, int height);
+
+		/** Creates the filters of a filter set. */
+		inline void doCreateFilters(FilterSet &filter_set);
+
+		/** Deletes filter sets until at most filter_sets are left. */
+		inline void doEvictFilterSets(int filter_sets);
+
+		/** Copying a filter bank is not applicable. */
+		GaborFilterBank(const GaborFilterBank &);
+		/** Assignment operator is not applicable. */
+		GaborFilterBank &operator=(const GaborFilterBank &);
+	};
+
+	/* ************************************************************************** */
+	/* *** Implementation of the inline methods ********************************* */
+	/* ************************************************************************** */
+
+	/* ************************************************************************** */
+	inline GaborFilterBank::GaborFilterBank(int scales, int orientations, float max_frequency, float scale_factor, FilterType type) : m_type(type),
+																																	m_scales(scales),
+																																	m_orientations(orientations),
+																																	m_max_frequency(max_frequency),
+																																	m_scale_factor(scale_factor),
+																																	m_bandwidth(1.0f),
+																																	m_angular_spread(0.6f),
+																																	m_support_threshold(1e-3f),
+																																	m_reduced_resolution(false),
+																																	m_filter_sets(),
+																																	m_max_filter_sets(4),
+																																	a_filtering()
+	/* ************************************************************************** */
+	{
+	}
+
+	/* ************************************************************************** */
+	inline GaborFilterBank::~GaborFilterBank()
+	/* ************************************************************************** */
+	{
+		clearFilters();
+	}
+
+	/* ************************************************************************** */
+	inline void GaborFilterBank::setParameters(int scales, int orientations, float max_frequency, float scale_factor, FilterType type)
+	/* ************************************************************************** */
+	{
+		m_scales = scales;
+		m_orientations = orientations;
+		m_max_frequency = max_frequency;
+		m_scale_factor = scale_factor;
+		m_type = type;
+		clearFilters();
+	}
+
+	/* ************************************************************************** */
+	inline void GaborFilterBank::setBandwidth(float octaves)
+	/* ************************************************************************** */
+	{
+		m_bandwidth = octaves;
+		clearFilters();
+	}
+
+	/* ************************************************************************** */
+	inline void GaborFilterBank::setAngularSpread(float spread)
+	/* ************************************************************************** */
+	{
+		m_angular_spread = spread;
+		clearFilters();
+	}
+
+	/* ************************************************************************** */
+	inline void GaborFilterBank::setSupportThreshold(float threshold)
+	/* ************************************************************************** */
+	{
+		m_support_threshold = threshold;
+		clearFilters();
+	}
+
+	/* ************************************************************************** */
+	inline void GaborFilterBank::setMaxFilterSets(int filter_sets)
+	/* ************************************************************************** */
+	{
+		m_max_filter_sets = (filter_sets < 1) ? 1 : filter_sets;
+		doEvictFilterSets(m_max_filter_sets);
+	}
+
+	/* ************************************************************************** */
+	inline void GaborFilterBank::clearFilters()
+	/* ************************************************************************** */
+	{
+		doEvictFilterSets(0);
+	}
+
+	/* ************************************************************************** */
+	inline const ImageSequence<float> &GaborFilterBank::getFilters(int width, int height)
+	/* ************************************************************************** */
+	{
+		return *(doGetFilterSet(width, height).filters);
+	}
+
+	/* ************************************************************************** */
+	inline void GaborFilterBank::doFiltering(const Image<Complex> &image, ImageSequence<Complex> &results)
+	/* ************************************************************************** */
+	{
+		FilterSet &filter_set = doGetFilterSet(image.getWidth(), image.getHeight());
+
+		a_filtering.setSpatialImage(image);
+		a_filtering.doFilteringWithMasksGiveSpatialResult(*filter_set.filters, filter_set.supports, m_reduced_resolution, results);
+	}
+
+	/* ************************************************************************** */
+	inline void GaborFilterBank::doEnergy(const Image<Complex> &image, ImageSequence<float> &energy)
+	/* ************************************************************************** */
+	{
+		FilterSet &filter_set = doGetFilterSet(image.getWidth(), image.getHeight());
+
+		a_filtering.setSpatialImage(image);
+		a_filtering.doFilteringWithMasksGiveEnergy(*filter_set.filters, filter_set.supports, m_orientations, m_reduced_resolution, energy);
+	}
+
+	/* ************************************************************************** */
+	inline GaborFilterBank::FilterSet &GaborFilterBank::doGetFilterSet(int width, int height)
+	/* ************************************************************************** */
+	{
+		for (std::list<FilterSet>::iterator it = m_filter_sets.begin(); it != m_filter_sets.end(); ++it)
+		{
+			if ((it->width == width) && (it->height == height))
+			{
+				// Mark as most recently used
+				m_filter_sets.splice(m_filter_sets.begin(), m_filter_sets, it);
+				return m_filter_sets.front();
+			}
+		}
+
+		doEvictFilterSets(m_max_filter_sets - 1);
+
+		FilterSet filter_set;
+		filter_set.width = width;
+		filter_set.height = height;
+		filter_set.filters = new ImageSequence<float>(m_scales * m_orientations, width, height);
+		m_filter_sets.push_front(filter_set);
+
+		doCreateFilters(m_filter_sets.front());
+		return m_filter_sets.front();
+	}
+
+	/* ************************************************************************** */
+	inline void GaborFilterBank::doCreateFilters(FilterSet &filter_set)
+	/* ************************************************************************** */
+	{
+		int width = filter_set.width;
+		int height = filter_set.height;
+		int filters = m_scales * m_orientations;
+
+		const float ln2 = logf(2.0f);
+		const float half_maximum = sqrtf(2.0f * ln2); // distance of the half maximum in standard deviations
+
+		// Standard deviations relative to the centroid frequency
+		float sigma_theta = m_angular_spread * (float)M_PI / m_orientations;
+		float sigma_log = m_bandwidth * ln2 / (2.0f * half_maximum);
+		float sigma_radial = (powf(2.0f, m_bandwidth) - 1.0f) / ((powf(2.0f, m_bandwidth) + 1.0f) * half_maximum);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+		for (int i = 0; i < filters; ++i)
+		{
+			int scale = i / m_orientations;
+			int orientation = i % m_orientations;
+
+			float k = getFrequency(scale);
+			float theta = getAngle(orientation);
+			float cos_theta = cosf(theta);
+			float sin_theta = sinf(theta);
+
+			float *filter = (*filter_set.filters)[i].getData();
+
+			for (int y = 0; y < height; ++y)
+			{
+				float v = (float)(2.0 * M_PI * (y - height / 2) / height);
+
+				for (int x = 0; x < width; ++x, ++filter)
+				{
+					float u = (float)(2.0 * M_PI * (x - width / 2) / width);
+
+					if (m_type == GABOR)
+					{
+						// Coordinates along and across the orientation relative to the centroid
+						float a = (u * cos_theta + v * sin_theta - k) / (sigma_radial * k);
+						float b = (v * cos_theta - u * sin_theta) / (sigma_theta * k);
+						*filter = expf(-0.5f * (a * a + b * b));
+					}
+					else
+					{
+						float r = sqrtf(u * u + v * v);
+						if (r == 0.0f)
+						{
+							*filter = 0.0f;
+							continue;
+						}
+
+						// Angle difference in [-pi,pi]
+						float phi = atan2f(v, u) - theta;
+						if (phi > (float)M_PI)
+							phi -= (float)(2.0 * M_PI);
+						else if (phi < (float)-M_PI)
+							phi += (float)(2.0 * M_PI);
+
+						float radial = logf(r / k) / sigma_log;
+						float angular = phi / sigma_theta;
+						*filter = expf(-0.5f * (radial * radial + angular * angular));
+					}
+				}
+			}
+		}
+
+		filter_set.supports.resize(filters);
+		for (int i = 0; i < filters; ++i)
+			filter_set.supports[i] = FastFrequencyDomainFiltering::doComputeSupport((*filter_set.filters)[i], m_support_threshold);
+	}
+
+	/* ************************************************************************** */
+	inline void GaborFilterBank::doEvictFilterSets(int filter_sets)
+	/* ************************************************************************** */
+	{
+		while ((int)m_filter_sets.size() > std::max(filter_sets, 0))
+		{
+			delete m_filter_sets.back().filters;
+			m_filter_sets.pop_back();
+		}
+	}
+
+} /* namespace GET */
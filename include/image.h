@@ -1,9 +1,13 @@
 #pragma once
 
 #include "basetypes.h"
+#include "imagearithmetic.h"
+#include "imagememory.h"
 
 namespace GET
 {
+	template <typename Expression>
+	class ImageExpression;
 
 	/** Image.
 	 *
@@ -12,6 +16,22 @@ namespace GET
 	 * when instantiating the template. The base data type indicates the data type
 	 * of an individual pixel of the image. See basetypes.h for a list of possible base data types.
 	 *
+	 * The pointwise arithmetic (add(), sub(), mul(), div()) is implemented by ImageArithmetic,
+	 * which uses SIMD instructions for float, uchar, Rgb and Complex. Results of type uchar
+	 * and Rgb are saturated to [0,255].
+	 *
+	 * The image data is allocated by ImageMemory. An image managing its data always stores the rows
+	 * without gaps (packed layout, getStride() == getWidth()), since the prebuilt libraries process
+	 * getData() as an array of getSize() pixels. Only the first row therefore has the alignment of
+	 * the allocation; the SIMD loops use unaligned loads and stores. Images referring to the data of
+	 * others (ImageReference, ImageView) may have a row pitch greater than the width. Pixel (x,y) is
+	 * found at getData()[y*getStride()+x] or getRow(y)[x]. The methods of this class and image
+	 * expressions handle both cases; algorithms that treat getData() as an array of getSize() pixels
+	 * require isPacked().
+	 *
+	 * Copies of an image always get their own image data. Images that are copied often but
+	 * rarely changed can be held as SharedImage, whose copies share the data until one is changed.
+	 *
 	 * @author Holger T�ubig
 	 *
 	 * @todo Rename base data type to pixeltype?
@@ -26,13 +46,30 @@ namespace GET
 		int m_width;
 		/** Height of the image */
 		int m_height;
-		/** Number of pixels of the image (height*width) */
+		/** Number of pixels of the image (height*width).
+		 *
+		 * The type and position of the members m_width, m_height, m_size, m_data and m_data_owner
+		 * are those of older versions of this class, since the prebuilt libraries in lib/ are
+		 * compiled against them; use getSize(), which is not limited to 2^31 pixels.
+		 * If the rows are not stored one after the other (see m_stride), m_size is one less than
+		 * height*width. This marks m_stride as valid: code compiled against older versions never
+		 * sets m_stride, so there is no other place in the object for the information. Only images
+		 * referring to the data of others are marked; such images must not be passed to the
+		 * prebuilt libraries, which would process the first m_size pixels of m_data as the image.
+		 */
 		int m_size;
+		/** Distance between the beginnings of two rows in pixels (row pitch, >= m_width).
+		 *
+		 * Only valid if marked by m_size, otherwise the rows are stored without gaps (see getStride()).
+		 * The member fills the gap in front of m_data, so the size of the class does not change.
+		 */
+		int m_stride;
 		/** Pointer to the image data.
 		 *
 		 * The image data is stored pixel by pixel. The individual lines of the image
-		 * are written one after the other without a gap. This pointer points to an array
-		 * of size m_size that contains elements of the image's base data type.
+		 * are written one after the other, each starting getStride() pixels after the previous one
+		 * (without a gap in the packed layout, i.e. getStride() == m_width). This pointer points to an
+		 * array of size getStride()*m_height that contains elements of the image's base data type.
 		 */
 		Typ *m_data;
 		/** This flag indicates whether the memory for m_data is managed by this object (through the Image<> class).
@@ -81,6 +118,30 @@ namespace GET
 		 */
 		inline Image(const Image<Typ> &image); // must be specified separately according to the C++ specification
 
+#if __cplusplus >= 201103L
+		/** Move constructor.
+		 *
+		 * Takes over the image data of the passed image without copying it, so that images can be
+		 * returned by value at no cost. The passed image is empty (0x0) afterwards. If the passed
+		 * image does not manage its image data (e.g. ImageReference), this object refers to the
+		 * same data without managing it either.
+		 *
+		 * @param image image whose data is taken over
+		 */
+		inline Image(Image<Typ> &&image);
+
+		/** Move assignment.
+		 *
+		 * Takes over the image data of the passed image without copying it if both images manage
+		 * their image data themselves. Otherwise the image data is copied (see copy()), since the
+		 * memory of an image that does not manage its data cannot be exchanged.
+		 *
+		 * @param image image whose data is taken over
+		 * @return this object
+		 */
+		inline Image<Typ> &operator=(Image<Typ> &&image);
+#endif
+
 		/** Copy constructor that creates a copy while converting the image type.
 		 *
 		 * Creates a copy of the passed image. The image data are converted from the color
@@ -106,6 +167,7 @@ namespace GET
 		 * @param height Height of the image section to be copied
 		 *
 		 * @see List of possible base data types in basetypes.h
+		 * @see ImageView for a section without copying
 		 */
 		template <typename OriginalTyp>
 		inline Image(const Image<OriginalTyp> &image, int x0, int y0, int width, int height);
@@ -129,12 +191,12 @@ namespace GET
 		 * @return Number of pixels in the image
 		 * @see m_size
 		 */
-		inline int getSize() const { return m_size; };
+		inline PixelIndex getSize() const { return (PixelIndex)m_width * m_height; };
 
 		/** Resize image.
 		 *
 		 * The width and height of the image are changed. The image data will be lost!!!
-		 * (The image data is only retained if the number of image pixels does not change,
+		 * (The image data of a packed image is only retained if the number of image pixels does not change,
 		 * i.e. if the height*width remains constant).
 		 *
 		 * @param width  new width of the image
@@ -164,6 +226,21 @@ namespace GET
 		 */
 		inline BaseType *getData() const { return m_data; };
 
+		/** Returns the pointer to the first pixel of row y. */
+		inline BaseType *getRow(int y) const { return m_data + (PixelIndex)y * getStride(); };
+
+		/** Returns the distance between the beginnings of two rows in pixels (row pitch).
+		 *
+		 * \see m_stride
+		 */
+		inline int getStride() const { return isStrided() ? m_stride : m_width; };
+
+		/** Returns true, if the rows are stored without gaps (getStride() == getWidth()).
+		 *
+		 * Only then getData() points to an array of getSize() pixels.
+		 */
+		inline bool isPacked() const { return (getStride() == m_width) || (m_height <= 1); };
+
 		/** Copies an image including conversion of the image type.
 		 *
 		 * Copies the passed image. The image data is converted from the
@@ -190,10 +267,23 @@ namespace GET
 		 * @return this object
 		 *
 		 * @see List of possible base data types in basetypes.h
+		 * @see ImageView for a section without copying
 		 */
 		template <typename OriginalTyp>
 		Image<Typ> &copy(const Image<OriginalTyp> &image, int x0, int y0, int width, int height);
 
+		/** Evaluates an image expression (e.g. a * b + c) in a single pass and stores the result in this image.
+		 *
+		 * The image is resized to the size of the images of the expression.
+		 *
+		 * @param expression expression to be evaluated
+		 * @return this object
+		 *
+		 * @see ImageExpression (imageexpression.h)
+		 */
+		template <typename Expression>
+		Image<Typ> &copy(const ImageExpression<Expression> &expression);
+
 		/** pointwise addition of an image.
 		 *
 		 * @param image image to add
@@ -291,12 +381,19 @@ namespace GET
 		 * This was introduced to prevent false object copies from being created.
 		 *
 		 * Copying an object is possible with the copy constructors or the copy method.
+		 * Temporary images (e.g. return values) can be assigned with the move assignment.
 		 *
 		 * @see Image()
 		 * @see copy()
 		 * */
 		Image<Typ> &operator=(const Image<Typ> &);
 
+		/** Returns m_size for the current width and height (minus one, if m_stride is valid). */
+		inline int getSizeMark(bool strided) const { return (int)((unsigned)m_width * (unsigned)m_height - (strided ? 1u : 0u)); };
+
+		/** Returns true, if m_stride holds the row pitch (see m_size). */
+		inline bool isStrided() const { return m_size != getSizeMark(false); };
+
 	protected:
 		/** Special constructor that can only be used by derived classes.
 		 *
@@ -312,27 +409,41 @@ namespace GET
 		 * @param data_owner This flag indicates whether the memory for m_data is managed by the Image<> class.
 		 */
 		inline Image(int width, int height, bool data_owner);
+
+		/** Sets the row pitch, must be called after every change of m_width or m_height.
+		 *
+		 * Used by derived classes that refer to image data of others (e.g. ImageReference).
+		 *
+		 * @param stride distance between the beginnings of two rows in pixels (>= m_width)
+		 */
+		inline void setStride(int stride)
+		{
+			m_stride = stride;
+			m_size = getSizeMark(stride != m_width);
+		};
 	};
 
 	template <typename Typ>
 	inline Image<Typ>::Image(int width, int height) : m_width(width),
 													  m_height(height),
-													  m_size(width * height),
+													  m_size((int)((unsigned)width * (unsigned)height)),
+													  m_stride(width),
 													  m_data(NULL),
 													  m_data_owner(true)
 	{
-		m_data = new Typ[m_size];
+		m_data = ImageMemory::doAllocate<Typ>(getSize());
 	}
 
 	template <typename Typ>
 	template <typename OriginalTyp>
 	inline Image<Typ>::Image(const Image<OriginalTyp> &image) : m_width(image.getWidth()),
 																m_height(image.getHeight()),
-																m_size(image.getSize()),
+																m_size((int)((unsigned)m_width * (unsigned)m_height)),
+																m_stride(image.getWidth()),
 																m_data(NULL),
 																m_data_owner(true)
 	{
-		m_data = new Typ[m_size];
+		m_data = ImageMemory::doAllocate<Typ>(getSize());
 		copy(image);
 	}
 
@@ -340,30 +451,78 @@ namespace GET
 	template <typename Typ>
 	inline Image<Typ>::Image(const Image<Typ> &image) : m_width(image.getWidth()),
 														m_height(image.getHeight()),
-														m_size(image.getSize()),
+														m_size((int)((unsigned)m_width * (unsigned)m_height)),
+														m_stride(image.getWidth()),
 														m_data(NULL),
 														m_data_owner(true)
 	{
-		m_data = new Typ[m_size];
+		m_data = ImageMemory::doAllocate<Typ>(getSize());
 		copy(image);
 	}
 
+#if __cplusplus >= 201103L
+	template <typename Typ>
+	inline Image<Typ>::Image(Image<Typ> &&image) : m_width(image.m_width),
+												   m_height(image.m_height),
+												   m_size(image.m_size),
+												   m_stride(image.m_stride),
+												   m_data(image.m_data),
+												   m_data_owner(image.m_data_owner)
+	{
+		image.m_width = 0;
+		image.m_height = 0;
+		image.m_data = NULL;
+		image.setStride(0);
+	}
+
+	template <typename Typ>
+	inline Image<Typ> &Image<Typ>::operator=(Image<Typ> &&image)
+	{
+		if (&image == this)
+			return *this;
+
+		if (m_data_owner && image.m_data_owner)
+		{
+			ImageMemory::doFree(m_data, getSize());
+
+			m_width = image.m_width;
+			m_height = image.m_height;
+			m_size = image.m_size;
+			m_stride = image.m_stride;
+			m_data = image.m_data;
+
+			image.m_width = 0;
+			image.m_height = 0;
+			image.m_data = NULL;
+			image.setStride(0);
+		}
+		else
+		{
+			copy(image);
+		}
+
+		return *this;
+	}
+#endif
+
 	template <typename Typ>
 	template <typename OriginalTyp>
 	inline Image<Typ>::Image(const Image<OriginalTyp> &image, int x0, int y0, int width, int height) : m_width(width),
 																									   m_height(height),
-																									   m_size(width * height),
+																									   m_size((int)((unsigned)width * (unsigned)height)),
+																									   m_stride(width),
 																									   m_data(NULL),
 																									   m_data_owner(true)
 	{
-		m_data = new Typ[m_size];
+		m_data = ImageMemory::doAllocate<Typ>(getSize());
 		copy(image, x0, y0, width, height);
 	}
 
 	template <typename Typ>
 	inline Image<Typ>::Image(int width, int height, bool data_owner) : m_width(width),
 																	   m_height(height),
-																	   m_size(width * height),
+																	   m_size((int)((unsigned)width * (unsigned)height)),
+																	   m_stride(width),
 																	   m_data(NULL),
 																	   m_data_owner(data_owner)
 	{
@@ -372,28 +531,32 @@ namespace GET
 	template <typename Typ>
 	inline Image<Typ>::~Image()
 	{
-		if (m_data_owner && m_data)
-			delete[] m_data;
+		if (m_data_owner)
+			ImageMemory::doFree(m_data, getSize());
 	}
 
 	template <typename Typ>
 	inline void Image<Typ>::resize(int width, int height)
 	{
-		if (m_size == width * height)
+		if ((width == m_width) && (height == m_height))
+		{
+			return;
+		}
+		else if (isPacked() && (getSize() == (PixelIndex)width * height))
 		{
 			m_width = width;
 			m_height = height;
+			setStride(width);
 		}
 		else if (m_data_owner)
 		{
-			if (m_data)
-				delete m_data;
+			ImageMemory::doFree(m_data, getSize());
 
 			m_width = width;
 			m_height = height;
-			m_size = width * height;
+			setStride(width);
 
-			m_data = new Typ[m_size];
+			m_data = ImageMemory::doAllocate<Typ>(getSize());
 		}
 		else
 		{
@@ -412,15 +575,13 @@ namespace GET
 	{
 		resize(image.getWidth(), image.getHeight());
 
-		Typ *destination = m_data;
-		OriginalTyp *source = image.getData();
+		// packed images are copied as a single row
+		int rows = (isPacked() && image.isPacked()) ? 1 : m_height;
+		PixelIndex length = (rows == 1) ? getSize() : m_width;
 
-		int size = m_size;
-		for (int i = 0; i < size; ++i)
-		{
-			//		destination[i] = (Typ) source[i];
-			destination[i] = source[i];
-		}
+		// conversion of the base data type (SIMD for float <-> half, bfloat16)
+		for (int y = 0; y < rows; ++y)
+			ImageArithmetic::doConvert(getRow(y), (const OriginalTyp *)image.getRow(y), length);
 
 		return *this;
 	}
@@ -473,23 +634,10 @@ namespace GET
 		//
 		resize(width, height);
 
-		Typ *destination = m_data;
-		OriginalTyp *source = image.getData();
-		OriginalTyp *source_p;
-
-		source += y0 * source_width + x0; // Set source to position x0 of line y0
 		for (int y = 0; y < height; ++y)
 		{
-			source_p = source;				// Set source_p to position x0 of the current line
-			for (int x = 0; x < width; ++x) // copy width elements
-			{
-				//			*destination = (Typ) (*source_p);
-				*destination = *source_p;
-
-				++destination; // Increment destination after each copied element
-				++source_p;
-			}
-			source += source_width; // move source by one line
+			// width elements from position x0 of the current line
+			ImageArithmetic::doConvert(getRow(y), (const OriginalTyp *)image.getRow(y0 + y) + x0, width);
 		}
 
 		return *this;
@@ -515,17 +663,12 @@ namespace GET
 			return *this;
 		}
 
-		Typ *destination = m_data;
-		Typ *destination_end = destination + m_size;
-		Typ *source = image.getData();
-
-		while (destination != destination_end)
-		{
-			*destination += *source;
+		// packed images are processed as a single row
+		int rows = (isPacked() && image.isPacked()) ? 1 : m_height;
+		PixelIndex length = (rows == 1) ? getSize() : m_width;
 
-			++destination;
-			++source;
-		}
+		for (int y = 0; y < rows; ++y)
+			ImageArithmetic::doAdd(getRow(y), image.getRow(y), length);
 
 		return *this;
 	}
@@ -545,17 +688,12 @@ namespace GET
 			return *this;
 		}
 
-		Typ *destination = m_data;
-		Typ *destination_end = destination + m_size;
-		Typ *source = image.getData();
-
-		while (destination != destination_end)
-		{
-			*destination -= *source;
+		// packed images are processed as a single row
+		int rows = (isPacked() && image.isPacked()) ? 1 : m_height;
+		PixelIndex length = (rows == 1) ? getSize() : m_width;
 
-			++destination;
-			++source;
-		}
+		for (int y = 0; y < rows; ++y)
+			ImageArithmetic::doSub(getRow(y), image.getRow(y), length);
 
 		return *this;
 	}
@@ -575,17 +713,12 @@ namespace GET
 			return *this;
 		}
 
-		Typ *destination = m_data;
-		Typ *destination_end = destination + m_size;
-		Typ *source = image.getData();
+		// packed images are processed as a single row
+		int rows = (isPacked() && image.isPacked()) ? 1 : m_height;
+		PixelIndex length = (rows == 1) ? getSize() : m_width;
 
-		while (destination != destination_end)
-		{
-			*destination *= *source;
-
-			++destination;
-			++source;
-		}
+		for (int y = 0; y < rows; ++y)
+			ImageArithmetic::doMul(getRow(y), image.getRow(y), length);
 
 		return *this;
 	}
@@ -605,17 +738,12 @@ namespace GET
 			return *this;
 		}
 
-		Typ *destination = m_data;
-		Typ *destination_end = destination + m_size;
-		Typ *source = image.getData();
+		// packed images are processed as a single row
+		int rows = (isPacked() && image.isPacked()) ? 1 : m_height;
+		PixelIndex length = (rows == 1) ? getSize() : m_width;
 
-		while (destination != destination_end)
-		{
-			*destination /= *source;
-
-			++destination;
-			++source;
-		}
+		for (int y = 0; y < rows; ++y)
+			ImageArithmetic::doDiv(getRow(y), image.getRow(y), length);
 
 		return *this;
 	}
@@ -624,15 +752,11 @@ namespace GET
 	template <typename ValueType>
 	Image<Typ> &Image<Typ>::add(const ValueType &value)
 	{
+		int rows = isPacked() ? 1 : m_height;
+		PixelIndex length = (rows == 1) ? getSize() : m_width;
 
-		Typ *data = m_data;
-		Typ *data_end = data + m_size;
-
-		while (data != data_end)
-		{
-			*data += value;
-			++data;
-		}
+		for (int y = 0; y < rows; ++y)
+			ImageArithmetic::doAddValue(getRow(y), value, length);
 
 		return *this;
 	}
@@ -641,15 +765,11 @@ namespace GET
 	template <typename ValueType>
 	Image<Typ> &Image<Typ>::sub(const ValueType &value)
 	{
+		int rows = isPacked() ? 1 : m_height;
+		PixelIndex length = (rows == 1) ? getSize() : m_width;
 
-		Typ *data = m_data;
-		Typ *data_end = data + m_size;
-
-		while (data != data_end)
-		{
-			*data -= value;
-			++data;
-		}
+		for (int y = 0; y < rows; ++y)
+			ImageArithmetic::doSubValue(getRow(y), value, length);
 
 		return *this;
 	}
@@ -658,15 +778,11 @@ namespace GET
 	template <typename ValueType>
 	Image<Typ> &Image<Typ>::mul(const ValueType &value)
 	{
+		int rows = isPacked() ? 1 : m_height;
+		PixelIndex length = (rows == 1) ? getSize() : m_width;
 
-		Typ *data = m_data;
-		Typ *data_end = data + m_size;
-
-		while (data != data_end)
-		{
-			*data *= value;
-			++data;
-		}
+		for (int y = 0; y < rows; ++y)
+			ImageArithmetic::doMulValue(getRow(y), value, length);
 
 		return *this;
 	}
@@ -675,15 +791,11 @@ namespace GET
 	template <typename ValueType>
 	Image<Typ> &Image<Typ>::div(const ValueType &value)
 	{
+		int rows = isPacked() ? 1 : m_height;
+		PixelIndex length = (rows == 1) ? getSize() : m_width;
 
-		Typ *data = m_data;
-		Typ *data_end = data + m_size;
-
-		while (data != data_end)
-		{
-			*data /= value;
-			++data;
-		}
+		for (int y = 0; y < rows; ++y)
+			ImageArithmetic::doDivValue(getRow(y), value, length);
 
 		return *this;
 	}
@@ -717,16 +829,11 @@ namespace GET
 		//
 		// Perform operation
 		//
-		Typ *res = m_data;
-		Typ *data1 = img1.getData();
-		Typ *data2 = img2.getData();
-
-		int size = m_size;
+		int rows = (isPacked() && img1.isPacked() && img2.isPacked()) ? 1 : m_height;
+		PixelIndex length = (rows == 1) ? getSize() : m_width;
 
-		for (int i = 0; i < size; ++i)
-		{
-			res[i] = data1[i] + data2[i];
-		}
+		for (int y = 0; y < rows; ++y)
+			ImageArithmetic::doAdd(img1.getRow(y), img2.getRow(y), getRow(y), length);
 
 		//
 		// finished
@@ -763,16 +870,11 @@ namespace GET
 		//
 		// Perform operation
 		//
-		Typ *res = m_data;
-		Typ *data1 = img1.getData();
-		Typ *data2 = img2.getData();
+		int rows = (isPacked() && img1.isPacked() && img2.isPacked()) ? 1 : m_height;
+		PixelIndex length = (rows == 1) ? getSize() : m_width;
 
-		int size = m_size;
-
-		for (int i = 0; i < size; ++i)
-		{
-			res[i] = data1[i] - data2[i];
-		}
+		for (int y = 0; y < rows; ++y)
+			ImageArithmetic::doSub(img1.getRow(y), img2.getRow(y), getRow(y), length);
 
 		//
 		// finished
@@ -809,16 +911,11 @@ namespace GET
 		//
 		// Perform operation
 		//
-		Typ *res = m_data;
-		Typ *data1 = img1.getData();
-		Typ *data2 = img2.getData();
-
-		int size = m_size;
+		int rows = (isPacked() && img1.isPacked() && img2.isPacked()) ? 1 : m_height;
+		PixelIndex length = (rows == 1) ? getSize() : m_width;
 
-		for (int i = 0; i < size; ++i)
-		{
-			res[i] = data1[i] * data2[i];
-		}
+		for (int y = 0; y < rows; ++y)
+			ImageArithmetic::doMul(img1.getRow(y), img2.getRow(y), getRow(y), length);
 
 		//
 		// finished
@@ -855,16 +952,11 @@ namespace GET
 		//
 		// Perform operation
 		//
-		Typ *res = m_data;
-		Typ *data1 = img1.getData();
-		Typ *data2 = img2.getData();
-
-		int size = m_size;
+		int rows = (isPacked() && img1.isPacked() && img2.isPacked()) ? 1 : m_height;
+		PixelIndex length = (rows == 1) ? getSize() : m_width;
 
-		for (int i = 0; i < size; ++i)
-		{
-			res[i] = data1[i] / data2[i];
-		}
+		for (int y = 0; y < rows; ++y)
+			ImageArithmetic::doDiv(img1.getRow(y), img2.getRow(y), getRow(y), length);
 
 		//
 		// finished
@@ -876,14 +968,19 @@ namespace GET
 	template <typename ValueType>
 	Image<Typ> &Image<Typ>::fill(const ValueType &value)
 	{
+		int rows = isPacked() ? 1 : m_height;
+		PixelIndex length = (rows == 1) ? getSize() : m_width;
 
-		Typ *data = m_data;
-		Typ *data_end = data + m_size;
-
-		while (data != data_end)
+		for (int y = 0; y < rows; ++y)
 		{
-			*data = value;
-			++data;
+			Typ *data = getRow(y);
+			Typ *data_end = data + length;
+
+			while (data != data_end)
+			{
+				*data = value;
+				++data;
+			}
 		}
 
 		return *this;
@@ -0,0 +1,1763 @@
+#pragma once
+
+#include "basetypes.h"
+#include "complex.h"
+#include "pixeltraits.h"
+
+#if defined(__GNUC__) && defined(__SSE2__)
+#define GET_IMAGEARITHMETIC_SIMD
+#include <immintrin.h>
+#endif
+
+namespace GET
+{
+
+	/** Pointwise arithmetic on pixel arrays (implementation of Image::add(), sub(), mul() and div()).
+	 *
+	 * The generic templates apply the operators of the base data type pixel by pixel. For the
+	 * base data types float, uchar, Rgb and Complex there are overloads that process whole
+	 * vector registers. The instruction set is chosen at run time from the instruction sets the
+	 * CPU supports (SSE2, AVX2 or AVX-512), so the library does not have to be compiled for a
+	 * specific CPU. The SIMD code requires GCC or Clang on x86; otherwise the pixel loops are used.
+	 *
+	 * Results:
+	 * - float: identical to the pixel loops (IEEE operations, no fused multiply-add)
+	 * - uchar and Rgb (per channel): saturating, i.e. results are clamped to [0,255] instead of
+	 *   wrapping around modulo 256. Division is not vectorised.
+	 * - uint16 and int16: saturating as uchar (clamped to [0,65535] or [-32768,32767]).
+	 *   Division is not vectorised.
+	 * - generic templates: calculated in the accumulator type of PixelTraits and stored with its
+	 *   saturation, e.g. uchar, uint16, int16 and Rgb in float (rounded to the nearest
+	 *   value and clamped to the value range), all other types in the type itself.
+	 * - Complex: addition, subtraction and multiplication (no division operator exists)
+	 * - half and bfloat16: calculated in float (blocks are converted with doConvert()), the
+	 *   results are rounded as by the operators of the base data types. The conversions between
+	 *   half and float use the F16C instructions together with AVX2.
+	 *
+	 * doWiden() and doNarrow() convert rows between a base data type and its accumulator type,
+	 * e.g. for the convolution in SpatialFiltering. doNarrow() has SSE2 kernels for uchar,
+	 * uint16 and int16, doWiden() for uint16 and int16.
+	 *
+	 * doMaxMin() and doClamp() (implementation of Statistic and Clip for 16 bit images) have
+	 * SSE2 kernels for uint16 and int16.
+	 *
+	 * The conversions between Rgb or QRgb pixels and three planes (doDeinterleave(), doInterleave())
+	 * are the implementation of PlanarRgbImage::copy() and PlanarRgbImage::copyTo(). For Rgb they
+	 * have kernels with 128 bit byte shuffles (pshufb), which are only used if the CPU supports
+	 * AVX2; there are no AVX-512 kernels for them. QRgb has SSE2 kernels.
+	 *
+	 * All operations allow the result to be one of the operands (in-place operation).
+	 *
+	 * @see Image::add()
+	 */
+	class ImageArithmetic
+	{
+	public:
+		/** Instruction sets */
+		enum InstructionSet
+		{
+			SCALAR, ///< pixel loops
+			SSE2,	///< 128 bit registers
+			AVX2,	///< 256 bit registers
+			AVX512	///< 512 bit registers (AVX-512F and AVX-512BW)
+		};
+
+		/** Returns the instruction set used for the arithmetic. */
+		static inline InstructionSet getInstructionSet() { return getInstructionSetReference(); };
+
+		/** Sets the instruction set used for the arithmetic (e.g. for comparisons).
+		 *
+		 * Instruction sets the CPU does not support are replaced by the best supported one.
+		 *
+		 * @param instruction_set instruction set to be used
+		 */
+		static inline void setInstructionSet(InstructionSet instruction_set)
+		{
+			InstructionSet supported = getSupportedInstructionSet();
+			getInstructionSetReference() = (instruction_set < supported) ? instruction_set : supported;
+		};
+
+		/** Returns the best instruction set supported by the CPU. */
+		static inline InstructionSet getSupportedInstructionSet();
+
+		/* *** Generic pixel loops ******************************************** */
+
+		/** data[i] += source[i] (calculated in PixelTraits<Typ>::Accumulator) */
+		template <typename Typ>
+		static inline void doAdd(Typ *data, const Typ *source, PixelIndex size) { doAdd(data, source, data, size); };
+
+		/** data[i] -= source[i] (calculated in PixelTraits<Typ>::Accumulator) */
+		template <typename Typ>
+		static inline void doSub(Typ *data, const Typ *source, PixelIndex size) { doSub(data, source, data, size); };
+
+		/** data[i] *= source[i] (calculated in PixelTraits<Typ>::Accumulator) */
+		template <typename Typ>
+		static inline void doMul(Typ *data, const Typ *source, PixelIndex size) { doMul(data, source, data, size); };
+
+		/** data[i] /= source[i] (calculated in PixelTraits<Typ>::Accumulator) */
+		template <typename Typ>
+		static inline void doDiv(Typ *data, const Typ *source, PixelIndex size) { doDiv(data, source, data, size); };
+
+		/** result[i] = a[i] + b[i] (calculated in PixelTraits<Typ>::Accumulator) */
+		template <typename Typ>
+		static inline void doAdd(const Typ *a, const Typ *b, Typ *result, PixelIndex size)
+		{
+			for (PixelIndex i = 0; i < size; ++i)
+			{
+				typename PixelTraits<Typ>::Accumulator value = PixelTraits<Typ>::getAccumulator(a[i]);
+				value += PixelTraits<Typ>::getAccumulator(b[i]);
+				result[i] = PixelTraits<Typ>::getPixel(value);
+			}
+		};
+
+		/** result[i] = a[i] - b[i] (calculated in PixelTraits<Typ>::Accumulator) */
+		template <typename Typ>
+		static inline void doSub(const Typ *a, const Typ *b, Typ *result, PixelIndex size)
+		{
+			for (PixelIndex i = 0; i < size; ++i)
+			{
+				typename PixelTraits<Typ>::Accumulator value = PixelTraits<Typ>::getAccumulator(a[i]);
+				value -= PixelTraits<Typ>::getAccumulator(b[i]);
+				result[i] = PixelTraits<Typ>::getPixel(value);
+			}
+		};
+
+		/** result[i] = a[i] * b[i] (calculated in PixelTraits<Typ>::Accumulator) */
+		template <typename Typ>
+		static inline void doMul(const Typ *a, const Typ *b, Typ *result, PixelIndex size)
+		{
+			for (PixelIndex i = 0; i < size; ++i)
+			{
+				typename PixelTraits<Typ>::Accumulator value = PixelTraits<Typ>::getAccumulator(a[i]);
+				value *= PixelTraits<Typ>::getAccumulator(b[i]);
+				result[i] = PixelTraits<Typ>::getPixel(value);
+			}
+		};
+
+		/** result[i] = a[i] / b[i] (calculated in PixelTraits<Typ>::Accumulator) */
+		template <typename Typ>
+		static inline void doDiv(const Typ *a, const Typ *b, Typ *result, PixelIndex size)
+		{
+			for (PixelIndex i = 0; i < size; ++i)
+			{
+				typename PixelTraits<Typ>::Accumulator value = PixelTraits<Typ>::getAccumulator(a[i]);
+				value /= PixelTraits<Typ>::getAccumulator(b[i]);
+				result[i] = PixelTraits<Typ>::getPixel(value);
+			}
+		};
+
+		/** data[i] += value (calculated in PixelTraits<Typ>::Accumulator) */
+		template <typename Typ, typename ValueType>
+		static inline void doAddValue(Typ *data, const ValueType &value, PixelIndex size)
+		{
+			for (PixelIndex i = 0; i < size; ++i)
+			{
+				typename PixelTraits<Typ>::Accumulator sum = PixelTraits<Typ>::getAccumulator(data[i]);
+				sum += value;
+				data[i] = PixelTraits<Typ>::getPixel(sum);
+			}
+		};
+
+		/** data[i] -= value (calculated in PixelTraits<Typ>::Accumulator) */
+		template <typename Typ, typename ValueType>
+		static inline void doSubValue(Typ *data, const ValueType &value, PixelIndex size)
+		{
+			for (PixelIndex i = 0; i < size; ++i)
+			{
+				typename PixelTraits<Typ>::Accumulator difference = PixelTraits<Typ>::getAccumulator(data[i]);
+				difference -= value;
+				data[i] = PixelTraits<Typ>::getPixel(difference);
+			}
+		};
+
+		/** data[i] *= value (calculated in PixelTraits<Typ>::Accumulator) */
+		template <typename Typ, typename ValueType>
+		static inline void doMulValue(Typ *data, const ValueType &value, PixelIndex size)
+		{
+			for (PixelIndex i = 0; i < size; ++i)
+			{
+				typename PixelTraits<Typ>::Accumulator product = PixelTraits<Typ>::getAccumulator(data[i]);
+				product *= value;
+				data[i] = PixelTraits<Typ>::getPixel(product);
+			}
+		};
+
+		/** data[i] /= value (calculated in PixelTraits<Typ>::Accumulator) */
+		template <typename Typ, typename ValueType>
+		static inline void doDivValue(Typ *data, const ValueType &value, PixelIndex size)
+		{
+			for (PixelIndex i = 0; i < size; ++i)
+			{
+				typename PixelTraits<Typ>::Accumulator quotient = PixelTraits<Typ>::getAccumulator(data[i]);
+				quotient /= value;
+				data[i] = PixelTraits<Typ>::getPixel(quotient);
+			}
+		};
+
+		/* *** float ********************************************************** */
+
+		static inline void doAdd(float *data, const float *source, PixelIndex size) { doFloat(ADD, data, source, 0.0f, data, size); };
+		static inline void doSub(float *data, const float *source, PixelIndex size) { doFloat(SUB, data, source, 0.0f, data, size); };
+		static inline void doMul(float *data, const float *source, PixelIndex size) { doFloat(MUL, data, source, 0.0f, data, size); };
+		static inline void doDiv(float *data, const float *source, PixelIndex size) { doFloat(DIV, data, source, 0.0f, data, size); };
+		static inline void doAdd(const float *a, const float *b, float *result, PixelIndex size) { doFloat(ADD, a, b, 0.0f, result, size); };
+		static inline void doSub(const float *a, const float *b, float *result, PixelIndex size) { doFloat(SUB, a, b, 0.0f, result, size); };
+		static inline void doMul(const float *a, const float *b, float *result, PixelIndex size) { doFloat(MUL, a, b, 0.0f, result, size); };
+		static inline void doDiv(const float *a, const float *b, float *result, PixelIndex size) { doFloat(DIV, a, b, 0.0f, result, size); };
+		static inline void doAddValue(float *data, float value, PixelIndex size) { doFloat(ADD, data, 0, value, data, size); };
+		static inline void doSubValue(float *data, float value, PixelIndex size) { doFloat(SUB, data, 0, value, data, size); };
+		static inline void doMulValue(float *data, float value, PixelIndex size) { doFloat(MUL, data, 0, value, data, size); };
+		static inline void doDivValue(float *data, float value, PixelIndex size) { doFloat(DIV, data, 0, value, data, size); };
+		static inline void doAddValue(float *data, int value, PixelIndex size) { doAddValue(data, (float)value, size); };
+		static inline void doSubValue(float *data, int value, PixelIndex size) { doSubValue(data, (float)value, size); };
+		static inline void doMulValue(float *data, int value, PixelIndex size) { doMulValue(data, (float)value, size); };
+		static inline void doDivValue(float *data, int value, PixelIndex size) { doDivValue(data, (float)value, size); };
+
+		/* *** uchar (saturating) ********************************************* */
+
+		static inline void doAdd(uchar *data, const uchar *source, PixelIndex size) { doUchar(ADD, data, source, 0, data, size); };
+		static inline void doSub(uchar *data, const uchar *source, PixelIndex size) { doUchar(SUB, data, source, 0, data, size); };
+		static inline void doMul(uchar *data, const uchar *source, PixelIndex size) { doUchar(MUL, data, source, 0, data, size); };
+		static inline void doAdd(const uchar *a, const uchar *b, uchar *result, PixelIndex size) { doUchar(ADD, a, b, 0, result, size); };
+		static inline void doSub(const uchar *a, const uchar *b, uchar *result, PixelIndex size) { doUchar(SUB, a, b, 0, result, size); };
+		static inline void doMul(const uchar *a, const uchar *b, uchar *result, PixelIndex size) { doUchar(MUL, a, b, 0, result, size); };
+		static inline void doAddValue(uchar *data, int value, PixelIndex size) { doUcharValue((value < 0) ? SUB : ADD, data, (value < 0) ? -value : value, size); };
+		static inline void doSubValue(uchar *data, int value, PixelIndex size) { doUcharValue((value < 0) ? ADD : SUB, data, (value < 0) ? -value : value, size); };
+		static inline void doMulValue(uchar *data, int value, PixelIndex size) { doUcharValue(MUL, data, (value < 0) ? 0 : value, size); };
+		static inline void doAddValue(uchar *data, uchar value, PixelIndex size) { doAddValue(data, (int)value, size); };
+		static inline void doSubValue(uchar *data, uchar value, PixelIndex size) { doSubValue(data, (int)value, size); };
+		static inline void doMulValue(uchar *data, uchar value, PixelIndex size) { doMulValue(data, (int)value, size); };
+
+		/* *** uint16 and int16 (saturating) ********************************** */
+
+		static inline void doAdd(uint16 *data, const uint16 *source, PixelIndex size) { doInteger16(ADD, data, source, 0, data, size); };
+		static inline void doSub(uint16 *data, const uint16 *source, PixelIndex size) { doInteger16(SUB, data, source, 0, data, size); };
+		static inline void doMul(uint16 *data, const uint16 *source, PixelIndex size) { doInteger16(MUL, data, source, 0, data, size); };
+		static inline void doAdd(const uint16 *a, const uint16 *b, uint16 *result, PixelIndex size) { doInteger16(ADD, a, b, 0, result, size); };
+		static inline void doSub(const uint16 *a, const uint16 *b, uint16 *result, PixelIndex size) { doInteger16(SUB, a, b, 0, result, size); };
+		static inline void doMul(const uint16 *a, const uint16 *b, uint16 *result, PixelIndex size) { doInteger16(MUL, a, b, 0, result, size); };
+		static inline void doAddValue(uint16 *data, int value, PixelIndex size) { doInteger16((value < 0) ? SUB : ADD, data, (const uint16 *)0, (value < 0) ? -value : value, data, size); };
+		static inline void doSubValue(uint16 *data, int value, PixelIndex size) { doInteger16((value < 0) ? ADD : SUB, data, (const uint16 *)0, (value < 0) ? -value : value, data, size); };
+		static inline void doMulValue(uint16 *data, int value, PixelIndex size) { doInteger16(MUL, data, (const uint16 *)0, (value < 0) ? 0 : value, data, size); };
+		static inline void doAddValue(uint16 *data, uint16 value, PixelIndex size) { doAddValue(data, (int)value, size); };
+		static inline void doSubValue(uint16 *data, uint16 value, PixelIndex size) { doSubValue(data, (int)value, size); };
+		static inline void doMulValue(uint16 *data, uint16 value, PixelIndex size) { doMulValue(data, (int)value, size); };
+
+		static inline void doAdd(int16 *data, const int16 *source, PixelIndex size) { doInteger16(ADD, data, source, 0, data, size); };
+		static inline void doSub(int16 *data, const int16 *source, PixelIndex size) { doInteger16(SUB, data, source, 0, data, size); };
+		static inline void doMul(int16 *data, const int16 *source, PixelIndex size) { doInteger16(MUL, data, source, 0, data, size); };
+		static inline void doAdd(const int16 *a, const int16 *b, int16 *result, PixelIndex size) { doInteger16(ADD, a, b, 0, result, size); };
+		static inline void doSub(const int16 *a, const int16 *b, int16 *result, PixelIndex size) { doInteger16(SUB, a, b, 0, result, size); };
+		static inline void doMul(const int16 *a, const int16 *b, int16 *result, PixelIndex size) { doInteger16(MUL, a, b, 0, result, size); };
+		static inline void doAddValue(int16 *data, int value, PixelIndex size) { doInteger16(ADD, data, (const int16 *)0, value, data, size); };
+		static inline void doSubValue(int16 *data, int value, PixelIndex size) { doInteger16(SUB, data, (const int16 *)0, value, data, size); };
+		static inline void doMulValue(int16 *data, int value, PixelIndex size) { doInteger16(MUL, data, (const int16 *)0, value, data, size); };
+		static inline void doAddValue(int16 *data, int16 value, PixelIndex size) { doAddValue(data, (int)value, size); };
+		static inline void doSubValue(int16 *data, int16 value, PixelIndex size) { doSubValue(data, (int)value, size); };
+		static inline void doMulValue(int16 *data, int16 value, PixelIndex size) { doMulValue(data, (int)value, size); };
+
+		/* *** Rgb (saturating per channel) *********************************** */
+
+		static inline void doAdd(Rgb *data, const Rgb *source, PixelIndex size) { doUchar(ADD, (uchar *)data, (const uchar *)source, 0, (uchar *)data, 3 * size); };
+		static inline void doSub(Rgb *data, const Rgb *source, PixelIndex size) { doUchar(SUB, (uchar *)data, (const uchar *)source, 0, (uchar *)data, 3 * size); };
+		static inline void doAdd(const Rgb *a, const Rgb *b, Rgb *result, PixelIndex size) { doUchar(ADD, (const uchar *)a, (const uchar *)b, 0, (uchar *)result, 3 * size); };
+		static inline void doSub(const Rgb *a, const Rgb *b, Rgb *result, PixelIndex size) { doUchar(SUB, (const uchar *)a, (const uchar *)b, 0, (uchar *)result, 3 * size); };
+
+		/* *** Complex ******************************************************** */
+
+		static inline void doAdd(Complex *data, const Complex *source, PixelIndex size) { doFloat(ADD, (float *)data, (const float *)source, 0.0f, (float *)data, 2 * size); };
+		static inline void doSub(Complex *data, const Complex *source, PixelIndex size) { doFloat(SUB, (float *)data, (const float *)source, 0.0f, (float *)data, 2 * size); };
+		static inline void doMul(Complex *data, const Complex *source, PixelIndex size) { doComplexMul(data, source, data, size); };
+		static inline void doAdd(const Complex *a, const Complex *b, Complex *result, PixelIndex size) { doFloat(ADD, (const float *)a, (const float *)b, 0.0f, (float *)result, 2 * size); };
+		static inline void doSub(const Complex *a, const Complex *b, Complex *result, PixelIndex size) { doFloat(SUB, (const float *)a, (const float *)b, 0.0f, (float *)result, 2 * size); };
+		static inline void doMul(const Complex *a, const Complex *b, Complex *result, PixelIndex size) { doComplexMul(a, b, result, size); };
+		static inline void doMulValue(Complex *data, float value, PixelIndex size) { doFloat(MUL, (float *)data, 0, value, (float *)data, 2 * size); };
+
+		/* *** half and bfloat16 (calculated in float) ************************ */
+
+		static inline void doAdd(half *data, const half *source, PixelIndex size) { doFloat16(ADD, data, source, 0.0f, data, size); };
+		static inline void doSub(half *data, const half *source, PixelIndex size) { doFloat16(SUB, data, source, 0.0f, data, size); };
+		static inline void doMul(half *data, const half *source, PixelIndex size) { doFloat16(MUL, data, source, 0.0f, data, size); };
+		static inline void doDiv(half *data, const half *source, PixelIndex size) { doFloat16(DIV, data, source, 0.0f, data, size); };
+		static inline void doAdd(const half *a, const half *b, half *result, PixelIndex size) { doFloat16(ADD, a, b, 0.0f, result, size); };
+		static inline void doSub(const half *a, const half *b, half *result, PixelIndex size) { doFloat16(SUB, a, b, 0.0f, result, size); };
+		static inline void doMul(const half *a, const half *b, half *result, PixelIndex size) { doFloat16(MUL, a, b, 0.0f, result, size); };
+		static inline void doDiv(const half *a, const half *b, half *result, PixelIndex size) { doFloat16(DIV, a, b, 0.0f, result, size); };
+		static inline void doAddValue(half *data, float value, PixelIndex size) { doFloat16(ADD, data, (const half *)0, value, data, size); };
+		static inline void doSubValue(half *data, float value, PixelIndex size) { doFloat16(SUB, data, (const half *)0, value, data, size); };
+		static inline void doMulValue(half *data, float value, PixelIndex size) { doFloat16(MUL, data, (const half *)0, value, data, size); };
+		static inline void doDivValue(half *data, float value, PixelIndex size) { doFloat16(DIV, data, (const half *)0, value, data, size); };
+		static inline void doAddValue(half *data, int value, PixelIndex size) { doAddValue(data, (float)value, size); };
+		static inline void doSubValue(half *data, int value, PixelIndex size) { doSubValue(data, (float)value, size); };
+		static inline void doMulValue(half *data, int value, PixelIndex size) { doMulValue(data, (float)value, size); };
+		static inline void doDivValue(half *data, int value, PixelIndex size) { doDivValue(data, (float)value, size); };
+
+		static inline void doAdd(bfloat16 *data, const bfloat16 *source, PixelIndex size) { doFloat16(ADD, data, source, 0.0f, data, size); };
+		static inline void doSub(bfloat16 *data, const bfloat16 *source, PixelIndex size) { doFloat16(SUB, data, source, 0.0f, data, size); };
+		static inline void doMul(bfloat16 *data, const bfloat16 *source, PixelIndex size) { doFloat16(MUL, data, source, 0.0f, data, size); };
+		static inline void doDiv(bfloat16 *data, const bfloat16 *source, PixelIndex size) { doFloat16(DIV, data, source, 0.0f, data, size); };
+		static inline void doAdd(const bfloat16 *a, const bfloat16 *b, bfloat16 *result, PixelIndex size) { doFloat16(ADD, a, b, 0.0f, result, size); };
+		static inline void doSub(const bfloat16 *a, const bfloat16 *b, bfloat16 *result, PixelIndex size) { doFloat16(SUB, a, b, 0.0f, result, size); };
+		static inline void doMul(const bfloat16 *a, const bfloat16 *b, bfloat16 *result, PixelIndex size) { doFloat16(MUL, a, b, 0.0f, result, size); };
+		static inline void doDiv(const bfloat16 *a, const bfloat16 *b, bfloat16 *result, PixelIndex size) { doFloat16(DIV, a, b, 0.0f, result, size); };
+		static inline void doAddValue(bfloat16 *data, float value, PixelIndex size) { doFloat16(ADD, data, (const bfloat16 *)0, value, data, size); };
+		static inline void doSubValue(bfloat16 *data, float value, PixelIndex size) { doFloat16(SUB, data, (const bfloat16 *)0, value, data, size); };
+		static inline void doMulValue(bfloat16 *data, float value, PixelIndex size) { doFloat16(MUL, data, (const bfloat16 *)0, value, data, size); };
+		static inline void doDivValue(bfloat16 *data, float value, PixelIndex size) { doFloat16(DIV, data, (const bfloat16 *)0, value, data, size); };
+		static inline void doAddValue(bfloat16 *data, int value, PixelIndex size) { doAddValue(data, (float)value, size); };
+		static inline void doSubValue(bfloat16 *data, int value, PixelIndex size) { doSubValue(data, (float)value, size); };
+		static inline void doMulValue(bfloat16 *data, int value, PixelIndex size) { doMulValue(data, (float)value, size); };
+		static inline void doDivValue(bfloat16 *data, int value, PixelIndex size) { doDivValue(data, (float)value, size); };
+
+		/* *** Conversions (implementation of Image::copy()) ****************** */
+
+		/** destination[i] = source[i] (conversion operators of the base data types) */
+		template <typename Destination, typename Source>
+		static inline void doConvert(Destination *destination, const Source *source, PixelIndex size)
+		{
+			// some conversion operators (e.g. Rgb -> float) are not const
+			for (PixelIndex i = 0; i < size; ++i)
+				destination[i] = const_cast<Source &>(source[i]);
+		};
+
+		/** float -> half (F16C instructions, if available with AVX2) */
+		static inline void doConvert(half *destination, const float *source, PixelIndex size);
+
+		/** half -> float (F16C instructions, if available with AVX2) */
+		static inline void doConvert(float *destination, const half *source, PixelIndex size);
+
+		/** float -> bfloat16 */
+		static inline void doConvert(bfloat16 *destination, const float *source, PixelIndex size);
+
+		/** bfloat16 -> float */
+		static inline void doConvert(float *destination, const bfloat16 *source, PixelIndex size);
+
+		/** destination[i] = source[i] as accumulator (see PixelTraits) */
+		template <typename Typ>
+		static inline void doWiden(typename PixelTraits<Typ>::Accumulator *destination, const Typ *source, PixelIndex size)
+		{
+			for (PixelIndex i = 0; i < size; ++i)
+				destination[i] = PixelTraits<Typ>::getAccumulator(source[i]);
+		};
+
+		/** destination[i] = source[i] stored with the saturation of PixelTraits<Typ>::getPixel() */
+		template <typename Typ>
+		static inline void doNarrow(Typ *destination, const typename PixelTraits<Typ>::Accumulator *source, PixelIndex size)
+		{
+			doNarrowScalar(destination, source, size);
+		};
+
+		/** half -> float (see doConvert()) */
+		static inline void doWiden(float *destination, const half *source, PixelIndex size) { doConvert(destination, source, size); };
+
+		/** float -> half (see doConvert()) */
+		static inline void doNarrow(half *destination, const float *source, PixelIndex size) { doConvert(destination, source, size); };
+
+		/** bfloat16 -> float (see doConvert()) */
+		static inline void doWiden(float *destination, const bfloat16 *source, PixelIndex size) { doConvert(destination, source, size); };
+
+		/** float -> bfloat16 (see doConvert()) */
+		static inline void doNarrow(bfloat16 *destination, const float *source, PixelIndex size) { doConvert(destination, source, size); };
+
+		/** uint16 -> float (SSE2) */
+		static inline void doWiden(float *destination, const uint16 *source, PixelIndex size) { doWidenInteger16(destination, source, size); };
+
+		/** int16 -> float (SSE2) */
+		static inline void doWiden(float *destination, const int16 *source, PixelIndex size) { doWidenInteger16(destination, source, size); };
+
+		/** uint16 -> float (as doWiden()) */
+		static inline void doConvert(float *destination, const uint16 *source, PixelIndex size) { doWidenInteger16(destination, source, size); };
+
+		/** int16 -> float (as doWiden()) */
+		static inline void doConvert(float *destination, const int16 *source, PixelIndex size) { doWidenInteger16(destination, source, size); };
+
+		/** float -> uchar, rounded and saturated (SSE2) */
+		static inline void doNarrow(uchar *destination, const float *source, PixelIndex size) { doNarrowInteger(destination, source, size); };
+
+		/** float -> uint16, rounded and saturated (SSE2) */
+		static inline void doNarrow(uint16 *destination, const float *source, PixelIndex size) { doNarrowInteger(destination, source, size); };
+
+		/** float -> int16, rounded and saturated (SSE2) */
+		static inline void doNarrow(int16 *destination, const float *source, PixelIndex size) { doNarrowInteger(destination, source, size); };
+
+		/* *** Extrema and clamping (implementation of Statistic and Clip) ****** */
+
+		/** Maximum and minimum of data[0..size-1] (size >= 1, operator> of the base data type) */
+		template <typename Typ>
+		static inline void doMaxMin(const Typ *data, PixelIndex size, Typ &maximum, Typ &minimum)
+		{
+			maximum = minimum = data[0];
+			for (PixelIndex i = 1; i < size; ++i)
+			{
+				if (data[i] > maximum)
+					maximum = data[i];
+				else if (minimum > data[i])
+					minimum = data[i];
+			}
+		};
+
+		/** Maximum and minimum of data[0..size-1] (size >= 1, SSE2) */
+		static inline void doMaxMin(const uint16 *data, PixelIndex size, uint16 &maximum, uint16 &minimum);
+
+		/** Maximum and minimum of data[0..size-1] (size >= 1, SSE2) */
+		static inline void doMaxMin(const int16 *data, PixelIndex size, int16 &maximum, int16 &minimum);
+
+		/** data[i] = minimum, if data[i] < minimum, and maximum, if data[i] > maximum */
+		template <typename Typ>
+		static inline void doClamp(Typ *data, Typ minimum, Typ maximum, PixelIndex size)
+		{
+			for (PixelIndex i = 0; i < size; ++i)
+				data[i] = (data[i] < minimum) ? minimum : ((data[i] > maximum) ? maximum : data[i]);
+		};
+
+		/** data[i] clamped to [minimum,maximum] (SSE2) */
+		static inline void doClamp(uint16 *data, uint16 minimum, uint16 maximum, PixelIndex size);
+
+		/** data[i] clamped to [minimum,maximum] (SSE2) */
+		static inline void doClamp(int16 *data, int16 minimum, int16 maximum, PixelIndex size);
+
+		/* *** Planar and interleaved colour images *************************** */
+
+		/** Rgb -> three planes (128 bit byte shuffles, used if the CPU supports AVX2) */
+		static inline void doDeinterleave(const Rgb *source, uchar *red, uchar *green, uchar *blue, PixelIndex size);
+
+		/** three planes -> Rgb (128 bit byte shuffles, used if the CPU supports AVX2) */
+		static inline void doInterleave(const uchar *red, const uchar *green, const uchar *blue, Rgb *destination, PixelIndex size);
+
+		/** QRgb (0xAARRGGBB) -> three planes, the alpha channel is ignored */
+		static inline void doDeinterleave(const unsigned int *source, uchar *red, uchar *green, uchar *blue, PixelIndex size);
+
+		/** three planes -> QRgb (0xffRRGGBB) */
+		static inline void doInterleave(const uchar *red, const uchar *green, const uchar *blue, unsigned int *destination, PixelIndex size);
+
+	private:
+		/** Operations of the kernels */
+		enum Operation
+		{
+			ADD,
+			SUB,
+			MUL,
+			DIV
+		};
+
+		/** Storage of the instruction set used */
+		static inline InstructionSet &getInstructionSetReference()
+		{
+			static InstructionSet instruction_set = getSupportedInstructionSet();
+			return instruction_set;
+		};
+
+		/** result[i] = a[i] op b[i] (b == NULL: result[i] = a[i] op value) */
+		static inline void doFloat(Operation operation, const float *a, const float *b, float value, float *result, PixelIndex size);
+
+		/** result[i] = a[i] op b[i] with saturation (b == NULL: result[i] = a[i] op value, value >= 0) */
+		static inline void doUchar(Operation operation, const uchar *a, const uchar *b, int value, uchar *result, PixelIndex size);
+
+		/** data[i] = data[i] op value with saturation (value >= 0) */
+		static inline void doUcharValue(Operation operation, uchar *data, int value, PixelIndex size)
+		{
+			doUchar(operation, data, 0, (value > 255) ? 255 : value, data, size);
+		};
+
+		/** result[i] = a[i] op b[i] with saturation for uint16 and int16 (b == NULL: result[i] = a[i] op value) */
+		template <typename Typ>
+		static inline void doInteger16(Operation operation, const Typ *a, const Typ *b, int value, Typ *result, PixelIndex size);
+
+		/** doWiden() for uint16 and int16 (SSE2 kernel and pixel loop for the remaining pixels) */
+		template <typename Typ>
+		static inline void doWidenInteger16(float *destination, const Typ *source, PixelIndex size);
+
+		/** result[i] = a[i] * b[i] (complex) */
+		static inline void doComplexMul(const Complex *a, const Complex *b, Complex *result, PixelIndex size);
+
+		/** result[i] = a[i] op b[i] for half and bfloat16, calculated in float blocks by doFloat() */
+		template <typename Typ>
+		static inline void doFloat16(Operation operation, const Typ *a, const Typ *b, float value, Typ *result, PixelIndex size);
+
+		/** Pixel loop of doNarrow() */
+		template <typename Typ>
+		static inline void doNarrowScalar(Typ *destination, const typename PixelTraits<Typ>::Accumulator *source, PixelIndex size)
+		{
+			for (PixelIndex i = 0; i < size; ++i)
+				destination[i] = PixelTraits<Typ>::getPixel(source[i]);
+		};
+
+		/** doNarrow() for the integer types (SSE2 kernel and pixel loop for the remaining pixels) */
+		template <typename Typ>
+		static inline void doNarrowInteger(Typ *destination, const float *source, PixelIndex size);
+
+		/** Returns true, if the CPU supports the F16C instructions. */
+		static inline bool hasF16C();
+
+		/** Pixel loop of doFloat() */
+		static inline void doFloatScalar(Operation operation, const float *a, const float *b, float value, float *result, PixelIndex size);
+
+		/** Pixel loop of doUchar() */
+		static inline void doUcharScalar(Operation operation, const uchar *a, const uchar *b, int value, uchar *result, PixelIndex size);
+
+		/** Pixel loop of doInteger16() */
+		template <typename Typ>
+		static inline void doInteger16Scalar(Operation operation, const Typ *a, const Typ *b, int value, Typ *result, PixelIndex size);
+
+		/** Pixel loop of doComplexMul() */
+		static inline void doComplexMulScalar(const Complex *a, const Complex *b, Complex *result, PixelIndex size);
+
+#if defined(GET_IMAGEARITHMETIC_SIMD)
+		static inline void doFloatSSE2(Operation operation, const float *a, const float *b, float value, float *result, PixelIndex size);
+		static inline void doUcharSSE2(Operation operation, const uchar *a, const uchar *b, int value, uchar *result, PixelIndex size);
+		static inline void doComplexMulSSE2(const Complex *a, const Complex *b, Complex *result, PixelIndex size);
+		static inline void doConvertSSE2(bfloat16 *destination, const float *source, PixelIndex size);
+		static inline void doConvertSSE2(float *destination, const bfloat16 *source, PixelIndex size);
+		static inline void doDeinterleaveSSE2(const unsigned int *source, uchar *red, uchar *green, uchar *blue, PixelIndex size);
+		static inline void doInterleaveSSE2(const uchar *red, const uchar *green, const uchar *blue, unsigned int *destination, PixelIndex size);
+		static inline __m128i getRoundedSSE2(__m128 value, __m128 minimum, __m128 maximum);
+		static inline __m128i getInteger16SSE2(Operation operation, __m128i x, __m128i y, uint16);
+		static inline __m128i getInteger16SSE2(Operation operation, __m128i x, __m128i y, int16);
+		template <typename Typ>
+		static inline void doInteger16SSE2(Operation operation, const Typ *a, const Typ *b, int value, Typ *result, PixelIndex size);
+		static inline void doWidenSSE2(float *destination, const uint16 *source, PixelIndex size);
+		static inline void doWidenSSE2(float *destination, const int16 *source, PixelIndex size);
+		static inline void doMaxMinSSE2(const int16 *data, PixelIndex size, int16 bias, int16 &maximum, int16 &minimum);
+		static inline void doClampSSE2(int16 *data, int16 minimum, int16 maximum, int16 bias, PixelIndex size);
+		static inline void doNarrowSSE2(uchar *destination, const float *source, PixelIndex size);
+		static inline void doNarrowSSE2(uint16 *destination, const float *source, PixelIndex size);
+		static inline void doNarrowSSE2(int16 *destination, const float *source, PixelIndex size);
+
+		__attribute__((target("avx2"))) static inline void doFloatAVX2(Operation operation, const float *a, const float *b, float value, float *result, PixelIndex size);
+		__attribute__((target("avx2"))) static inline void doUcharAVX2(Operation operation, const uchar *a, const uchar *b, int value, uchar *result, PixelIndex size);
+		__attribute__((target("avx2"))) static inline __m256i getInteger16AVX2(Operation operation, __m256i x, __m256i y, uint16);
+		__attribute__((target("avx2"))) static inline __m256i getInteger16AVX2(Operation operation, __m256i x, __m256i y, int16);
+		template <typename Typ>
+		__attribute__((target("avx2"))) static inline void doInteger16AVX2(Operation operation, const Typ *a, const Typ *b, int value, Typ *result, PixelIndex size);
+		__attribute__((target("avx2"))) static inline void doComplexMulAVX2(const Complex *a, const Complex *b, Complex *result, PixelIndex size);
+		__attribute__((target("avx2,f16c"))) static inline void doConvertF16C(half *destination, const float *source, PixelIndex size);
+		__attribute__((target("avx2,f16c"))) static inline void doConvertF16C(float *destination, const half *source, PixelIndex size);
+		__attribute__((target("avx2"))) static inline void doConvertAVX2(bfloat16 *destination, const float *source, PixelIndex size);
+		__attribute__((target("avx2"))) static inline void doConvertAVX2(float *destination, const bfloat16 *source, PixelIndex size);
+		__attribute__((target("avx2"))) static inline void doDeinterleaveAVX2(const Rgb *source, uchar *red, uchar *green, uchar *blue, PixelIndex size);
+		__attribute__((target("avx2"))) static inline void doInterleaveAVX2(const uchar *red, const uchar *green, const uchar *blue, Rgb *destination, PixelIndex size);
+
+		__attribute__((target("avx512f,avx512bw"))) static inline void doFloatAVX512(Operation operation, const float *a, const float *b, float value, float *result, PixelIndex size);
+		__attribute__((target("avx512f,avx512bw"))) static inline void doUcharAVX512(Operation operation, const uchar *a, const uchar *b, int value, uchar *result, PixelIndex size);
+		__attribute__((target("avx512f,avx512bw"))) static inline void doComplexMulAVX512(const Complex *a, const Complex *b, Complex *result, PixelIndex size);
+#endif
+	};
+
+	/* ************************************************************************** */
+	/* *** Implementation of the inline methods ********************************* */
+	/* ************************************************************************** */
+
+	/* ************************************************************************** */
+	inline ImageArithmetic::InstructionSet ImageArithmetic::getSupportedInstructionSet()
+	/* ************************************************************************** */
+	{
+#if defined(GET_IMAGEARITHMETIC_SIMD)
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+			return AVX512;
+		if (__builtin_cpu_supports("avx2"))
+			return AVX2;
+		return SSE2;
+#else
+		return SCALAR;
+#endif
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doFloat(Operation operation, const float *a, const float *b, float value, float *result, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		switch (getInstructionSet())
+		{
+#if defined(GET_IMAGEARITHMETIC_SIMD)
+		case AVX512:
+			doFloatAVX512(operation, a, b, value, result, size);
+			break;
+		case AVX2:
+			doFloatAVX2(operation, a, b, value, result, size);
+			break;
+		case SSE2:
+			doFloatSSE2(operation, a, b, value, result, size);
+			break;
+#endif
+		default:
+			doFloatScalar(operation, a, b, value, result, size);
+			break;
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doUchar(Operation operation, const uchar *a, const uchar *b, int value, uchar *result, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		switch (getInstructionSet())
+		{
+#if defined(GET_IMAGEARITHMETIC_SIMD)
+		case AVX512:
+			doUcharAVX512(operation, a, b, value, result, size);
+			break;
+		case AVX2:
+			doUcharAVX2(operation, a, b, value, result, size);
+			break;
+		case SSE2:
+			doUcharSSE2(operation, a, b, value, result, size);
+			break;
+#endif
+		default:
+			doUcharScalar(operation, a, b, value, result, size);
+			break;
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doComplexMul(const Complex *a, const Complex *b, Complex *result, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		switch (getInstructionSet())
+		{
+#if defined(GET_IMAGEARITHMETIC_SIMD)
+		case AVX512:
+			doComplexMulAVX512(a, b, result, size);
+			break;
+		case AVX2:
+			doComplexMulAVX2(a, b, result, size);
+			break;
+		case SSE2:
+			doComplexMulSSE2(a, b, result, size);
+			break;
+#endif
+		default:
+			doComplexMulScalar(a, b, result, size);
+			break;
+		}
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void ImageArithmetic::doFloat16(Operation operation, const Typ *a, const Typ *b, float value, Typ *result, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		// blocks small enough for the L1 cache
+		const PixelIndex BLOCK = 512;
+		float fa[BLOCK];
+		float fb[BLOCK];
+		for (PixelIndex i = 0; i < size; i += BLOCK)
+		{
+			PixelIndex length = (size - i < BLOCK) ? size - i : BLOCK;
+			doConvert(fa, a + i, length);
+			if (b)
+				doConvert(fb, b + i, length);
+			doFloat(operation, fa, b ? fb : 0, value, fa, length);
+			doConvert(result + i, fa, length);
+		}
+	}
+
+	/* ************************************************************************** */
+	inline bool ImageArithmetic::hasF16C()
+	/* ************************************************************************** */
+	{
+#if defined(GET_IMAGEARITHMETIC_SIMD)
+		static bool f16c = (__builtin_cpu_init(), __builtin_cpu_supports("f16c") != 0);
+		return f16c;
+#else
+		return false;
+#endif
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doConvert(half *destination, const float *source, PixelIndex size)
+	/* ************************************************************************** */
+	{
+#if defined(GET_IMAGEARITHMETIC_SIMD)
+		if ((getInstructionSet() >= AVX2) && hasF16C())
+		{
+			doConvertF16C(destination, source, size);
+			return;
+		}
+#endif
+		for (PixelIndex i = 0; i < size; ++i)
+			destination[i].bits = half::getBits(source[i]);
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doConvert(float *destination, const half *source, PixelIndex size)
+	/* ************************************************************************** */
+	{
+#if defined(GET_IMAGEARITHMETIC_SIMD)
+		if ((getInstructionSet() >= AVX2) && hasF16C())
+		{
+			doConvertF16C(destination, source, size);
+			return;
+		}
+#endif
+		for (PixelIndex i = 0; i < size; ++i)
+			destination[i] = half::getFloat(source[i].bits);
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doConvert(bfloat16 *destination, const float *source, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		switch (getInstructionSet())
+		{
+#if defined(GET_IMAGEARITHMETIC_SIMD)
+		case AVX512:
+		case AVX2:
+			doConvertAVX2(destination, source, size);
+			break;
+		case SSE2:
+			doConvertSSE2(destination, source, size);
+			break;
+#endif
+		default:
+			for (PixelIndex i = 0; i < size; ++i)
+				destination[i].bits = bfloat16::getBits(source[i]);
+			break;
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doConvert(float *destination, const bfloat16 *source, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		switch (getInstructionSet())
+		{
+#if defined(GET_IMAGEARITHMETIC_SIMD)
+		case AVX512:
+		case AVX2:
+			doConvertAVX2(destination, source, size);
+			break;
+		case SSE2:
+			doConvertSSE2(destination, source, size);
+			break;
+#endif
+		default:
+			for (PixelIndex i = 0; i < size; ++i)
+				destination[i] = bfloat16::getFloat(source[i].bits);
+			break;
+		}
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void ImageArithmetic::doInteger16(Operation operation, const Typ *a, const Typ *b, int value, Typ *result, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		// the SIMD kernels broadcast the value into 16 bit lanes
+		if (!b && ((value < PixelTraits<Typ>::MINIMUM_VALUE) || (value > PixelTraits<Typ>::MAXIMUM_VALUE)))
+		{
+			doInteger16Scalar(operation, a, b, value, result, size);
+			return;
+		}
+
+		switch (getInstructionSet())
+		{
+#if defined(GET_IMAGEARITHMETIC_SIMD)
+		case AVX512:
+		case AVX2:
+			doInteger16AVX2(operation, a, b, value, result, size);
+			break;
+		case SSE2:
+			doInteger16SSE2(operation, a, b, value, result, size);
+			break;
+#endif
+		default:
+			doInteger16Scalar(operation, a, b, value, result, size);
+			break;
+		}
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void ImageArithmetic::doWidenInteger16(float *destination, const Typ *source, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		PixelIndex i = 0;
+#if defined(GET_IMAGEARITHMETIC_SIMD)
+		if (getInstructionSet() >= SSE2)
+		{
+			doWidenSSE2(destination, source, size);
+			i = size - size % PixelTraits<Typ>::SIMD_WIDTH;
+		}
+#endif
+		for (; i < size; ++i)
+			destination[i] = (float)source[i];
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doMaxMin(const uint16 *data, PixelIndex size, uint16 &maximum, uint16 &minimum)
+	/* ************************************************************************** */
+	{
+#if defined(GET_IMAGEARITHMETIC_SIMD)
+		if ((getInstructionSet() >= SSE2) && (size >= 8))
+		{
+			// signed comparisons after flipping the sign bit
+			int16 max16, min16;
+			doMaxMinSSE2((const int16 *)data, size, (int16)0x8000, max16, min16);
+			maximum = (uint16)max16 ^ 0x8000;
+			minimum = (uint16)min16 ^ 0x8000;
+			return;
+		}
+#endif
+		doMaxMin<uint16>(data, size, maximum, minimum);
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doMaxMin(const int16 *data, PixelIndex size, int16 &maximum, int16 &minimum)
+	/* ************************************************************************** */
+	{
+#if defined(GET_IMAGEARITHMETIC_SIMD)
+		if ((getInstructionSet() >= SSE2) && (size >= 8))
+		{
+			doMaxMinSSE2(data, size, 0, maximum, minimum);
+			return;
+		}
+#endif
+		doMaxMin<int16>(data, size, maximum, minimum);
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doClamp(uint16 *data, uint16 minimum, uint16 maximum, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		PixelIndex i = 0;
+#if defined(GET_IMAGEARITHMETIC_SIMD)
+		if (getInstructionSet() >= SSE2)
+		{
+			// signed comparisons after flipping the sign bit
+			doClampSSE2((int16 *)data, (int16)(minimum ^ 0x8000), (int16)(maximum ^ 0x8000), (int16)0x8000, size);
+			i = size - size % 8;
+		}
+#endif
+		doClamp<uint16>(data + i, minimum, maximum, size - i);
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doClamp(int16 *data, int16 minimum, int16 maximum, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		PixelIndex i = 0;
+#if defined(GET_IMAGEARITHMETIC_SIMD)
+		if (getInstructionSet() >= SSE2)
+		{
+			doClampSSE2(data, minimum, maximum, 0, size);
+			i = size - size % 8;
+		}
+#endif
+		doClamp<int16>(data + i, minimum, maximum, size - i);
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void ImageArithmetic::doNarrowInteger(Typ *destination, const float *source, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		PixelIndex i = 0;
+#if defined(GET_IMAGEARITHMETIC_SIMD)
+		if (getInstructionSet() >= SSE2)
+		{
+			doNarrowSSE2(destination, source, size);
+			i = size - size % PixelTraits<Typ>::SIMD_WIDTH;
+		}
+#endif
+		doNarrowScalar(destination + i, source + i, size - i);
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doDeinterleave(const Rgb *source, uchar *red, uchar *green, uchar *blue, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		PixelIndex i = 0;
+#if defined(GET_IMAGEARITHMETIC_SIMD)
+		if (getInstructionSet() >= AVX2)
+		{
+			doDeinterleaveAVX2(source, red, green, blue, size);
+			i = size - size % 16;
+		}
+#endif
+		for (; i < size; ++i)
+		{
+			red[i] = source[i].r;
+			green[i] = source[i].g;
+			blue[i] = source[i].b;
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doInterleave(const uchar *red, const uchar *green, const uchar *blue, Rgb *destination, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		PixelIndex i = 0;
+#if defined(GET_IMAGEARITHMETIC_SIMD)
+		if (getInstructionSet() >= AVX2)
+		{
+			doInterleaveAVX2(red, green, blue, destination, size);
+			i = size - size % 16;
+		}
+#endif
+		for (; i < size; ++i)
+		{
+			destination[i].r = red[i];
+			destination[i].g = green[i];
+			destination[i].b = blue[i];
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doDeinterleave(const unsigned int *source, uchar *red, uchar *green, uchar *blue, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		PixelIndex i = 0;
+#if defined(GET_IMAGEARITHMETIC_SIMD)
+		if (getInstructionSet() >= SSE2)
+		{
+			doDeinterleaveSSE2(source, red, green, blue, size);
+			i = size - size % 16;
+		}
+#endif
+		for (; i < size; ++i)
+		{
+			red[i] = (uchar)(source[i] >> 16);
+			green[i] = (uchar)(source[i] >> 8);
+			blue[i] = (uchar)source[i];
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doInterleave(const uchar *red, const uchar *green, const uchar *blue, unsigned int *destination, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		PixelIndex i = 0;
+#if defined(GET_IMAGEARITHMETIC_SIMD)
+		if (getInstructionSet() >= SSE2)
+		{
+			doInterleaveSSE2(red, green, blue, destination, size);
+			i = size - size % 16;
+		}
+#endif
+		for (; i < size; ++i)
+			destination[i] = 0xff000000u | ((unsigned int)red[i] << 16) | ((unsigned int)green[i] << 8) | blue[i];
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doFloatScalar(Operation operation, const float *a, const float *b, float value, float *result, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		for (PixelIndex i = 0; i < size; ++i)
+		{
+			float y = b ? b[i] : value;
+			switch (operation)
+			{
+			case ADD:
+				result[i] = a[i] + y;
+				break;
+			case SUB:
+				result[i] = a[i] - y;
+				break;
+			case MUL:
+				result[i] = a[i] * y;
+				break;
+			case DIV:
+				result[i] = a[i] / y;
+				break;
+			}
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doUcharScalar(Operation operation, const uchar *a, const uchar *b, int value, uchar *result, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		for (PixelIndex i = 0; i < size; ++i)
+		{
+			int y = b ? b[i] : value;
+			int r;
+			switch (operation)
+			{
+			case ADD:
+				r = a[i] + y;
+				break;
+			case SUB:
+				r = a[i] - y;
+				break;
+			default:
+				r = a[i] * y;
+				break;
+			}
+			result[i] = (uchar)((r < 0) ? 0 : ((r > 255) ? 255 : r));
+		}
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void ImageArithmetic::doInteger16Scalar(Operation operation, const Typ *a, const Typ *b, int value, Typ *result, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		const double minimum = PixelTraits<Typ>::MINIMUM_VALUE;
+		const double maximum = PixelTraits<Typ>::MAXIMUM_VALUE;
+		for (PixelIndex i = 0; i < size; ++i)
+		{
+			// double: exact for all sums and products of 16 bit values and int
+			double y = b ? b[i] : value;
+			double r;
+			switch (operation)
+			{
+			case ADD:
+				r = a[i] + y;
+				break;
+			case SUB:
+				r = a[i] - y;
+				break;
+			default:
+				r = a[i] * y;
+				break;
+			}
+			result[i] = (Typ)((r < minimum) ? minimum : ((r > maximum) ? maximum : r));
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doComplexMulScalar(const Complex *a, const Complex *b, Complex *result, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		for (PixelIndex i = 0; i < size; ++i)
+		{
+			float re = a[i].re * b[i].re - a[i].im * b[i].im;
+			float im = a[i].re * b[i].im + a[i].im * b[i].re;
+			result[i].re = re;
+			result[i].im = im;
+		}
+	}
+
+#if defined(GET_IMAGEARITHMETIC_SIMD)
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doFloatSSE2(Operation operation, const float *a, const float *b, float value, float *result, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		__m128 v = _mm_set1_ps(value);
+		PixelIndex i = 0;
+		for (; i + 4 <= size; i += 4)
+		{
+			__m128 x = _mm_loadu_ps(a + i);
+			__m128 y = b ? _mm_loadu_ps(b + i) : v;
+			switch (operation)
+			{
+			case ADD:
+				x = _mm_add_ps(x, y);
+				break;
+			case SUB:
+				x = _mm_sub_ps(x, y);
+				break;
+			case MUL:
+				x = _mm_mul_ps(x, y);
+				break;
+			case DIV:
+				x = _mm_div_ps(x, y);
+				break;
+			}
+			_mm_storeu_ps(result + i, x);
+		}
+		doFloatScalar(operation, a + i, b ? b + i : 0, value, result + i, size - i);
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doUcharSSE2(Operation operation, const uchar *a, const uchar *b, int value, uchar *result, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		__m128i v = _mm_set1_epi8((char)value);
+		__m128i zero = _mm_setzero_si128();
+		PixelIndex i = 0;
+		for (; i + 16 <= size; i += 16)
+		{
+			__m128i x = _mm_loadu_si128((const __m128i *)(a + i));
+			__m128i y = b ? _mm_loadu_si128((const __m128i *)(b + i)) : v;
+			switch (operation)
+			{
+			case ADD:
+				x = _mm_adds_epu8(x, y);
+				break;
+			case SUB:
+				x = _mm_subs_epu8(x, y);
+				break;
+			default:
+			{
+				// 16 bit products, set to 255 if the upper byte is not zero
+				__m128i low = _mm_mullo_epi16(_mm_unpacklo_epi8(x, zero), _mm_unpacklo_epi8(y, zero));
+				__m128i high = _mm_mullo_epi16(_mm_unpackhi_epi8(x, zero), _mm_unpackhi_epi8(y, zero));
+				low = _mm_or_si128(low, _mm_cmpeq_epi16(_mm_cmpeq_epi16(_mm_srli_epi16(low, 8), zero), zero));
+				high = _mm_or_si128(high, _mm_cmpeq_epi16(_mm_cmpeq_epi16(_mm_srli_epi16(high, 8), zero), zero));
+				x = _mm_packus_epi16(_mm_and_si128(low, _mm_set1_epi16(255)), _mm_and_si128(high, _mm_set1_epi16(255)));
+				break;
+			}
+			}
+			_mm_storeu_si128((__m128i *)(result + i), x);
+		}
+		doUcharScalar(operation, a + i, b ? b + i : 0, value, result + i, size - i);
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doComplexMulSSE2(const Complex *a, const Complex *b, Complex *result, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		const float *fa = (const float *)a;
+		const float *fb = (const float *)b;
+		float *fr = (float *)result;
+		__m128 sign = _mm_castsi128_ps(_mm_set_epi32(0, 0x80000000, 0, 0x80000000));
+		PixelIndex i = 0;
+		for (; i + 2 <= size; i += 2)
+		{
+			// [a b] * [c c] +- [b a] * [d d]
+			__m128 x = _mm_loadu_ps(fa + 2 * i);
+			__m128 y = _mm_loadu_ps(fb + 2 * i);
+			__m128 y_re = _mm_shuffle_ps(y, y, _MM_SHUFFLE(2, 2, 0, 0));
+			__m128 y_im = _mm_shuffle_ps(y, y, _MM_SHUFFLE(3, 3, 1, 1));
+			__m128 x_swap = _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 0, 1));
+			_mm_storeu_ps(fr + 2 * i, _mm_add_ps(_mm_mul_ps(x, y_re), _mm_xor_ps(_mm_mul_ps(x_swap, y_im), sign)));
+		}
+		doComplexMulScalar(a + i, b + i, result + i, size - i);
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doConvertSSE2(bfloat16 *destination, const float *source, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		__m128i one = _mm_set1_epi32(1);
+		__m128i rounding = _mm_set1_epi32(0x7fff);
+		__m128i magnitude = _mm_set1_epi32(0x7fffffff);
+		__m128i infinity = _mm_set1_epi32(0x7f800000);
+		__m128i quiet = _mm_set1_epi32(0x400000);
+		PixelIndex i = 0;
+		for (; i + 8 <= size; i += 8)
+		{
+			__m128i result[2];
+			for (int k = 0; k < 2; ++k)
+			{
+				// (f + 0x7fff + lowest bit of the result) >> 16, NaN: (f >> 16) | 0x40
+				__m128i f = _mm_castps_si128(_mm_loadu_ps(source + i + 4 * k));
+				__m128i rounded = _mm_add_epi32(_mm_add_epi32(f, rounding), _mm_and_si128(_mm_srli_epi32(f, 16), one));
+				__m128i nan = _mm_cmpgt_epi32(_mm_and_si128(f, magnitude), infinity);
+				__m128i bits = _mm_or_si128(_mm_and_si128(nan, _mm_or_si128(f, quiet)), _mm_andnot_si128(nan, rounded));
+				// sign extension of the upper 16 bits, so that the signed packing is exact
+				result[k] = _mm_srai_epi32(bits, 16);
+			}
+			_mm_storeu_si128((__m128i *)(destination + i), _mm_packs_epi32(result[0], result[1]));
+		}
+		for (; i < size; ++i)
+			destination[i].bits = bfloat16::getBits(source[i]);
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doConvertSSE2(float *destination, const bfloat16 *source, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		__m128i zero = _mm_setzero_si128();
+		PixelIndex i = 0;
+		for (; i + 8 <= size; i += 8)
+		{
+			__m128i bits = _mm_loadu_si128((const __m128i *)(source + i));
+			_mm_storeu_ps(destination + i, _mm_castsi128_ps(_mm_unpacklo_epi16(zero, bits)));
+			_mm_storeu_ps(destination + i + 4, _mm_castsi128_ps(_mm_unpackhi_epi16(zero, bits)));
+		}
+		for (; i < size; ++i)
+			destination[i] = bfloat16::getFloat(source[i].bits);
+	}
+
+	/* ************************************************************************** */
+	inline __m128i ImageArithmetic::getRoundedSSE2(__m128 value, __m128 minimum, __m128 maximum)
+	/* ************************************************************************** */
+	{
+		// as PixelTraits::getPixel(): clamp (NaN -> minimum), add 0.5 and round downwards
+		__m128 x = _mm_add_ps(_mm_min_ps(_mm_max_ps(value, minimum), maximum), _mm_set1_ps(0.5f));
+		__m128i truncated = _mm_cvttps_epi32(x);
+		return _mm_add_epi32(truncated, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(truncated), x)));
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doNarrowSSE2(uchar *destination, const float *source, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		__m128 minimum = _mm_setzero_ps();
+		__m128 maximum = _mm_set1_ps(255.0f);
+		for (PixelIndex i = 0; i + 16 <= size; i += 16)
+		{
+			__m128i v0 = getRoundedSSE2(_mm_loadu_ps(source + i), minimum, maximum);
+			__m128i v1 = getRoundedSSE2(_mm_loadu_ps(source + i + 4), minimum, maximum);
+			__m128i v2 = getRoundedSSE2(_mm_loadu_ps(source + i + 8), minimum, maximum);
+			__m128i v3 = getRoundedSSE2(_mm_loadu_ps(source + i + 12), minimum, maximum);
+			// the values are in [0,255], the packing is exact
+			_mm_storeu_si128((__m128i *)(destination + i), _mm_packus_epi16(_mm_packs_epi32(v0, v1), _mm_packs_epi32(v2, v3)));
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doNarrowSSE2(uint16 *destination, const float *source, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		__m128 minimum = _mm_setzero_ps();
+		__m128 maximum = _mm_set1_ps(65535.0f);
+		__m128i offset32 = _mm_set1_epi32(32768);
+		__m128i offset16 = _mm_set1_epi16((short)0x8000);
+		for (PixelIndex i = 0; i + 8 <= size; i += 8)
+		{
+			// SSE2 has no unsigned 32 -> 16 bit packing: shift to the signed range and back
+			__m128i v0 = _mm_sub_epi32(getRoundedSSE2(_mm_loadu_ps(source + i), minimum, maximum), offset32);
+			__m128i v1 = _mm_sub_epi32(getRoundedSSE2(_mm_loadu_ps(source + i + 4), minimum, maximum), offset32);
+			_mm_storeu_si128((__m128i *)(destination + i), _mm_xor_si128(_mm_packs_epi32(v0, v1), offset16));
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doNarrowSSE2(int16 *destination, const float *source, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		__m128 minimum = _mm_set1_ps(-32768.0f);
+		__m128 maximum = _mm_set1_ps(32767.0f);
+		for (PixelIndex i = 0; i + 8 <= size; i += 8)
+		{
+			__m128i v0 = getRoundedSSE2(_mm_loadu_ps(source + i), minimum, maximum);
+			__m128i v1 = getRoundedSSE2(_mm_loadu_ps(source + i + 4), minimum, maximum);
+			_mm_storeu_si128((__m128i *)(destination + i), _mm_packs_epi32(v0, v1));
+		}
+	}
+
+	/* ************************************************************************** */
+	inline __m128i ImageArithmetic::getInteger16SSE2(Operation operation, __m128i x, __m128i y, uint16)
+	/* ************************************************************************** */
+	{
+		switch (operation)
+		{
+		case ADD:
+			return _mm_adds_epu16(x, y);
+		case SUB:
+			return _mm_subs_epu16(x, y);
+		default:
+		{
+			// 32 bit products, set to 65535 if the upper half is not zero
+			__m128i zero = _mm_setzero_si128();
+			__m128i high = _mm_mulhi_epu16(x, y);
+			return _mm_or_si128(_mm_mullo_epi16(x, y), _mm_cmpeq_epi16(_mm_cmpeq_epi16(high, zero), zero));
+		}
+		}
+	}
+
+	/* ************************************************************************** */
+	inline __m128i ImageArithmetic::getInteger16SSE2(Operation operation, __m128i x, __m128i y, int16)
+	/* ************************************************************************** */
+	{
+		switch (operation)
+		{
+		case ADD:
+			return _mm_adds_epi16(x, y);
+		case SUB:
+			return _mm_subs_epi16(x, y);
+		default:
+		{
+			// 32 bit products, packed to 16 bit with saturation
+			__m128i low = _mm_mullo_epi16(x, y);
+			__m128i high = _mm_mulhi_epi16(x, y);
+			return _mm_packs_epi32(_mm_unpacklo_epi16(low, high), _mm_unpackhi_epi16(low, high));
+		}
+		}
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void ImageArithmetic::doInteger16SSE2(Operation operation, const Typ *a, const Typ *b, int value, Typ *result, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		__m128i v = _mm_set1_epi16((short)value);
+		PixelIndex i = 0;
+		for (; i + 8 <= size; i += 8)
+		{
+			__m128i x = _mm_loadu_si128((const __m128i *)(a + i));
+			__m128i y = b ? _mm_loadu_si128((const __m128i *)(b + i)) : v;
+			_mm_storeu_si128((__m128i *)(result + i), getInteger16SSE2(operation, x, y, Typ()));
+		}
+		doInteger16Scalar(operation, a + i, b ? b + i : 0, value, result + i, size - i);
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doWidenSSE2(float *destination, const uint16 *source, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		__m128i zero = _mm_setzero_si128();
+		for (PixelIndex i = 0; i + 8 <= size; i += 8)
+		{
+			__m128i x = _mm_loadu_si128((const __m128i *)(source + i));
+			_mm_storeu_ps(destination + i, _mm_cvtepi32_ps(_mm_unpacklo_epi16(x, zero)));
+			_mm_storeu_ps(destination + i + 4, _mm_cvtepi32_ps(_mm_unpackhi_epi16(x, zero)));
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doWidenSSE2(float *destination, const int16 *source, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		for (PixelIndex i = 0; i + 8 <= size; i += 8)
+		{
+			// sign extension: value in the upper half, arithmetic shift
+			__m128i x = _mm_loadu_si128((const __m128i *)(source + i));
+			_mm_storeu_ps(destination + i, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16)));
+			_mm_storeu_ps(destination + i + 4, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16)));
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doMaxMinSSE2(const int16 *data, PixelIndex size, int16 bias, int16 &maximum, int16 &minimum)
+	/* ************************************************************************** */
+	{
+		// data[i] ^ bias is compared (bias 0x8000: uint16 as signed values), size >= 8
+		__m128i b = _mm_set1_epi16(bias);
+		__m128i max8 = _mm_xor_si128(_mm_loadu_si128((const __m128i *)data), b);
+		__m128i min8 = max8;
+		PixelIndex i = 8;
+		for (; i + 8 <= size; i += 8)
+		{
+			__m128i x = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(data + i)), b);
+			max8 = _mm_max_epi16(max8, x);
+			min8 = _mm_min_epi16(min8, x);
+		}
+
+		// the remaining pixels overlap with the last full vector
+		if (i < size)
+		{
+			__m128i x = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(data + size - 8)), b);
+			max8 = _mm_max_epi16(max8, x);
+			min8 = _mm_min_epi16(min8, x);
+		}
+
+		// reduce the 8 lanes
+		max8 = _mm_max_epi16(max8, _mm_shuffle_epi32(max8, _MM_SHUFFLE(1, 0, 3, 2)));
+		max8 = _mm_max_epi16(max8, _mm_shuffle_epi32(max8, _MM_SHUFFLE(2, 3, 0, 1)));
+		max8 = _mm_max_epi16(max8, _mm_srli_epi32(max8, 16));
+		min8 = _mm_min_epi16(min8, _mm_shuffle_epi32(min8, _MM_SHUFFLE(1, 0, 3, 2)));
+		min8 = _mm_min_epi16(min8, _mm_shuffle_epi32(min8, _MM_SHUFFLE(2, 3, 0, 1)));
+		min8 = _mm_min_epi16(min8, _mm_srli_epi32(min8, 16));
+		maximum = (int16)_mm_cvtsi128_si32(max8);
+		minimum = (int16)_mm_cvtsi128_si32(min8);
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doClampSSE2(int16 *data, int16 minimum, int16 maximum, int16 bias, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		// data[i] ^ bias is clamped to the (biased) limits (bias 0x8000: uint16 as signed values)
+		__m128i b = _mm_set1_epi16(bias);
+		__m128i lower = _mm_set1_epi16(minimum);
+		__m128i upper = _mm_set1_epi16(maximum);
+		for (PixelIndex i = 0; i + 8 <= size; i += 8)
+		{
+			__m128i x = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(data + i)), b);
+			x = _mm_min_epi16(_mm_max_epi16(x, lower), upper);
+			_mm_storeu_si128((__m128i *)(data + i), _mm_xor_si128(x, b));
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doDeinterleaveSSE2(const unsigned int *source, uchar *red, uchar *green, uchar *blue, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		__m128i mask = _mm_set1_epi32(0xff);
+		for (PixelIndex i = 0; i + 16 <= size; i += 16)
+		{
+			__m128i channel[3][4];
+			for (int k = 0; k < 4; ++k)
+			{
+				__m128i pixels = _mm_loadu_si128((const __m128i *)(source + i + 4 * k));
+				channel[0][k] = _mm_and_si128(_mm_srli_epi32(pixels, 16), mask);
+				channel[1][k] = _mm_and_si128(_mm_srli_epi32(pixels, 8), mask);
+				channel[2][k] = _mm_and_si128(pixels, mask);
+			}
+			uchar *plane[3] = {red, green, blue};
+			for (int c = 0; c < 3; ++c)
+			{
+				// 32 -> 16 -> 8 bit (the values are < 256, the packing is exact)
+				__m128i low = _mm_packs_epi32(channel[c][0], channel[c][1]);
+				__m128i high = _mm_packs_epi32(channel[c][2], channel[c][3]);
+				_mm_storeu_si128((__m128i *)(plane[c] + i), _mm_packus_epi16(low, high));
+			}
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void ImageArithmetic::doInterleaveSSE2(const uchar *red, const uchar *green, const uchar *blue, unsigned int *destination, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		__m128i zero = _mm_setzero_si128();
+		__m128i alpha = _mm_set1_epi16((short)0xff00);
+		for (PixelIndex i = 0; i + 16 <= size; i += 16)
+		{
+			__m128i r = _mm_loadu_si128((const __m128i *)(red + i));
+			__m128i g = _mm_loadu_si128((const __m128i *)(green + i));
+			__m128i b = _mm_loadu_si128((const __m128i *)(blue + i));
+
+			// byte order in memory: B G R A
+			__m128i bg[2] = {_mm_unpacklo_epi8(b, g), _mm_unpackhi_epi8(b, g)};
+			__m128i ra[2] = {_mm_or_si128(_mm_unpacklo_epi8(r, zero), alpha), _mm_or_si128(_mm_unpackhi_epi8(r, zero), alpha)};
+			for (int k = 0; k < 2; ++k)
+			{
+				_mm_storeu_si128((__m128i *)(destination + i + 8 * k), _mm_unpacklo_epi16(bg[k], ra[k]));
+				_mm_storeu_si128((__m128i *)(destination + i + 8 * k + 4), _mm_unpackhi_epi16(bg[k], ra[k]));
+			}
+		}
+	}
+
+	/* ************************************************************************** */
+	__attribute__((target("avx2"))) inline void ImageArithmetic::doDeinterleaveAVX2(const Rgb *source, uchar *red, uchar *green, uchar *blue, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		// 128 bit byte shuffles, compiled (VEX encoded) and dispatched for AVX2 like the other kernels.
+		// byte j of plane c is byte 3*j+c of the 48 bytes of 16 pixels, shuffled out of the
+		// three 16 byte blocks (-1: zero)
+		const __m128i shuffle[3][3] = {
+			{_mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1),
+			 _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1),
+			 _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13)},
+			{_mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1),
+			 _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1),
+			 _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14)},
+			{_mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1),
+			 _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1),
+			 _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15)}};
+
+		const uchar *bytes = (const uchar *)source;
+		uchar *plane[3] = {red, green, blue};
+		for (PixelIndex i = 0; i + 16 <= size; i += 16)
+		{
+			__m128i block[3];
+			for (int k = 0; k < 3; ++k)
+				block[k] = _mm_loadu_si128((const __m128i *)(bytes + 3 * i + 16 * k));
+
+			for (int c = 0; c < 3; ++c)
+			{
+				__m128i result = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(block[0], shuffle[c][0]),
+															_mm_shuffle_epi8(block[1], shuffle[c][1])),
+											  _mm_shuffle_epi8(block[2], shuffle[c][2]));
+				_mm_storeu_si128((__m128i *)(plane[c] + i), result);
+			}
+		}
+	}
+
+	/* ************************************************************************** */
+	__attribute__((target("avx2"))) inline void ImageArithmetic::doInterleaveAVX2(const uchar *red, const uchar *green, const uchar *blue, Rgb *destination, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		// byte k of block b is byte (16*b+k)/3 of plane (16*b+k)%3 (-1: zero)
+		const __m128i shuffle[3][3] = {
+			{_mm_setr_epi8(0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1, 5),
+			 _mm_setr_epi8(-1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1),
+			 _mm_setr_epi8(-1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1)},
+			{_mm_setr_epi8(-1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10, -1),
+			 _mm_setr_epi8(5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10),
+			 _mm_setr_epi8(-1, 5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1)},
+			{_mm_setr_epi8(-1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1, -1),
+			 _mm_setr_epi8(-1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1),
+			 _mm_setr_epi8(10, -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15)}};
+
+		uchar *bytes = (uchar *)destination;
+		for (PixelIndex i = 0; i + 16 <= size; i += 16)
+		{
+			__m128i r = _mm_loadu_si128((const __m128i *)(red + i));
+			__m128i g = _mm_loadu_si128((const __m128i *)(green + i));
+			__m128i b = _mm_loadu_si128((const __m128i *)(blue + i));
+
+			for (int k = 0; k < 3; ++k)
+			{
+				__m128i result = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, shuffle[k][0]),
+															_mm_shuffle_epi8(g, shuffle[k][1])),
+											  _mm_shuffle_epi8(b, shuffle[k][2]));
+				_mm_storeu_si128((__m128i *)(bytes + 3 * i + 16 * k), result);
+			}
+		}
+	}
+
+	/* ************************************************************************** */
+	__attribute__((target("avx2,f16c"))) inline void ImageArithmetic::doConvertF16C(half *destination, const float *source, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		PixelIndex i = 0;
+		for (; i + 8 <= size; i += 8)
+			_mm_storeu_si128((__m128i *)(destination + i), _mm256_cvtps_ph(_mm256_loadu_ps(source + i), _MM_FROUND_TO_NEAREST_INT));
+		for (; i < size; ++i)
+			destination[i].bits = half::getBits(source[i]);
+	}
+
+	/* ************************************************************************** */
+	__attribute__((target("avx2,f16c"))) inline void ImageArithmetic::doConvertF16C(float *destination, const half *source, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		PixelIndex i = 0;
+		for (; i + 8 <= size; i += 8)
+			_mm256_storeu_ps(destination + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(source + i))));
+		for (; i < size; ++i)
+			destination[i] = half::getFloat(source[i].bits);
+	}
+
+	/* ************************************************************************** */
+	__attribute__((target("avx2"))) inline void ImageArithmetic::doConvertAVX2(bfloat16 *destination, const float *source, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		__m256i one = _mm256_set1_epi32(1);
+		__m256i rounding = _mm256_set1_epi32(0x7fff);
+		__m256i magnitude = _mm256_set1_epi32(0x7fffffff);
+		__m256i infinity = _mm256_set1_epi32(0x7f800000);
+		__m256i quiet = _mm256_set1_epi32(0x400000);
+		PixelIndex i = 0;
+		for (; i + 16 <= size; i += 16)
+		{
+			__m256i result[2];
+			for (int k = 0; k < 2; ++k)
+			{
+				// see doConvertSSE2()
+				__m256i f = _mm256_castps_si256(_mm256_loadu_ps(source + i + 8 * k));
+				__m256i rounded = _mm256_add_epi32(_mm256_add_epi32(f, rounding), _mm256_and_si256(_mm256_srli_epi32(f, 16), one));
+				__m256i nan = _mm256_cmpgt_epi32(_mm256_and_si256(f, magnitude), infinity);
+				result[k] = _mm256_srai_epi32(_mm256_blendv_epi8(rounded, _mm256_or_si256(f, quiet), nan), 16);
+			}
+			// the packing works per 128 bit lane: restore the order of the 64 bit blocks
+			__m256i packed = _mm256_packs_epi32(result[0], result[1]);
+			_mm256_storeu_si256((__m256i *)(destination + i), _mm256_permute4x64_epi64(packed, 0xD8));
+		}
+		for (; i < size; ++i)
+			destination[i].bits = bfloat16::getBits(source[i]);
+	}
+
+	/* ************************************************************************** */
+	__attribute__((target("avx2"))) inline void ImageArithmetic::doConvertAVX2(float *destination, const bfloat16 *source, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		PixelIndex i = 0;
+		for (; i + 8 <= size; i += 8)
+		{
+			__m256i bits = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(source + i)));
+			_mm256_storeu_ps(destination + i, _mm256_castsi256_ps(_mm256_slli_epi32(bits, 16)));
+		}
+		for (; i < size; ++i)
+			destination[i] = bfloat16::getFloat(source[i].bits);
+	}
+
+	/* ************************************************************************** */
+	__attribute__((target("avx2"))) inline void ImageArithmetic::doFloatAVX2(Operation operation, const float *a, const float *b, float value, float *result, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		__m256 v = _mm256_set1_ps(value);
+		PixelIndex i = 0;
+		for (; i + 8 <= size; i += 8)
+		{
+			__m256 x = _mm256_loadu_ps(a + i);
+			__m256 y = b ? _mm256_loadu_ps(b + i) : v;
+			switch (operation)
+			{
+			case ADD:
+				x = _mm256_add_ps(x, y);
+				break;
+			case SUB:
+				x = _mm256_sub_ps(x, y);
+				break;
+			case MUL:
+				x = _mm256_mul_ps(x, y);
+				break;
+			case DIV:
+				x = _mm256_div_ps(x, y);
+				break;
+			}
+			_mm256_storeu_ps(result + i, x);
+		}
+		doFloatScalar(operation, a + i, b ? b + i : 0, value, result + i, size - i);
+	}
+
+	/* ************************************************************************** */
+	__attribute__((target("avx2"))) inline __m256i ImageArithmetic::getInteger16AVX2(Operation operation, __m256i x, __m256i y, uint16)
+	/* ************************************************************************** */
+	{
+		switch (operation)
+		{
+		case ADD:
+			return _mm256_adds_epu16(x, y);
+		case SUB:
+			return _mm256_subs_epu16(x, y);
+		default:
+		{
+			// 32 bit products, set to 65535 if the upper half is not zero
+			__m256i zero = _mm256_setzero_si256();
+			__m256i high = _mm256_mulhi_epu16(x, y);
+			return _mm256_or_si256(_mm256_mullo_epi16(x, y), _mm256_cmpeq_epi16(_mm256_cmpeq_epi16(high, zero), zero));
+		}
+		}
+	}
+
+	/* ************************************************************************** */
+	__attribute__((target("avx2"))) inline __m256i ImageArithmetic::getInteger16AVX2(Operation operation, __m256i x, __m256i y, int16)
+	/* ************************************************************************** */
+	{
+		switch (operation)
+		{
+		case ADD:
+			return _mm256_adds_epi16(x, y);
+		case SUB:
+			return _mm256_subs_epi16(x, y);
+		default:
+		{
+			// 32 bit products, packed to 16 bit with saturation (unpack and pack work per 128 bit lane)
+			__m256i low = _mm256_mullo_epi16(x, y);
+			__m256i high = _mm256_mulhi_epi16(x, y);
+			return _mm256_packs_epi32(_mm256_unpacklo_epi16(low, high), _mm256_unpackhi_epi16(low, high));
+		}
+		}
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	__attribute__((target("avx2"))) inline void ImageArithmetic::doInteger16AVX2(Operation operation, const Typ *a, const Typ *b, int value, Typ *result, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		__m256i v = _mm256_set1_epi16((short)value);
+		PixelIndex i = 0;
+		for (; i + 16 <= size; i += 16)
+		{
+			__m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+			__m256i y = b ? _mm256_loadu_si256((const __m256i *)(b + i)) : v;
+			_mm256_storeu_si256((__m256i *)(result + i), getInteger16AVX2(operation, x, y, Typ()));
+		}
+		doInteger16Scalar(operation, a + i, b ? b + i : 0, value, result + i, size - i);
+	}
+
+	/* ************************************************************************** */
+	__attribute__((target("avx2"))) inline void ImageArithmetic::doUcharAVX2(Operation operation, const uchar *a, const uchar *b, int value, uchar *result, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		__m256i v = _mm256_set1_epi8((char)value);
+		__m256i zero = _mm256_setzero_si256();
+		__m256i max16 = _mm256_set1_epi16(255);
+		PixelIndex i = 0;
+		for (; i + 32 <= size; i += 32)
+		{
+			__m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+			__m256i y = b ? _mm256_loadu_si256((const __m256i *)(b + i)) : v;
+			switch (operation)
+			{
+			case ADD:
+				x = _mm256_adds_epu8(x, y);
+				break;
+			case SUB:
+				x = _mm256_subs_epu8(x, y);
+				break;
+			default:
+			{
+				// unpack and pack work within 128 bit lanes, so the order of the pixels is kept
+				__m256i low = _mm256_mullo_epi16(_mm256_unpacklo_epi8(x, zero), _mm256_unpacklo_epi8(y, zero));
+				__m256i high = _mm256_mullo_epi16(_mm256_unpackhi_epi8(x, zero), _mm256_unpackhi_epi8(y, zero));
+				x = _mm256_packus_epi16(_mm256_min_epu16(low, max16), _mm256_min_epu16(high, max16));
+				break;
+			}
+			}
+			_mm256_storeu_si256((__m256i *)(result + i), x);
+		}
+		doUcharScalar(operation, a + i, b ? b + i : 0, value, result + i, size - i);
+	}
+
+	/* ************************************************************************** */
+	__attribute__((target("avx2"))) inline void ImageArithmetic::doComplexMulAVX2(const Complex *a, const Complex *b, Complex *result, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		const float *fa = (const float *)a;
+		const float *fb = (const float *)b;
+		float *fr = (float *)result;
+		PixelIndex i = 0;
+		for (; i + 4 <= size; i += 4)
+		{
+			__m256 x = _mm256_loadu_ps(fa + 2 * i);
+			__m256 y = _mm256_loadu_ps(fb + 2 * i);
+			__m256 x_swap = _mm256_permute_ps(x, 0xB1);
+			_mm256_storeu_ps(fr + 2 * i, _mm256_addsub_ps(_mm256_mul_ps(x, _mm256_moveldup_ps(y)), _mm256_mul_ps(x_swap, _mm256_movehdup_ps(y))));
+		}
+		doComplexMulScalar(a + i, b + i, result + i, size - i);
+	}
+
+	/* ************************************************************************** */
+	__attribute__((target("avx512f,avx512bw"))) inline void ImageArithmetic::doFloatAVX512(Operation operation, const float *a, const float *b, float value, float *result, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		__m512 v = _mm512_set1_ps(value);
+		PixelIndex i = 0;
+		for (; i + 16 <= size; i += 16)
+		{
+			__m512 x = _mm512_loadu_ps(a + i);
+			__m512 y = b ? _mm512_loadu_ps(b + i) : v;
+			switch (operation)
+			{
+			case ADD:
+				x = _mm512_add_ps(x, y);
+				break;
+			case SUB:
+				x = _mm512_sub_ps(x, y);
+				break;
+			case MUL:
+				x = _mm512_mul_ps(x, y);
+				break;
+			case DIV:
+				x = _mm512_div_ps(x, y);
+				break;
+			}
+			_mm512_storeu_ps(result + i, x);
+		}
+		doFloatScalar(operation, a + i, b ? b + i : 0, value, result + i, size - i);
+	}
+
+	/* ************************************************************************** */
+	__attribute__((target("avx512f,avx512bw"))) inline void ImageArithmetic::doUcharAVX512(Operation operation, const uchar *a, const uchar *b, int value, uchar *result, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		__m512i v = _mm512_set1_epi8((char)value);
+		__m512i zero = _mm512_setzero_si512();
+		__m512i max16 = _mm512_set1_epi16(255);
+		PixelIndex i = 0;
+		for (; i + 64 <= size; i += 64)
+		{
+			__m512i x = _mm512_loadu_si512((const void *)(a + i));
+			__m512i y = b ? _mm512_loadu_si512((const void *)(b + i)) : v;
+			switch (operation)
+			{
+			case ADD:
+				x = _mm512_adds_epu8(x, y);
+				break;
+			case SUB:
+				x = _mm512_subs_epu8(x, y);
+				break;
+			default:
+			{
+				__m512i low = _mm512_mullo_epi16(_mm512_unpacklo_epi8(x, zero), _mm512_unpacklo_epi8(y, zero));
+				__m512i high = _mm512_mullo_epi16(_mm512_unpackhi_epi8(x, zero), _mm512_unpackhi_epi8(y, zero));
+				x = _mm512_packus_epi16(_mm512_min_epu16(low, max16), _mm512_min_epu16(high, max16));
+				break;
+			}
+			}
+			_mm512_storeu_si512((void *)(result + i), x);
+		}
+		doUcharScalar(operation, a + i, b ? b + i : 0, value, result + i, size - i);
+	}
+
+	/* ************************************************************************** */
+	__attribute__((target("avx512f,avx512bw"))) inline void ImageArithmetic::doComplexMulAVX512(const Complex *a, const Complex *b, Complex *result, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		const float *fa = (const float *)a;
+		const float *fb = (const float *)b;
+		float *fr = (float *)result;
+		PixelIndex i = 0;
+		for (; i + 8 <= size; i += 8)
+		{
+			__m512 x = _mm512_loadu_ps(fa + 2 * i);
+			__m512 y = _mm512_loadu_ps(fb + 2 * i);
+			__m512 p = _mm512_mul_ps(x, _mm512_shuffle_ps(y, y, 0xA0));
+			__m512 q = _mm512_mul_ps(_mm512_shuffle_ps(x, x, 0xB1), _mm512_shuffle_ps(y, y, 0xF5));
+			// subtract in the real parts (even lanes), add in the imaginary parts
+			_mm512_storeu_ps(fr + 2 * i, _mm512_mask_sub_ps(_mm512_add_ps(p, q), 0x5555, p, q));
+		}
+		doComplexMulScalar(a + i, b + i, result + i, size - i);
+	}
+
+#endif
+
+} /* namespace GET */
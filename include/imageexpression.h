@@ -0,0 +1,592 @@
+#pragma once
+
+#include "image.h"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace GET
+{
+
+	/** Registers used for the evaluation of image expressions of type float.
+	 *
+	 * Without SSE2 a "register" is a single float, so that all expressions use the same code.
+	 */
+	struct ImageExpressionPacket
+	{
+#if defined(__AVX__)
+		typedef __m256 Type;
+		enum
+		{
+			WIDTH = 8
+		};
+		static inline Type set(float value) { return _mm256_set1_ps(value); };
+		static inline Type load(const float *data) { return _mm256_loadu_ps(data); };
+		static inline Type load(const uchar *data)
+		{
+			__m128i zero = _mm_setzero_si128();
+			__m128i bytes = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)data), zero);
+			__m256i values = _mm256_insertf128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi16(bytes, zero)), _mm_unpackhi_epi16(bytes, zero), 1);
+			return _mm256_cvtepi32_ps(values);
+		};
+		static inline void store(float *data, Type value) { _mm256_storeu_ps(data, value); };
+		static inline Type add(Type a, Type b) { return _mm256_add_ps(a, b); };
+		static inline Type sub(Type a, Type b) { return _mm256_sub_ps(a, b); };
+		static inline Type mul(Type a, Type b) { return _mm256_mul_ps(a, b); };
+		static inline Type div(Type a, Type b) { return _mm256_div_ps(a, b); };
+		static inline Type max(Type a, Type b) { return _mm256_max_ps(a, b); };
+		static inline Type min(Type a, Type b) { return _mm256_min_ps(a, b); };
+#elif defined(__SSE2__)
+		typedef __m128 Type;
+		enum
+		{
+			WIDTH = 4
+		};
+		static inline Type set(float value) { return _mm_set1_ps(value); };
+		static inline Type load(const float *data) { return _mm_loadu_ps(data); };
+		static inline Type load(const uchar *data)
+		{
+			__m128i zero = _mm_setzero_si128();
+			int bytes = data[0] | (data[1] << 8) | (data[2] << 16) | (data[3] << 24);
+			__m128i values = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero);
+			return _mm_cvtepi32_ps(values);
+		};
+		static inline void store(float *data, Type value) { _mm_storeu_ps(data, value); };
+		static inline Type add(Type a, Type b) { return _mm_add_ps(a, b); };
+		static inline Type sub(Type a, Type b) { return _mm_sub_ps(a, b); };
+		static inline Type mul(Type a, Type b) { return _mm_mul_ps(a, b); };
+		static inline Type div(Type a, Type b) { return _mm_div_ps(a, b); };
+		static inline Type max(Type a, Type b) { return _mm_max_ps(a, b); };
+		static inline Type min(Type a, Type b) { return _mm_min_ps(a, b); };
+#else
+		typedef float Type;
+		enum
+		{
+			WIDTH = 1
+		};
+		static inline Type set(float value) { return value; };
+		static inline Type load(const float *data) { return *data; };
+		static inline Type load(const uchar *data) { return *data; };
+		static inline void store(float *data, Type value) { *data = value; };
+		static inline Type add(Type a, Type b) { return a + b; };
+		static inline Type sub(Type a, Type b) { return a - b; };
+		static inline Type mul(Type a, Type b) { return a * b; };
+		static inline Type div(Type a, Type b) { return a / b; };
+		static inline Type max(Type a, Type b) { return (a > b) ? a : b; };
+		static inline Type min(Type a, Type b) { return (a < b) ? a : b; };
+#endif
+	};
+
+	/** Tells whether values of a base data type are evaluated in registers (only float). */
+	template <typename Typ>
+	struct ImageExpressionPacketTraits
+	{
+		enum
+		{
+			PACKET = 0
+		};
+	};
+
+	template <>
+	struct ImageExpressionPacketTraits<float>
+	{
+		enum
+		{
+			PACKET = 1
+		};
+	};
+
+	/** Base data type of the operands of a binary operation (only defined if both are equal). */
+	template <typename Left, typename Right>
+	struct ImageExpressionSameType;
+
+	template <typename Typ>
+	struct ImageExpressionSameType<Typ, Typ>
+	{
+		typedef Typ Type;
+	};
+
+	/** Prevents the deduction of a template argument from a scalar operand. */
+	template <typename Typ>
+	struct ImageExpressionIdentity
+	{
+		typedef Typ Type;
+	};
+
+	/* *** Operations ********************************************************* */
+
+	/** Addition (calculated in PixelTraits::Accumulator and stored with getPixel(), like Image::add()) */
+	struct ImageExpressionAdd
+	{
+		template <typename Typ>
+		static inline Typ getValue(const Typ &a, const Typ &b)
+		{
+			typename PixelTraits<Typ>::Accumulator value = PixelTraits<Typ>::getAccumulator(a);
+			value += PixelTraits<Typ>::getAccumulator(b);
+			return PixelTraits<Typ>::getPixel(value);
+		};
+		static inline ImageExpressionPacket::Type getPacket(ImageExpressionPacket::Type a, ImageExpressionPacket::Type b) { return ImageExpressionPacket::add(a, b); };
+	};
+
+	/** Subtraction (calculated in PixelTraits::Accumulator and stored with getPixel(), like Image::sub()) */
+	struct ImageExpressionSub
+	{
+		template <typename Typ>
+		static inline Typ getValue(const Typ &a, const Typ &b)
+		{
+			typename PixelTraits<Typ>::Accumulator value = PixelTraits<Typ>::getAccumulator(a);
+			value -= PixelTraits<Typ>::getAccumulator(b);
+			return PixelTraits<Typ>::getPixel(value);
+		};
+		static inline ImageExpressionPacket::Type getPacket(ImageExpressionPacket::Type a, ImageExpressionPacket::Type b) { return ImageExpressionPacket::sub(a, b); };
+	};
+
+	/** Multiplication (calculated in PixelTraits::Accumulator and stored with getPixel(), like Image::mul()) */
+	struct ImageExpressionMul
+	{
+		template <typename Typ>
+		static inline Typ getValue(const Typ &a, const Typ &b)
+		{
+			typename PixelTraits<Typ>::Accumulator value = PixelTraits<Typ>::getAccumulator(a);
+			value *= PixelTraits<Typ>::getAccumulator(b);
+			return PixelTraits<Typ>::getPixel(value);
+		};
+		static inline ImageExpressionPacket::Type getPacket(ImageExpressionPacket::Type a, ImageExpressionPacket::Type b) { return ImageExpressionPacket::mul(a, b); };
+	};
+
+	/** Division (calculated in PixelTraits::Accumulator and stored with getPixel(), like Image::div()) */
+	struct ImageExpressionDiv
+	{
+		template <typename Typ>
+		static inline Typ getValue(const Typ &a, const Typ &b)
+		{
+			typename PixelTraits<Typ>::Accumulator value = PixelTraits<Typ>::getAccumulator(a);
+			value /= PixelTraits<Typ>::getAccumulator(b);
+			return PixelTraits<Typ>::getPixel(value);
+		};
+		static inline ImageExpressionPacket::Type getPacket(ImageExpressionPacket::Type a, ImageExpressionPacket::Type b) { return ImageExpressionPacket::div(a, b); };
+	};
+
+	/* *** Nodes of the expression tree ************************************** */
+
+	/** Image operand (refers to the image, which must exist until the expression is evaluated). */
+	template <typename Typ>
+	class ImageExpressionImage
+	{
+	private:
+		const Typ *m_data;
+		int m_width;
+		int m_height;
+		int m_stride;
+		bool m_packed;
+
+	public:
+		typedef Typ ValueType;
+		enum
+		{
+			PACKET = ImageExpressionPacketTraits<Typ>::PACKET
+		};
+
+		inline ImageExpressionImage(const Image<Typ> &image) : m_data(image.getData()), m_width(image.getWidth()), m_height(image.getHeight()),
+															   m_stride(image.getStride()), m_packed(image.isPacked()){};
+
+		inline int getWidth() const { return m_width; };
+		inline int getHeight() const { return m_height; };
+		inline bool isValid() const { return true; };
+		inline bool isPacked() const { return m_packed; };
+		inline const Typ *getRow(int y) const { return m_data + (PixelIndex)y * m_stride; };
+		inline ValueType getValue(int y, PixelIndex x) const { return getRow(y)[x]; };
+		inline ImageExpressionPacket::Type getPacket(int y, PixelIndex x) const { return ImageExpressionPacket::load(getRow(y) + x); };
+	};
+
+	/** Scalar operand (fits images of any size, width and height are -1). */
+	template <typename Typ>
+	class ImageExpressionScalar
+	{
+	private:
+		Typ m_value;
+
+	public:
+		typedef Typ ValueType;
+		enum
+		{
+			PACKET = ImageExpressionPacketTraits<Typ>::PACKET
+		};
+
+		inline ImageExpressionScalar(const Typ &value) : m_value(value){};
+
+		inline int getWidth() const { return -1; };
+		inline int getHeight() const { return -1; };
+		inline bool isValid() const { return true; };
+		inline bool isPacked() const { return true; };
+		inline ValueType getValue(int, PixelIndex) const { return m_value; };
+		inline ImageExpressionPacket::Type getPacket(int, PixelIndex) const { return ImageExpressionPacket::set(m_value); };
+	};
+
+	/** Tells whether a conversion is evaluated in registers (float expressions and uchar images to float). */
+	template <typename Target, typename Argument>
+	struct ImageExpressionConvertTraits
+	{
+		enum
+		{
+			PACKET = ImageExpressionPacketTraits<Target>::PACKET &&
+					 ImageExpressionPacketTraits<typename Argument::ValueType>::PACKET &&
+					 Argument::PACKET
+		};
+	};
+
+	template <>
+	struct ImageExpressionConvertTraits<float, ImageExpressionImage<uchar> >
+	{
+		enum
+		{
+			PACKET = 1
+		};
+	};
+
+	/** Binary operation (both operands must have the same base data type and size). */
+	template <typename Left, typename Right, typename Operation>
+	class ImageExpressionBinary
+	{
+	private:
+		Left m_left;
+		Right m_right;
+
+	public:
+		typedef typename ImageExpressionSameType<typename Left::ValueType, typename Right::ValueType>::Type ValueType;
+		enum
+		{
+			PACKET = Left::PACKET && Right::PACKET
+		};
+
+		inline ImageExpressionBinary(const Left &left, const Right &right) : m_left(left), m_right(right){};
+
+		inline int getWidth() const { return (m_left.getWidth() >= 0) ? m_left.getWidth() : m_right.getWidth(); };
+		inline int getHeight() const { return (m_left.getHeight() >= 0) ? m_left.getHeight() : m_right.getHeight(); };
+		inline bool isValid() const
+		{
+			return m_left.isValid() && m_right.isValid() &&
+				   ((m_left.getWidth() < 0) || (m_right.getWidth() < 0) ||
+					((m_left.getWidth() == m_right.getWidth()) && (m_left.getHeight() == m_right.getHeight())));
+		};
+		inline bool isPacked() const { return m_left.isPacked() && m_right.isPacked(); };
+		inline ValueType getValue(int y, PixelIndex x) const { return Operation::getValue(m_left.getValue(y, x), m_right.getValue(y, x)); };
+		inline ImageExpressionPacket::Type getPacket(int y, PixelIndex x) const { return Operation::getPacket(m_left.getPacket(y, x), m_right.getPacket(y, x)); };
+	};
+
+	/** Conversion of the base data type (like Image::copy() with a different base data type).
+	 *
+	 * The value is converted through the accumulators of both types and stored with
+	 * PixelTraits<Target>::getPixel(), i.e. narrowing conversions (e.g. float to uchar) are
+	 * rounded and saturated like ImageArithmetic::doNarrow().
+	 */
+	template <typename Target, typename Argument>
+	class ImageExpressionConvert
+	{
+	private:
+		Argument m_argument;
+
+	public:
+		typedef Target ValueType;
+		enum
+		{
+			PACKET = ImageExpressionConvertTraits<Target, Argument>::PACKET
+		};
+
+		inline ImageExpressionConvert(const Argument &argument) : m_argument(argument){};
+
+		inline int getWidth() const { return m_argument.getWidth(); };
+		inline int getHeight() const { return m_argument.getHeight(); };
+		inline bool isValid() const { return m_argument.isValid(); };
+		inline bool isPacked() const { return m_argument.isPacked(); };
+		inline ValueType getValue(int y, PixelIndex x) const
+		{
+			typename PixelTraits<Target>::Accumulator value;
+			value = PixelTraits<typename Argument::ValueType>::getAccumulator(m_argument.getValue(y, x));
+			return PixelTraits<Target>::getPixel(value);
+		};
+		inline ImageExpressionPacket::Type getPacket(int y, PixelIndex x) const { return m_argument.getPacket(y, x); };
+		inline const Argument &getArgument() const { return m_argument; };
+	};
+
+	/** Conversion of an image from uchar to float (loads the bytes directly into the registers). */
+	template <>
+	inline ImageExpressionPacket::Type ImageExpressionConvert<float, ImageExpressionImage<uchar> >::getPacket(int y, PixelIndex x) const
+	{
+		return ImageExpressionPacket::load(m_argument.getRow(y) + x);
+	}
+
+	/** Restriction of the values to the interval [low,high] (NaN is mapped to low). */
+	template <typename Argument>
+	class ImageExpressionClamp
+	{
+	public:
+		typedef typename Argument::ValueType ValueType;
+		enum
+		{
+			PACKET = Argument::PACKET
+		};
+
+	private:
+		Argument m_argument;
+		ValueType m_low;
+		ValueType m_high;
+
+	public:
+		inline ImageExpressionClamp(const Argument &argument, const ValueType &low, const ValueType &high) : m_argument(argument), m_low(low), m_high(high){};
+
+		inline int getWidth() const { return m_argument.getWidth(); };
+		inline int getHeight() const { return m_argument.getHeight(); };
+		inline bool isValid() const { return m_argument.isValid(); };
+		inline bool isPacked() const { return m_argument.isPacked(); };
+		inline ValueType getValue(int y, PixelIndex x) const
+		{
+			ValueType value = m_argument.getValue(y, x);
+			value = (value > m_low) ? value : m_low;
+			return (value < m_high) ? value : m_high;
+		};
+		inline ImageExpressionPacket::Type getPacket(int y, PixelIndex x) const
+		{
+			return ImageExpressionPacket::min(ImageExpressionPacket::max(m_argument.getPacket(y, x), ImageExpressionPacket::set(m_low)), ImageExpressionPacket::set(m_high));
+		};
+	};
+
+	/** Image expression.
+	 *
+	 * Arithmetic operators applied to images do not compute anything, but build an expression tree,
+	 * which is evaluated by Image::copy( const ImageExpression<Expression>& ) in a single pass over
+	 * the pixels without any temporary images:
+	 *
+	 * @code
+	 * result.copy( a * b + c / 2.0f );                    // instead of result.mul( a, b ).add( c ) ...
+	 * display.copy( convert<uchar>( clamp( 255.0f * a, 0.0f, 255.0f ) ) );
+	 * result.copy( convert<float>( gray ) * 0.5f + a );   // gray is of type Image<uchar>
+	 * @endcode
+	 *
+	 * All images of an expression must have the same size, and both operands of an operator the
+	 * same base data type (use convert() otherwise). Scalars are converted to the base data type of
+	 * the other operand. The pixel operations are the same as those of Image::add(), sub(), mul() and
+	 * div(): every operation is calculated in PixelTraits::Accumulator and stored with
+	 * PixelTraits::getPixel(), i.e. uchar, uint16, int16 and Rgb are rounded and saturated after
+	 * each operation (e.g. 200 / 3 gives 67 for uchar). Expressions of type float
+	 * (including conversions of float and uchar images to float) are evaluated with SSE2/AVX
+	 * registers; all other expressions pixel by pixel. convert() to an integer type rounds and
+	 * saturates (PixelTraits::getPixel()); converting a float expression that way, e.g.
+	 * convert<uchar>( a * b ), evaluates the float part in registers and narrows it with SSE2.
+	 *
+	 * The images of an expression are referenced, not copied, and must exist until the expression
+	 * has been evaluated. The destination may be one of the operands.
+	 */
+	template <typename Expression>
+	class ImageExpression : public Expression
+	{
+	public:
+		inline ImageExpression(const Expression &expression) : Expression(expression){};
+	};
+
+	/** Evaluates row y of an expression pixel by pixel. */
+	template <bool packet>
+	struct ImageExpressionEvaluator
+	{
+		template <typename Typ, typename Expression>
+		static inline void doEvaluate(const Expression &expression, Typ *result, int y, PixelIndex length)
+		{
+			for (PixelIndex x = 0; x < length; ++x)
+				result[x] = expression.getValue(y, x);
+		};
+	};
+
+	/** Evaluates row y of an expression of type float in registers. */
+	template <>
+	struct ImageExpressionEvaluator<true>
+	{
+		template <typename Expression>
+		static inline void doEvaluate(const Expression &expression, float *result, int y, PixelIndex length)
+		{
+			PixelIndex x = 0;
+			for (; x + ImageExpressionPacket::WIDTH <= length; x += ImageExpressionPacket::WIDTH)
+				ImageExpressionPacket::store(result + x, expression.getPacket(y, x));
+			for (; x < length; ++x)
+				result[x] = expression.getValue(y, x);
+		};
+	};
+
+	/** Evaluates row y of a conversion to a narrower type: the float argument in registers, the
+	 * rounding and saturation with the SIMD kernels of ImageArithmetic::doNarrow().
+	 */
+	template <bool packet>
+	struct ImageExpressionNarrowEvaluator
+	{
+		template <typename Typ, typename Argument>
+		static inline void doEvaluate(const ImageExpressionConvert<Typ, Argument> &expression, Typ *result, int y, PixelIndex length)
+		{
+			ImageExpressionEvaluator<ImageExpressionPacketTraits<Typ>::PACKET && ImageExpressionConvert<Typ, Argument>::PACKET>::doEvaluate(expression, result, y, length);
+		};
+	};
+
+	template <>
+	struct ImageExpressionNarrowEvaluator<true>
+	{
+		template <typename Typ, typename Argument>
+		static inline void doEvaluate(const ImageExpressionConvert<Typ, Argument> &expression, Typ *result, int y, PixelIndex length)
+		{
+			const Argument &argument = expression.getArgument();
+			float buffer[256];
+			for (PixelIndex start = 0; start < length; start += 256)
+			{
+				PixelIndex count = (length - start < 256) ? length - start : 256;
+				PixelIndex x = 0;
+				for (; x + ImageExpressionPacket::WIDTH <= count; x += ImageExpressionPacket::WIDTH)
+					ImageExpressionPacket::store(buffer + x, argument.getPacket(y, start + x));
+				for (; x < count; ++x)
+					buffer[x] = argument.getValue(y, start + x);
+				ImageArithmetic::doNarrow(result + start, buffer, count);
+			}
+		};
+	};
+
+	/** Evaluates row y of an expression into an image of base data type Typ. */
+	template <typename Typ, typename Expression>
+	struct ImageExpressionRowEvaluator
+	{
+		static inline void doEvaluate(const Expression &expression, Typ *result, int y, PixelIndex length)
+		{
+			ImageExpressionEvaluator<ImageExpressionPacketTraits<Typ>::PACKET &&
+									 ImageExpressionPacketTraits<typename Expression::ValueType>::PACKET &&
+									 Expression::PACKET>::doEvaluate(expression, result, y, length);
+		};
+	};
+
+	/** Evaluates row y of a conversion to Typ (narrowed in registers, if the argument is a float expression). */
+	template <typename Typ, typename Argument>
+	struct ImageExpressionRowEvaluator<Typ, ImageExpressionConvert<Typ, Argument> >
+	{
+		static inline void doEvaluate(const ImageExpressionConvert<Typ, Argument> &expression, Typ *result, int y, PixelIndex length)
+		{
+			ImageExpressionNarrowEvaluator<PixelTraits<Typ>::WIDENED &&
+										   ImageExpressionPacketTraits<typename Argument::ValueType>::PACKET &&
+										   Argument::PACKET>::doEvaluate(expression, result, y, length);
+		};
+	};
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	template <typename Expression>
+	Image<Typ> &Image<Typ>::copy(const ImageExpression<Expression> &expression)
+	/* ************************************************************************** */
+	{
+		//
+		// TEST: Images must be the same size
+		//
+		if (!expression.isValid() || (expression.getWidth() < 0))
+		{
+			gerr << "runtime error in Image<Typ>::copy( const ImageExpression<Expression> &expression )" << std::endl;
+			gerr << "The images of the expression are not the same size or the expression contains no image" << std::endl;
+
+			// NO ERROR CORRECTION possible -> do not change object
+			return *this;
+		}
+
+		if ((expression.getWidth() != m_width) || (expression.getHeight() != m_height))
+			resize(expression.getWidth(), expression.getHeight());
+
+		// packed images are evaluated as a single row
+		int rows = (isPacked() && expression.isPacked()) ? 1 : m_height;
+		PixelIndex length = (rows == 1) ? getSize() : m_width;
+
+		for (int y = 0; y < rows; ++y)
+			ImageExpressionRowEvaluator<Typ, Expression>::doEvaluate(expression, getRow(y), y, length);
+
+		return *this;
+	}
+
+	/* *** Operators ********************************************************** */
+
+	/** Defines an operator for all combinations of images, expressions and scalars. */
+#define GET_IMAGE_EXPRESSION_OPERATOR(OPERATOR, OPERATION)                                                                                                         \
+	template <typename Typ>                                                                                                                                        \
+	inline ImageExpression<ImageExpressionBinary<ImageExpressionImage<Typ>, ImageExpressionImage<Typ>, OPERATION> >                                                \
+	OPERATOR(const Image<Typ> &a, const Image<Typ> &b)                                                                                                             \
+	{                                                                                                                                                              \
+		return ImageExpressionBinary<ImageExpressionImage<Typ>, ImageExpressionImage<Typ>, OPERATION>(a, b);                                                       \
+	}                                                                                                                                                              \
+	template <typename Typ, typename Right>                                                                                                                        \
+	inline ImageExpression<ImageExpressionBinary<ImageExpressionImage<Typ>, Right, OPERATION> >                                                                    \
+	OPERATOR(const Image<Typ> &a, const ImageExpression<Right> &b)                                                                                                 \
+	{                                                                                                                                                              \
+		return ImageExpressionBinary<ImageExpressionImage<Typ>, Right, OPERATION>(a, b);                                                                           \
+	}                                                                                                                                                              \
+	template <typename Left, typename Typ>                                                                                                                         \
+	inline ImageExpression<ImageExpressionBinary<Left, ImageExpressionImage<Typ>, OPERATION> >                                                                     \
+	OPERATOR(const ImageExpression<Left> &a, const Image<Typ> &b)                                                                                                  \
+	{                                                                                                                                                              \
+		return ImageExpressionBinary<Left, ImageExpressionImage<Typ>, OPERATION>(a, b);                                                                            \
+	}                                                                                                                                                              \
+	template <typename Left, typename Right>                                                                                                                       \
+	inline ImageExpression<ImageExpressionBinary<Left, Right, OPERATION> >                                                                                         \
+	OPERATOR(const ImageExpression<Left> &a, const ImageExpression<Right> &b)                                                                                      \
+	{                                                                                                                                                              \
+		return ImageExpressionBinary<Left, Right, OPERATION>(a, b);                                                                                                \
+	}                                                                                                                                                              \
+	template <typename Typ>                                                                                                                                        \
+	inline ImageExpression<ImageExpressionBinary<ImageExpressionImage<Typ>, ImageExpressionScalar<Typ>, OPERATION> >                                               \
+	OPERATOR(const Image<Typ> &a, const typename ImageExpressionIdentity<Typ>::Type &b)                                                                            \
+	{                                                                                                                                                              \
+		return ImageExpressionBinary<ImageExpressionImage<Typ>, ImageExpressionScalar<Typ>, OPERATION>(a, b);                                                      \
+	}                                                                                                                                                              \
+	template <typename Typ>                                                                                                                                        \
+	inline ImageExpression<ImageExpressionBinary<ImageExpressionScalar<Typ>, ImageExpressionImage<Typ>, OPERATION> >                                               \
+	OPERATOR(const typename ImageExpressionIdentity<Typ>::Type &a, const Image<Typ> &b)                                                                            \
+	{                                                                                                                                                              \
+		return ImageExpressionBinary<ImageExpressionScalar<Typ>, ImageExpressionImage<Typ>, OPERATION>(a, b);                                                      \
+	}                                                                                                                                                              \
+	template <typename Left>                                                                                                                                       \
+	inline ImageExpression<ImageExpressionBinary<Left, ImageExpressionScalar<typename Left::ValueType>, OPERATION> >                                               \
+	OPERATOR(const ImageExpression<Left> &a, const typename Left::ValueType &b)                                                                                    \
+	{                                                                                                                                                              \
+		return ImageExpressionBinary<Left, ImageExpressionScalar<typename Left::ValueType>, OPERATION>(a, b);                                                      \
+	}                                                                                                                                                              \
+	template <typename Right>                                                                                                                                      \
+	inline ImageExpression<ImageExpressionBinary<ImageExpressionScalar<typename Right::ValueType>, Right, OPERATION> >                                             \
+	OPERATOR(const typename Right::ValueType &a, const ImageExpression<Right> &b)                                                                                  \
+	{                                                                                                                                                              \
+		return ImageExpressionBinary<ImageExpressionScalar<typename Right::ValueType>, Right, OPERATION>(a, b);                                                    \
+	}
+
+	GET_IMAGE_EXPRESSION_OPERATOR(operator+, ImageExpressionAdd)
+	GET_IMAGE_EXPRESSION_OPERATOR(operator-, ImageExpressionSub)
+	GET_IMAGE_EXPRESSION_OPERATOR(operator*, ImageExpressionMul)
+	GET_IMAGE_EXPRESSION_OPERATOR(operator/, ImageExpressionDiv)
+
+#undef GET_IMAGE_EXPRESSION_OPERATOR
+
+	/** Converts the base data type of an image within an expression, e.g. convert<float>( image ). */
+	template <typename Target, typename Typ>
+	inline ImageExpression<ImageExpressionConvert<Target, ImageExpressionImage<Typ> > > convert(const Image<Typ> &image)
+	{
+		return ImageExpressionConvert<Target, ImageExpressionImage<Typ> >(image);
+	}
+
+	/** Converts the base data type of an expression, e.g. convert<uchar>( a * b ). */
+	template <typename Target, typename Expression>
+	inline ImageExpression<ImageExpressionConvert<Target, Expression> > convert(const ImageExpression<Expression> &expression)
+	{
+		return ImageExpressionConvert<Target, Expression>(expression);
+	}
+
+	/** Restricts the pixels of an image to [low,high] within an expression. */
+	template <typename Typ>
+	inline ImageExpression<ImageExpressionClamp<ImageExpressionImage<Typ> > > clamp(const Image<Typ> &image, const typename ImageExpressionIdentity<Typ>::Type &low, const typename ImageExpressionIdentity<Typ>::Type &high)
+	{
+		return ImageExpressionClamp<ImageExpressionImage<Typ> >(image, low, high);
+	}
+
+	/** Restricts the values of an expression to [low,high]. */
+	template <typename Expression>
+	inline ImageExpression<ImageExpressionClamp<Expression> > clamp(const ImageExpression<Expression> &expression, const typename Expression::ValueType &low, const typename Expression::ValueType &high)
+	{
+		return ImageExpressionClamp<Expression>(expression, low, high);
+	}
+
+} /* namespace GET */
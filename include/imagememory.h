@@ -0,0 +1,76 @@
+#pragma once
+
+#include "basetypes.h"
+#include "imagepool.h"
+
+namespace GET
+{
+
+	/** Memory management for image data.
+	 *
+	 * The memory is taken from the ImagePool, so that freed image data is reused by the next
+	 * image of a similar size instead of being returned to the system. Like the image data of
+	 * the prebuilt libraries it is allocated with operator new[], so that images can be released
+	 * by either side (see ImagePool); its alignment is therefore that of operator new[] (16 bytes
+	 * on common 64-bit platforms). The rows of an image are stored without gaps, so further rows
+	 * are only aligned if the size of a row is a multiple of the alignment. Rows padded to a fixed
+	 * alignment are not offered: the prebuilt libraries process the image data as one array of
+	 * getSize() pixels and would misread them.
+	 *
+	 * @see Image::getStride()
+	 */
+	class ImageMemory
+	{
+	public:
+		/** Allocates memory for size pixels.
+		 *
+		 * The pixels are default constructed (i.e. uninitialised for the base data types).
+		 *
+		 * @param size number of pixels
+		 * @return pointer to the memory (NULL for size 0), must be released with doFree()
+		 * @throws std::bad_alloc if there is not enough memory
+		 */
+		template <typename Typ>
+		static inline Typ *doAllocate(PixelIndex size);
+
+		/** Releases memory allocated with doAllocate() or new Typ[].
+		 *
+		 * @param data pointer to the memory (may be NULL)
+		 * @param size number of pixels of the memory (exactly the number that was allocated)
+		 */
+		template <typename Typ>
+		static inline void doFree(Typ *data, PixelIndex size);
+	};
+
+	/* ************************************************************************** */
+	/* *** Implementation of the inline methods ********************************* */
+	/* ************************************************************************** */
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline Typ *ImageMemory::doAllocate(PixelIndex size)
+	/* ************************************************************************** */
+	{
+		if (size <= 0)
+			return NULL;
+
+		Typ *data = (Typ *)ImagePool::doAllocate((size_t)size * sizeof(Typ));
+		for (PixelIndex i = 0; i < size; ++i)
+			new (data + i) Typ;
+		return data;
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void ImageMemory::doFree(Typ *data, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		if (!data)
+			return;
+
+		for (PixelIndex i = 0; i < size; ++i)
+			data[i].~Typ();
+		ImagePool::doFree(data, (size_t)size * sizeof(Typ));
+	}
+
+} /* namespace GET */
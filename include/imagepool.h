@@ -0,0 +1,462 @@
+#pragma once
+
+#include <stddef.h>
+#include <new>
+
+#if __cplusplus >= 201103L
+#include <atomic>
+#include <mutex>
+#include <vector>
+#define GET_IMAGEPOOL
+#endif
+
+namespace GET
+{
+
+	/** Usage statistics of the ImagePool (see ImagePool::getStatistics()). */
+	struct ImagePoolStatistics
+	{
+		long long allocations;		 ///< number of allocations
+		long long thread_cache_hits; ///< allocations served from the cache of the calling thread
+		long long pool_hits;		 ///< allocations served from the shared pool
+		long long misses;			 ///< allocations served by the system allocator
+		long long bytes_in_use;		 ///< bytes handed out by doAllocate() minus bytes released with doFree() (see ImagePool)
+		long long peak_bytes_in_use; ///< maximum of bytes_in_use
+		long long bytes_cached;		 ///< bytes of the free blocks kept in the caches
+
+		/** Returns the fraction of the allocations that did not need the system allocator. */
+		inline double getHitRate() const
+		{
+			return (allocations > 0) ? (double)(thread_cache_hits + pool_hits) / allocations : 0.0;
+		};
+	};
+
+	/** Pool for the memory of the image data.
+	 *
+	 * Freed blocks are not returned to the system but kept for the next allocation of the same
+	 * size, so that temporary images and resize() in a video pipeline neither call the system
+	 * allocator nor touch fresh pages for every frame. The blocks are sorted into size classes of
+	 * 2^k and 1.5*2^k bytes (256 bytes up to 256 MiB, other blocks are not pooled) to find them
+	 * quickly; an allocation only takes a block of exactly the requested size.
+	 *
+	 * Every thread has a small cache (THREAD_CACHE_DEPTH blocks per class up to 16 MiB) that
+	 * is used without locking; further blocks are kept in a shared pool protected by a mutex.
+	 * The cache of a thread is moved to the shared pool when the thread ends. All cached
+	 * blocks together never exceed getCapacity() bytes, a capacity of 0 disables the pool.
+	 *
+	 * The blocks are allocated with operator new[] and no administrative data is stored with
+	 * them: code compiled against older versions of image.h (e.g. the prebuilt libraries in lib/)
+	 * allocates and releases image data inline with new[] and delete[], so a block handed out by
+	 * the pool may be released with delete[] and a block from new[] may be given to doFree().
+	 * Therefore the caller passes the size of the block to doFree(). Since blocks are only reused
+	 * for requests of their own size, this is the real size of every block, whichever side
+	 * allocated it; a block is never recorded smaller than it is, and blocks do not move to smaller
+	 * classes. The bytes counted in use by getStatistics() are only exact if all image data is
+	 * allocated and released here.
+	 *
+	 * The pool requires C++11 (thread_local, atomics); otherwise every block is allocated and
+	 * freed by the system and no statistics are collected.
+	 *
+	 * @see ImageMemory
+	 */
+	class ImagePool
+	{
+	public:
+		/** Allocates a block.
+		 *
+		 * @param bytes size of the block
+		 * @return pointer to the block, must be released with doFree() or operator delete[]
+		 * @throws std::bad_alloc if there is not enough memory
+		 */
+		static inline void *doAllocate(size_t bytes);
+
+		/** Releases a block (NULL is ignored).
+		 *
+		 * @param memory block allocated with doAllocate() or operator new[]
+		 * @param bytes size of the block (exactly the size that was allocated)
+		 */
+		static inline void doFree(void *memory, size_t bytes);
+
+		/** Sets the maximum number of bytes kept in the caches (default 512 MiB).
+		 *
+		 * If more is cached already, the shared pool is released (see doRelease()).
+		 */
+		static inline void setCapacity(size_t bytes);
+
+		/** Returns the maximum number of bytes kept in the caches. */
+		static inline size_t getCapacity();
+
+		/** Returns the usage statistics (hit rates, peak usage). */
+		static inline ImagePoolStatistics getStatistics();
+
+		/** Returns the cached blocks of the shared pool and of the calling thread to the system.
+		 *
+		 * The caches of other threads are not affected.
+		 */
+		static inline void doRelease();
+
+	private:
+		enum
+		{
+			/** Size of the smallest class is 2^MIN_CLASS_BITS bytes */
+			MIN_CLASS_BITS = 8,
+			/** Number of size classes (256 bytes to 256 MiB) */
+			CLASSES = 41,
+			/** Maximum number of blocks per class in the cache of a thread */
+			THREAD_CACHE_DEPTH = 4,
+			/** Larger blocks are only kept in the shared pool */
+			THREAD_CACHE_MAX_BYTES = 16 << 20
+		};
+
+		/** Free block */
+		struct Block
+		{
+			void *memory; ///< start of the block
+			size_t bytes; ///< size of the block (as allocated and passed to doFree())
+		};
+
+		/** Returns the size in bytes of a class. */
+		static inline size_t getClassSize(int size_class);
+
+		/** Returns the largest class not larger than the given size or -1 if the size is outside of the classes. */
+		static inline int getClass(size_t bytes);
+
+#ifdef GET_IMAGEPOOL
+		/** Data shared by all threads */
+		struct Shared
+		{
+			std::mutex mutex;
+			std::vector<Block> blocks[CLASSES];
+			std::atomic<size_t> capacity;
+			std::atomic<long long> allocations, thread_cache_hits, pool_hits, misses;
+			std::atomic<long long> bytes_in_use, peak_bytes_in_use, bytes_cached;
+
+			inline Shared() : capacity(512u << 20), allocations(0), thread_cache_hits(0), pool_hits(0), misses(0),
+							  bytes_in_use(0), peak_bytes_in_use(0), bytes_cached(0){};
+		};
+
+		/** Cache of a thread (trivial type, thus usable until the thread ends) */
+		struct ThreadCache
+		{
+			Block blocks[CLASSES][THREAD_CACHE_DEPTH];
+			int count[CLASSES];
+			bool closed; ///< true after the thread has released its cache
+		};
+
+		/** Moves the cache of the thread to the shared pool when the thread ends */
+		struct ThreadCacheGuard
+		{
+			inline ~ThreadCacheGuard();
+		};
+
+		/** Returns the shared data (never destroyed, images may be freed during program termination). */
+		static inline Shared &getShared();
+
+		/** Returns the cache storage of the calling thread. */
+		static inline ThreadCache &getThreadCacheStorage();
+
+		/** Returns the cache of the calling thread or NULL if it has been released already. */
+		static inline ThreadCache *getThreadCache();
+
+		/** Removes the most recently cached block of the given size from a list of blocks.
+		 *
+		 * @return true, if a block was found
+		 */
+		static inline bool doTake(Block *blocks, int &count, size_t bytes, Block &block);
+
+		/** Puts a free block into the shared pool or returns it to the system if the pool is full. */
+		static inline void doReturn(Shared &shared, int size_class, const Block &block);
+
+		/** Moves all blocks of a thread cache to the shared pool. */
+		static inline void doFlush(Shared &shared, ThreadCache &cache);
+#endif
+	};
+
+	/* ************************************************************************** */
+	/* *** Implementation of the inline methods ********************************* */
+	/* ************************************************************************** */
+
+	/* ************************************************************************** */
+	inline size_t ImagePool::getClassSize(int size_class)
+	/* ************************************************************************** */
+	{
+		// even classes 2^k, odd classes 1.5*2^k
+		size_t size = (size_t)1 << (MIN_CLASS_BITS + size_class / 2);
+		return (size_class % 2) ? size + size / 2 : size;
+	}
+
+	/* ************************************************************************** */
+	inline int ImagePool::getClass(size_t bytes)
+	/* ************************************************************************** */
+	{
+		if ((bytes < getClassSize(0)) || (bytes > getClassSize(CLASSES - 1)))
+			return -1;
+
+		int size_class = 0;
+		while ((size_class + 1 < CLASSES) && (getClassSize(size_class + 1) <= bytes))
+			++size_class;
+		return size_class;
+	}
+
+#ifdef GET_IMAGEPOOL
+
+	/* ************************************************************************** */
+	inline ImagePool::Shared &ImagePool::getShared()
+	/* ************************************************************************** */
+	{
+		static Shared *shared = new Shared();
+		return *shared;
+	}
+
+	/* ************************************************************************** */
+	inline ImagePool::ThreadCache &ImagePool::getThreadCacheStorage()
+	/* ************************************************************************** */
+	{
+		static thread_local ThreadCache cache;
+		return cache;
+	}
+
+	/* ************************************************************************** */
+	inline ImagePool::ThreadCache *ImagePool::getThreadCache()
+	/* ************************************************************************** */
+	{
+		ThreadCache &cache = getThreadCacheStorage();
+		if (cache.closed)
+			return NULL;
+
+		// registers the flush at the end of the thread on first use
+		static thread_local ThreadCacheGuard guard;
+		(void)guard;
+		return &cache;
+	}
+
+	/* ************************************************************************** */
+	inline ImagePool::ThreadCacheGuard::~ThreadCacheGuard()
+	/* ************************************************************************** */
+	{
+		ThreadCache &cache = getThreadCacheStorage();
+		doFlush(getShared(), cache);
+		cache.closed = true;
+	}
+
+	/* ************************************************************************** */
+	inline bool ImagePool::doTake(Block *blocks, int &count, size_t bytes, Block &block)
+	/* ************************************************************************** */
+	{
+		for (int i = count - 1; i >= 0; --i)
+		{
+			if (blocks[i].bytes == bytes)
+			{
+				block = blocks[i];
+				blocks[i] = blocks[--count];
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/* ************************************************************************** */
+	inline void ImagePool::doReturn(Shared &shared, int size_class, const Block &block)
+	/* ************************************************************************** */
+	{
+		{
+			std::lock_guard<std::mutex> lock(shared.mutex);
+			if (shared.bytes_cached + (long long)block.bytes <= (long long)shared.capacity)
+			{
+				shared.blocks[size_class].push_back(block);
+				shared.bytes_cached += (long long)block.bytes;
+				return;
+			}
+		}
+		::operator delete[](block.memory);
+	}
+
+	/* ************************************************************************** */
+	inline void ImagePool::doFlush(Shared &shared, ThreadCache &cache)
+	/* ************************************************************************** */
+	{
+		for (int size_class = 0; size_class < CLASSES; ++size_class)
+		{
+			while (cache.count[size_class] > 0)
+			{
+				const Block &block = cache.blocks[size_class][--cache.count[size_class]];
+				shared.bytes_cached -= (long long)block.bytes;
+				doReturn(shared, size_class, block);
+			}
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void *ImagePool::doAllocate(size_t bytes)
+	/* ************************************************************************** */
+	{
+		Shared &shared = getShared();
+		int size_class = getClass(bytes);
+		Block block = {NULL, 0};
+
+		++shared.allocations;
+		if (size_class >= 0)
+		{
+			ThreadCache *cache = (bytes <= (size_t)THREAD_CACHE_MAX_BYTES) ? getThreadCache() : NULL;
+			if (cache && doTake(cache->blocks[size_class], cache->count[size_class], bytes, block))
+				++shared.thread_cache_hits;
+
+			if (!block.memory)
+			{
+				std::lock_guard<std::mutex> lock(shared.mutex);
+				std::vector<Block> &blocks = shared.blocks[size_class];
+				int count = (int)blocks.size();
+				if ((count > 0) && doTake(&blocks[0], count, bytes, block))
+				{
+					blocks.pop_back();
+					++shared.pool_hits;
+				}
+			}
+			if (block.memory)
+				shared.bytes_cached -= (long long)block.bytes;
+		}
+		if (!block.memory)
+		{
+			block.memory = ::operator new[](bytes);
+			++shared.misses;
+		}
+
+		long long in_use = (shared.bytes_in_use += (long long)bytes);
+		long long peak = shared.peak_bytes_in_use;
+		while ((in_use > peak) && !shared.peak_bytes_in_use.compare_exchange_weak(peak, in_use))
+			;
+
+		return block.memory;
+	}
+
+	/* ************************************************************************** */
+	inline void ImagePool::doFree(void *memory, size_t bytes)
+	/* ************************************************************************** */
+	{
+		if (!memory)
+			return;
+
+		Shared &shared = getShared();
+		shared.bytes_in_use -= (long long)bytes;
+
+		int size_class = getClass(bytes);
+		if (size_class < 0)
+		{
+			::operator delete[](memory);
+			return;
+		}
+
+		Block block = {memory, bytes};
+		ThreadCache *cache = (bytes <= (size_t)THREAD_CACHE_MAX_BYTES) ? getThreadCache() : NULL;
+		if (cache && (cache->count[size_class] < THREAD_CACHE_DEPTH) &&
+			(shared.bytes_cached + (long long)bytes <= (long long)shared.capacity))
+		{
+			cache->blocks[size_class][cache->count[size_class]++] = block;
+			shared.bytes_cached += (long long)bytes;
+		}
+		else
+			doReturn(shared, size_class, block);
+	}
+
+	/* ************************************************************************** */
+	inline void ImagePool::setCapacity(size_t bytes)
+	/* ************************************************************************** */
+	{
+		getShared().capacity = bytes;
+		if (getShared().bytes_cached > (long long)bytes)
+			doRelease();
+	}
+
+	/* ************************************************************************** */
+	inline size_t ImagePool::getCapacity()
+	/* ************************************************************************** */
+	{
+		return getShared().capacity;
+	}
+
+	/* ************************************************************************** */
+	inline ImagePoolStatistics ImagePool::getStatistics()
+	/* ************************************************************************** */
+	{
+		Shared &shared = getShared();
+		ImagePoolStatistics statistics;
+		statistics.allocations = shared.allocations;
+		statistics.thread_cache_hits = shared.thread_cache_hits;
+		statistics.pool_hits = shared.pool_hits;
+		statistics.misses = shared.misses;
+		statistics.bytes_in_use = shared.bytes_in_use;
+		statistics.peak_bytes_in_use = shared.peak_bytes_in_use;
+		statistics.bytes_cached = shared.bytes_cached;
+		return statistics;
+	}
+
+	/* ************************************************************************** */
+	inline void ImagePool::doRelease()
+	/* ************************************************************************** */
+	{
+		Shared &shared = getShared();
+
+		ThreadCache *cache = getThreadCache();
+		if (cache)
+			doFlush(shared, *cache);
+
+		std::lock_guard<std::mutex> lock(shared.mutex);
+		for (int size_class = 0; size_class < CLASSES; ++size_class)
+		{
+			std::vector<Block> &blocks = shared.blocks[size_class];
+			for (size_t i = 0; i < blocks.size(); ++i)
+			{
+				::operator delete[](blocks[i].memory);
+				shared.bytes_cached -= (long long)blocks[i].bytes;
+			}
+			blocks.clear();
+		}
+	}
+
+#else /* GET_IMAGEPOOL */
+
+	/* ************************************************************************** */
+	inline void *ImagePool::doAllocate(size_t bytes)
+	/* ************************************************************************** */
+	{
+		return ::operator new[](bytes);
+	}
+
+	/* ************************************************************************** */
+	inline void ImagePool::doFree(void *memory, size_t)
+	/* ************************************************************************** */
+	{
+		if (memory)
+			::operator delete[](memory);
+	}
+
+	/* ************************************************************************** */
+	inline void ImagePool::setCapacity(size_t)
+	/* ************************************************************************** */
+	{
+	}
+
+	/* ************************************************************************** */
+	inline size_t ImagePool::getCapacity()
+	/* ************************************************************************** */
+	{
+		return 0;
+	}
+
+	/* ************************************************************************** */
+	inline ImagePoolStatistics ImagePool::getStatistics()
+	/* ************************************************************************** */
+	{
+		ImagePoolStatistics statistics = {0, 0, 0, 0, 0, 0, 0};
+		return statistics;
+	}
+
+	/* ************************************************************************** */
+	inline void ImagePool::doRelease()
+	/* ************************************************************************** */
+	{
+	}
+
+#endif /* GET_IMAGEPOOL */
+
+} /* namespace GET */
@@ -50,7 +50,7 @@ template <typename Typ> class ImageReference : public Image<Typ>
 	 * 
 	 * @param data neuer Zeiger auf die Bilddaten
 	 */
-	 inline void setData( Typ* data ) { m_data = data; };
+	 inline void setData( Typ* data ) { this->m_data = data; };
 	
 	/** 
 	 * Setzt den Bilddatenzeiger und ndert zustzlich Hhe und Breite des Bildes.
@@ -58,6 +58,19 @@ template <typename Typ> class ImageReference : public Image<Typ>
 	 * @param data neuer Zeiger auf die Bilddaten
 	 */
 	 inline void setData( Typ* data, int width, int height );
+	
+	/** 
+	 * Setzt den Bilddatenzeiger, Hhe und Breite des Bildes sowie den Zeilenabstand.
+	 * 
+	 * Damit kann z.B. ein Bildausschnitt oder ein Bild mit aufgefllten Zeilen
+	 * (siehe Image::getStride()) referenziert werden.
+	 * 
+	 * @param data neuer Zeiger auf die Bilddaten (erstes Pixel der ersten Zeile)
+	 * @param width  Breite des Bildes
+	 * @param height Hhe des Bildes
+	 * @param stride Abstand zwischen den Anfngen zweier Zeilen in Pixeln (>= width)
+	 */
+	 inline void setData( Typ* data, int width, int height, int stride );
 };
 
 
@@ -72,11 +85,18 @@ inline ImageReference<Typ>::ImageReference( int width, int height, Typ* data ) :
 template <typename Typ> 
 inline void ImageReference<Typ>::setData( Typ* data, int width, int height ) 
 { 
-	m_width  = width;
-	m_height = height;
-	m_size   = m_width * m_height;
+	this->m_width  = width;
+	this->m_height = height;
+	this->setStride( width );
 	
-	m_data = data; 
+	this->m_data = data; 
+};
+
+template <typename Typ> 
+inline void ImageReference<Typ>::setData( Typ* data, int width, int height, int stride ) 
+{ 
+	setData( data, width, height );
+	this->setStride( stride );
 };
 
 
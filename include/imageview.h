@@ -0,0 +1,313 @@
+#pragma once
+
+#include "image.h"
+#include "sharedimage.h"
+
+#include <algorithm>
+
+namespace GET
+{
+
+	template <typename Typ>
+	class ConstImageView;
+
+	/** Non-owning view of a rectangular region of an image.
+	 *
+	 * The view refers to the pixels of another image (offset and row pitch of that image) without
+	 * allocating or copying anything, in contrast to the section constructor
+	 * Image(const Image<OriginalTyp>&, int, int, int, int) and Image::copy(image, x0, y0, width, height).
+	 * Since the view is an Image<Typ>, it can be passed to every method that accepts an image and
+	 * handles the row pitch (see Image::getStride()), e.g. SpatialFiltering::doConvolutionWithImage(),
+	 * Statistic, Transpose, Image::copy() and image expressions.
+	 *
+	 * A view must not be passed to the methods of the prebuilt libraries in lib/ (e.g. FFT, DFT,
+	 * FrequencyDomainFiltering::setImage()) unless it is packed (Image::isPacked(), i.e. the region
+	 * covers whole rows): they are compiled against the old layout of Image, ignore the row pitch
+	 * and read getSize()-1 consecutive pixels from getData(). Copy the region into an Image first.
+	 *
+	 * Changes of the pixels of the view change the viewed image. The viewed image must exist as
+	 * long as the view is used and must not be resized or move-assigned meanwhile. resize() is only
+	 * allowed if the size does not change. Since the view can change the pixels, it needs a non-const image.
+	 * Use ConstImageView for a region of a const image.
+	 *
+	 * A view of a SharedImage gives the image its own data and pins it (SharedImage::isPinned()),
+	 * so that the view never changes copies of the image; copies made while the view refers to
+	 * the data get their own data. The view keeps the data alive and removes the pin when it is
+	 * destroyed or moved to another region (setRegion()).
+	 *
+	 * \code
+	 * ImageView<float> roi( frame, detection.x, detection.y, 32, 32 );
+	 * statistic.getMaxMin( roi, maximum, minimum );
+	 * roi.setRegion( frame, next.x, next.y, 32, 32 );
+	 * \endcode
+	 *
+	 * @param Typ base data type of the image
+	 */
+	template <typename Typ>
+	class ImageView : public Image<Typ>
+	{
+	public:
+		/** Constructor for an empty view. */
+		inline ImageView();
+
+		/** Constructor for a view of a region of an image.
+		 *
+		 * A region exceeding the image is clipped (with a message on gerr).
+		 *
+		 * @param image viewed image (or view)
+		 * @param x0 left column of the region
+		 * @param y0 top row of the region
+		 * @param width width of the region
+		 * @param height height of the region
+		 */
+		inline ImageView(Image<Typ> &image, int x0, int y0, int width, int height);
+
+		/** Constructor for a view of a whole image.
+		 *
+		 * @param image viewed image (or view)
+		 */
+		inline explicit ImageView(Image<Typ> &image);
+
+		/** Constructor for a view of a region of a SharedImage (see SharedImage::isPinned()).
+		 *
+		 * @param image viewed image, gets its own data if the data is shared
+		 * @param x0 left column of the region
+		 * @param y0 top row of the region
+		 * @param width width of the region
+		 * @param height height of the region
+		 */
+		inline ImageView(SharedImage<Typ> &image, int x0, int y0, int width, int height);
+
+		/** Constructor for a view of a whole SharedImage (see SharedImage::isPinned()).
+		 *
+		 * @param image viewed image, gets its own data if the data is shared
+		 */
+		inline explicit ImageView(SharedImage<Typ> &image);
+
+		/** Copy constructor, the new view refers to the same pixels (no copy of the pixels). */
+		inline ImageView(const ImageView<Typ> &view);
+
+		/** Destructor, removes the pin of a viewed SharedImage. */
+		inline ~ImageView();
+
+		/** Moves the view to a region of an image.
+		 *
+		 * A region exceeding the image is clipped (with a message on gerr).
+		 *
+		 * @param image viewed image (or view)
+		 * @param x0 left column of the region
+		 * @param y0 top row of the region
+		 * @param width width of the region
+		 * @param height height of the region
+		 */
+		inline void setRegion(Image<Typ> &image, int x0, int y0, int width, int height);
+
+		/** Moves the view to a region of a SharedImage (see SharedImage::isPinned()).
+		 *
+		 * @param image viewed image, gets its own data if the data is shared
+		 * @param x0 left column of the region
+		 * @param y0 top row of the region
+		 * @param width width of the region
+		 * @param height height of the region
+		 */
+		inline void setRegion(SharedImage<Typ> &image, int x0, int y0, int width, int height);
+
+	private:
+		/** Pinned data of a viewed SharedImage (NULL for other images) */
+		typename SharedImage<Typ>::Block *m_pinned;
+
+		/** Assignment is not possible (see Image::operator=()), use setRegion() */
+		ImageView<Typ> &operator=(const ImageView<Typ> &view);
+
+		/** Sets the region without changing the image (see setRegion()). */
+		inline void doSetRegion(const Image<Typ> &image, int x0, int y0, int width, int height);
+
+		/** Removes the pin of the viewed SharedImage, if any. */
+		inline void doUnpin();
+
+		friend class ConstImageView<Typ>;
+	};
+
+	/** Non-owning read-only view of a rectangular region of an image.
+	 *
+	 * Like ImageView, but for const images: the view can only be used as const Image<Typ>
+	 * (e.g. as input of a filter), so the pixels of the viewed image can not be changed
+	 * through it. The viewed image must exist as long as the view is used and must not be
+	 * changed meanwhile.
+	 *
+	 * \code
+	 * ConstImageView<float> band( input_image, 0, y0, input_image.getWidth(), 16 );
+	 * filter.doConvolutionWithImage( band, result );
+	 * \endcode
+	 *
+	 * @param Typ base data type of the image
+	 */
+	template <typename Typ>
+	class ConstImageView
+	{
+	public:
+		/** Constructor for an empty view. */
+		inline ConstImageView(){};
+
+		/** Constructor for a view of a region of an image (see ImageView::ImageView()). */
+		inline ConstImageView(const Image<Typ> &image, int x0, int y0, int width, int height) { m_view.doSetRegion(image, x0, y0, width, height); };
+
+		/** Constructor for a view of a whole image. */
+		inline explicit ConstImageView(const Image<Typ> &image) { m_view.doSetRegion(image, 0, 0, image.getWidth(), image.getHeight()); };
+
+		/** Moves the view to a region of an image (see ImageView::setRegion()). */
+		inline void setRegion(const Image<Typ> &image, int x0, int y0, int width, int height) { m_view.doSetRegion(image, x0, y0, width, height); };
+
+		/** Returns the viewed region as image. */
+		inline const Image<Typ> &getImage() const { return m_view; };
+
+		/** Conversion to the viewed region, so that the view can be passed as const Image<Typ>&. */
+		inline operator const Image<Typ> &() const { return m_view; };
+
+	private:
+		/** View of the region (never changed through this class) */
+		ImageView<Typ> m_view;
+	};
+
+	/* ************************************************************************** */
+	/* *** Implementation of the inline methods ********************************* */
+	/* ************************************************************************** */
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline ImageView<Typ>::ImageView() : Image<Typ>(0, 0, false),
+										 m_pinned(NULL)
+	/* ************************************************************************** */
+	{
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline ImageView<Typ>::ImageView(Image<Typ> &image, int x0, int y0, int width, int height) : Image<Typ>(0, 0, false),
+																								  m_pinned(NULL)
+	/* ************************************************************************** */
+	{
+		setRegion(image, x0, y0, width, height);
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline ImageView<Typ>::ImageView(Image<Typ> &image) : Image<Typ>(0, 0, false),
+														  m_pinned(NULL)
+	/* ************************************************************************** */
+	{
+		setRegion(image, 0, 0, image.getWidth(), image.getHeight());
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline ImageView<Typ>::ImageView(SharedImage<Typ> &image, int x0, int y0, int width, int height) : Image<Typ>(0, 0, false),
+																										m_pinned(NULL)
+	/* ************************************************************************** */
+	{
+		setRegion(image, x0, y0, width, height);
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline ImageView<Typ>::ImageView(SharedImage<Typ> &image) : Image<Typ>(0, 0, false),
+																m_pinned(NULL)
+	/* ************************************************************************** */
+	{
+		setRegion(image, 0, 0, image.getWidth(), image.getHeight());
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline ImageView<Typ>::ImageView(const ImageView<Typ> &view) : Image<Typ>(0, 0, false),
+																   m_pinned(view.m_pinned)
+	/* ************************************************************************** */
+	{
+		// the copy refers to the same data, so it pins it as well
+		if (m_pinned)
+		{
+			++m_pinned->pins;
+			SharedImage<Typ>::doAddReference(m_pinned);
+		}
+		doSetRegion(view, 0, 0, view.getWidth(), view.getHeight());
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline ImageView<Typ>::~ImageView()
+	/* ************************************************************************** */
+	{
+		doUnpin();
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void ImageView<Typ>::setRegion(Image<Typ> &image, int x0, int y0, int width, int height)
+	/* ************************************************************************** */
+	{
+		doSetRegion(image, x0, y0, width, height);
+
+		// a region of this view still refers to the pinned data
+		if ((const void *)&image != (const void *)this)
+			doUnpin();
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void ImageView<Typ>::setRegion(SharedImage<Typ> &image, int x0, int y0, int width, int height)
+	/* ************************************************************************** */
+	{
+		// pin first: the image may get its own data, and the previous region may be part of it
+		typename SharedImage<Typ>::Block *pinned = image.doPin();
+		doSetRegion(pinned->image, x0, y0, width, height);
+		doUnpin();
+		m_pinned = pinned;
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void ImageView<Typ>::doUnpin()
+	/* ************************************************************************** */
+	{
+		if (m_pinned)
+		{
+			SharedImage<Typ>::doUnpin(m_pinned);
+			m_pinned = NULL;
+		}
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void ImageView<Typ>::doSetRegion(const Image<Typ> &image, int x0, int y0, int width, int height)
+	/* ************************************************************************** */
+	{
+		//
+		// TEST: region inside the image
+		//
+		if ((x0 < 0) || (y0 < 0) || (x0 + width > image.getWidth()) || (y0 + height > image.getHeight()))
+		{
+			gerr << "runtime error in ImageView<Typ>::setRegion( Image<Typ> &image, int x0, int y0, int width, int height )\n";
+			gerr << "Specified region outside of the image, the region is clipped\n";
+
+			// ERROR CORRECTION
+			if (x0 < 0)
+			{
+				width += x0;
+				x0 = 0;
+			}
+			if (y0 < 0)
+			{
+				height += y0;
+				y0 = 0;
+			}
+			width = std::max(0, std::min(width, image.getWidth() - x0));
+			height = std::max(0, std::min(height, image.getHeight() - y0));
+		}
+
+		this->m_width = width;
+		this->m_height = height;
+		this->setStride(image.getStride());
+		this->m_data = (width > 0 && height > 0) ? image.getRow(y0) + x0 : NULL;
+	}
+
+} /* namespace GET */
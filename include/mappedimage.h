@@ -0,0 +1,263 @@
+#pragma once
+
+#include "image.h"
+#include "gexception.h"
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace GET
+{
+
+	/** Image whose data is a file mapped into memory (out-of-core images).
+	 *
+	 * The pixels are stored in the file without gaps, row by row, starting at a given byte
+	 * offset (e.g. behind a header). The file is mapped with mmap(), so only the pages that are
+	 * accessed are loaded and the page cache instead of the heap holds the working set. This
+	 * allows images larger than the main memory.
+	 *
+	 * Since the object is an Image<Typ>, point operations (add(), mul(), fill(), copy(), image
+	 * expressions), Statistic and the spatial filters work on it without changes. Processing the
+	 * image row by row is best; by default the kernel is told that the mapping is read
+	 * sequentially (more read-ahead, pages behind the reader are dropped early). Row bands can be
+	 * prefetched and evicted explicitly (doPrefetchRows(), doEvictRows()), and
+	 * SpatialFiltering::doConvolutionInBands() filters band by band.
+	 *
+	 * Like ImageReference the object does not manage its data with ImageMemory: resize() is only
+	 * allowed if the size does not change, and copies of the image copy the pixels.
+	 *
+	 * Only available on POSIX systems.
+	 *
+	 * @param Typ base data type of the image (stored in the file as in memory)
+	 */
+	template <typename Typ>
+	class MappedImage : public Image<Typ>
+	{
+	public:
+		/** Access to the file */
+		enum Mode
+		{
+			READ,		///< changes of the pixels stay in memory, the file is not changed (but changes of the file by others may show in unchanged pages)
+			READ_WRITE, ///< changes of the pixels are written to the file
+			CREATE		///< the file is created (or truncated) with the size of the image, as READ_WRITE
+		};
+
+		/** Expected access to the pixels (hint for the kernel) */
+		enum AccessPattern
+		{
+			NORMAL,		///< default read-ahead
+			SEQUENTIAL, ///< rows are processed from top to bottom (default)
+			RANDOM		///< no read-ahead
+		};
+
+		/** Constructor mapping a file.
+		 *
+		 * @param filename name of the file
+		 * @param width width of the image
+		 * @param height height of the image
+		 * @param mode access to the file
+		 * @param offset position of the first pixel in the file in bytes (multiple of sizeof(Typ))
+		 * @throws GException if the file can not be opened, created or mapped, or if it is too small
+		 */
+		inline MappedImage(const char *filename, int width, int height, Mode mode = READ, PixelIndex offset = 0);
+
+		/** Destructor, unmaps the file (changes in mode READ_WRITE/CREATE are kept in the file). */
+		inline ~MappedImage();
+
+		/** Returns the access mode of the file. */
+		inline Mode getMode() const { return m_mode; };
+
+		/** Tells the kernel how the pixels will be accessed.
+		 *
+		 * @param pattern expected access
+		 */
+		inline void setAccessPattern(AccessPattern pattern);
+
+		/** Starts reading a band of rows into the page cache in the background.
+		 *
+		 * @param y first row
+		 * @param rows number of rows
+		 */
+		inline void doPrefetchRows(int y, int rows);
+
+		/** Releases the memory of a band of rows that is not needed any more.
+		 *
+		 * The pixels are not lost: they are read again from the file (mode READ_WRITE/CREATE:
+		 * including the changes) when accessed. In mode READ changes of these rows are discarded.
+		 *
+		 * @param y first row
+		 * @param rows number of rows
+		 */
+		inline void doEvictRows(int y, int rows);
+
+		/** Writes changed pixels to the file and waits until this is done (mode READ_WRITE/CREATE). */
+		inline void doFlush();
+
+	private:
+		/** Start of the mapping (page aligned) */
+		void *m_mapping;
+		/** Size of the mapping in bytes */
+		size_t m_mapping_size;
+		/** Access mode of the file */
+		Mode m_mode;
+
+		/** Applies madvise() to the pages containing a band of rows. */
+		inline void doAdvise(int y, int rows, int advice);
+
+		/** Copying is not possible (the mapping has a single owner). */
+		MappedImage(const MappedImage<Typ> &);
+
+		/** Assignment is not possible. */
+		MappedImage<Typ> &operator=(const MappedImage<Typ> &);
+	};
+
+	/* ************************************************************************** */
+	/* *** Implementation of the inline methods ********************************* */
+	/* ************************************************************************** */
+
+#if !defined(_WIN32)
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline MappedImage<Typ>::MappedImage(const char *filename, int width, int height, Mode mode, PixelIndex offset) : Image<Typ>(width, height, false),
+																												   m_mapping(NULL),
+																												   m_mapping_size(0),
+																												   m_mode(mode)
+	/* ************************************************************************** */
+	{
+		const char *location = "MappedImage<Typ>::MappedImage( const char *filename, int width, int height, Mode mode, PixelIndex offset )";
+
+		int flags = (mode == READ) ? O_RDONLY : O_RDWR;
+		if (mode == CREATE)
+			flags |= O_CREAT | O_TRUNC;
+
+		int file = open(filename, flags, 0644);
+		if (file < 0)
+			throw GException(location, "The file can not be opened.");
+
+		size_t size = (size_t)offset + (size_t)this->getSize() * sizeof(Typ);
+		if (mode == CREATE)
+		{
+			if (ftruncate(file, (off_t)size) != 0)
+			{
+				close(file);
+				throw GException(location, "The file can not be created with the size of the image.");
+			}
+		}
+		else
+		{
+			struct stat status;
+			if ((fstat(file, &status) != 0) || ((size_t)status.st_size < size))
+			{
+				close(file);
+				throw GException(location, "The file is smaller than the image.");
+			}
+		}
+
+		if (size > 0)
+		{
+			// READ: private mapping, changes of the pixels do not reach the file
+			void *mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, (mode == READ) ? MAP_PRIVATE : MAP_SHARED, file, 0);
+			if (mapping == MAP_FAILED)
+			{
+				close(file);
+				throw GException(location, "The file can not be mapped into memory.");
+			}
+			m_mapping = mapping;
+			m_mapping_size = size;
+			this->m_data = (Typ *)((char *)m_mapping + offset);
+		}
+		close(file);
+
+		setAccessPattern(SEQUENTIAL);
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline MappedImage<Typ>::~MappedImage()
+	/* ************************************************************************** */
+	{
+		if (m_mapping)
+			munmap(m_mapping, m_mapping_size);
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void MappedImage<Typ>::setAccessPattern(AccessPattern pattern)
+	/* ************************************************************************** */
+	{
+		int advice = MADV_NORMAL;
+		if (pattern == SEQUENTIAL)
+			advice = MADV_SEQUENTIAL;
+		else if (pattern == RANDOM)
+			advice = MADV_RANDOM;
+
+		if (m_mapping)
+			madvise(m_mapping, m_mapping_size, advice);
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void MappedImage<Typ>::doPrefetchRows(int y, int rows)
+	/* ************************************************************************** */
+	{
+		doAdvise(y, rows, MADV_WILLNEED);
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void MappedImage<Typ>::doEvictRows(int y, int rows)
+	/* ************************************************************************** */
+	{
+		doAdvise(y, rows, MADV_DONTNEED);
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void MappedImage<Typ>::doFlush()
+	/* ************************************************************************** */
+	{
+		if (m_mapping && (m_mode != READ))
+			msync(m_mapping, m_mapping_size, MS_SYNC);
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void MappedImage<Typ>::doAdvise(int y, int rows, int advice)
+	/* ************************************************************************** */
+	{
+		// clip the band to the image
+		if (y < 0)
+		{
+			rows += y;
+			y = 0;
+		}
+		if (y + rows > this->m_height)
+			rows = this->m_height - y;
+		if (!m_mapping || (rows <= 0))
+			return;
+
+		// madvise() needs page aligned addresses: only whole pages of the band are evicted,
+		// all pages touching the band are prefetched
+		size_t page = (size_t)sysconf(_SC_PAGESIZE);
+		size_t begin = (size_t)((char *)this->getRow(y) - (char *)m_mapping);
+		size_t end = begin + (size_t)((PixelIndex)rows * this->getStride() * sizeof(Typ));
+		if (advice == MADV_DONTNEED)
+		{
+			begin = (begin + page - 1) / page * page;
+			end = (end == m_mapping_size) ? end : end / page * page;
+		}
+		else
+			begin = begin / page * page;
+
+		if (end > begin)
+			madvise((char *)m_mapping + begin, end - begin, advice);
+	}
+
+#endif /* _WIN32 */
+
+} /* namespace GET */
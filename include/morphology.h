@@ -0,0 +1,209 @@
+#pragma once
+
+#include "image.h"
+#include "imageview.h"
+#include "tiledimage.h"
+#include "gexception.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace GET
+{
+
+	/** Grey-value morphology with a rectangular structuring element (erosion and dilation).
+	 *
+	 * The erosion sets every pixel to the minimum, the dilation to the maximum of the pixels
+	 * covered by the structuring element. The origin of the element is its centre
+	 * (width/2, height/2), as for the masks of SpatialFiltering. At the border of the image only
+	 * the pixels inside the image are considered.
+	 *
+	 * The rectangle is separable: a horizontal pass computes the extremum of every row segment,
+	 * a vertical pass combines the rows of the segments. Both passes run along the rows.
+	 *
+	 * Very large images can be processed tile by tile (doErosionInTiles(), doDilationInTiles()),
+	 * the result is the same as for the whole image.
+	 *
+	 * @param Typ base data type of the image (must be ordered by operator<)
+	 */
+	template <typename Typ>
+	class Morphology
+	{
+	public:
+		/** Constructor.
+		 *
+		 * @param width width of the structuring element
+		 * @param height height of the structuring element
+		 */
+		inline Morphology(int width = 3, int height = 3);
+
+		/** Sets the size of the structuring element (at least 1x1). */
+		inline void setStructuringElement(int width, int height);
+
+		/** Returns the width of the structuring element. */
+		inline int getWidth() const { return m_width; };
+
+		/** Returns the height of the structuring element. */
+		inline int getHeight() const { return m_height; };
+
+		/** Erosion (minimum over the structuring element).
+		 *
+		 * @param input input image
+		 * @param result result image (is resized to the size of input, must not be input)
+		 */
+		inline void doErosion(const Image<Typ> &input, Image<Typ> &result) const { doFilter(input, result, std::less<Typ>()); };
+
+		/** Dilation (maximum over the structuring element).
+		 *
+		 * @param input input image
+		 * @param result result image (is resized to the size of input, must not be input)
+		 */
+		inline void doDilation(const Image<Typ> &input, Image<Typ> &result) const { doFilter(input, result, std::greater<Typ>()); };
+
+		/** Erosion of a tiled image, tile by tile (see TiledImage::TileIterator).
+		 *
+		 * @param input input image
+		 * @param result result image (is resized to the size of input, must not be input)
+		 */
+		inline void doErosionInTiles(const TiledImage<Typ> &input, TiledImage<Typ> &result) const { doFilterInTiles(input, result, std::less<Typ>()); };
+
+		/** Dilation of a tiled image, tile by tile (see TiledImage::TileIterator).
+		 *
+		 * @param input input image
+		 * @param result result image (is resized to the size of input, must not be input)
+		 */
+		inline void doDilationInTiles(const TiledImage<Typ> &input, TiledImage<Typ> &result) const { doFilterInTiles(input, result, std::greater<Typ>()); };
+
+	private:
+		/** Width of the structuring element */
+		int m_width;
+		/** Height of the structuring element */
+		int m_height;
+
+		/** Computes the extremum (first according to compare) over the structuring element. */
+		template <typename Compare>
+		void doFilter(const Image<Typ> &input, Image<Typ> &result, Compare compare) const;
+
+		/** Computes the extremum over the structuring element tile by tile. */
+		template <typename Compare>
+		void doFilterInTiles(const TiledImage<Typ> &input, TiledImage<Typ> &result, Compare compare) const;
+	};
+
+	/* ************************************************************************** */
+	/* *** Implementation of the inline methods ********************************* */
+	/* ************************************************************************** */
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline Morphology<Typ>::Morphology(int width, int height) : m_width(1),
+																m_height(1)
+	/* ************************************************************************** */
+	{
+		setStructuringElement(width, height);
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void Morphology<Typ>::setStructuringElement(int width, int height)
+	/* ************************************************************************** */
+	{
+		if ((width < 1) || (height < 1))
+		{
+			gerr << "runtime error in Morphology<Typ>::setStructuringElement( int width, int height )\n";
+			gerr << "The structuring element must have at least one pixel, the size is set to 1\n";
+		}
+		m_width = std::max(1, width);
+		m_height = std::max(1, height);
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	template <typename Compare>
+	void Morphology<Typ>::doFilter(const Image<Typ> &input, Image<Typ> &result, Compare compare) const
+	/* ************************************************************************** */
+	{
+		if (&input == &result)
+		{
+			throw GException("Morphology<Typ>::doFilter( const Image<Typ> &input, Image<Typ> &result, Compare compare )",
+							 "Input and result must be different images.");
+		}
+
+		int width = input.getWidth();
+		int height = input.getHeight();
+		int left = m_width / 2;
+		int right = m_width - 1 - left;
+		int top = m_height / 2;
+		int bottom = m_height - 1 - top;
+
+		result.resize(width, height);
+		if ((width == 0) || (height == 0))
+			return;
+
+		//
+		// horizontal pass: extremum of the row segment [x-left, x+right]
+		//
+		Image<Typ> rows(width, height);
+		for (int y = 0; y < height; ++y)
+		{
+			const Typ *inp = input.getRow(y);
+			Typ *res = rows.getRow(y);
+			for (int x = 0; x < width; ++x)
+			{
+				int x1 = std::min(width - 1, x + right);
+				Typ value = inp[std::max(0, x - left)];
+				for (int i = std::max(0, x - left) + 1; i <= x1; ++i)
+					if (compare(inp[i], value))
+						value = inp[i];
+				res[x] = value;
+			}
+		}
+
+		//
+		// vertical pass: extremum of the rows [y-top, y+bottom], row by row
+		//
+		for (int y = 0; y < height; ++y)
+		{
+			int y0 = std::max(0, y - top);
+			int y1 = std::min(height - 1, y + bottom);
+
+			Typ *res = result.getRow(y);
+			std::copy(rows.getRow(y0), rows.getRow(y0) + width, res);
+			for (int i = y0 + 1; i <= y1; ++i)
+			{
+				const Typ *inp = rows.getRow(i);
+				for (int x = 0; x < width; ++x)
+					if (compare(inp[x], res[x]))
+						res[x] = inp[x];
+			}
+		}
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	template <typename Compare>
+	void Morphology<Typ>::doFilterInTiles(const TiledImage<Typ> &input, TiledImage<Typ> &result, Compare compare) const
+	/* ************************************************************************** */
+	{
+		if (&input == &result)
+		{
+			throw GException("Morphology<Typ>::doFilterInTiles( const TiledImage<Typ> &input, TiledImage<Typ> &result, Compare compare )",
+							 "Input and result must be different images.");
+		}
+
+		result.resize(input.getWidth(), input.getHeight());
+		if ((result.getWidth() != input.getWidth()) || (result.getHeight() != input.getHeight()))
+			return;
+
+		// the halo covers the structuring element, at the image border it is clipped as in doFilter()
+		int left = m_width / 2;
+		int top = m_height / 2;
+		typename TiledImage<Typ>::TileIterator tile(input, left, top, m_width - 1 - left, m_height - 1 - top);
+		Image<Typ> tile_result;
+		for (; tile.isValid(); tile.doNext())
+		{
+			doFilter(tile.getInput(), tile_result, compare);
+			result.copyFrom(ImageView<Typ>(tile_result, tile.getOffsetX(), tile.getOffsetY(), tile.getWidth(), tile.getHeight()), tile.getX0(), tile.getY0());
+		}
+	}
+
+} /* namespace GET */
@@ -0,0 +1,508 @@
+#pragma once
+
+#include "image.h"
+#include "fft.h"
+#include "complexkernels.h"
+#include "gexception.h"
+#include "parallel.h"
+
+#include <math.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+
+namespace GET
+{
+
+	/** Convolution of large images with large filter masks by the overlap-save method.
+	 *
+	 * A convolution in the frequency domain (FrequencyDomainFiltering) needs one Fourier transform
+	 * of the size of the whole (padded) image. For large images this transform neither fits into
+	 * the cache nor, possibly, into the memory. The overlap-save method cuts the image into
+	 * overlapping tiles of size T*T (T a power of two, at least twice the mask size), convolves each tile
+	 * cyclically in the frequency domain and keeps the part of the result that is not disturbed by
+	 * the cyclic wrap-around: (T - mask_width + 1) * (T - mask_height + 1) pixels per tile.
+	 *
+	 * - The spectrum of the filter mask is computed once per tile size and reused for all tiles.
+	 * - Two real tiles are transformed together as real and imaginary part of one complex tile.
+	 *   Since the filter mask is real, the real and imaginary parts of the inverse transform
+	 *   are the results of the two tiles.
+	 * - The tiles are processed in parallel (OpenMP). Each thread only needs one complex tile as
+	 *   working memory, so the memory needed besides the input and result image is
+	 *   proportional to the tile size and not to the image size.
+	 *
+	 * The result is the same as the one of SpatialFiltering<float,float>: the filter mask is mirrored
+	 * (convolution), its reference point is in the middle (mask_width/2, mask_height/2) and the
+	 * pixels at the border, where the mask does not fit completely into the image, are
+	 * copied from the input image.
+	 *
+	 * @see SpatialFiltering
+	 * @see FrequencyDomainFiltering
+	 */
+	class OverlapSaveFiltering
+	{
+	private:
+		/** Filter mask */
+		Image<float> m_filter_mask;
+
+		/** true, if a usable filter mask is available */
+		bool m_filter_mask_available;
+
+		/** Input image (see SpatialFiltering::setImage()) */
+		Image<float> m_input_image;
+
+		/** true, if a usable input image is available */
+		bool m_input_image_available;
+
+		/** Tile size set by setTileSize() (0: chosen automatically) */
+		int m_tile_size;
+
+		/** Spectra of the filter mask per tile size */
+		std::map<int, Image<Complex> *> m_mask_spectra;
+
+	public:
+		/** Standard constructor. */
+		inline OverlapSaveFiltering();
+
+		/** Destructor. */
+		inline virtual ~OverlapSaveFiltering();
+
+		/** Sets a new filter mask.
+		 *
+		 * @param filter_mask Image object containing the new filter mask
+		 */
+		inline void setMask(const Image<float> &filter_mask);
+
+		/** Returns the current filter mask.
+		 *
+		 * @param filter_mask Image object in which the filter mask is returned
+		 */
+		inline void getMask(Image<float> &filter_mask) { filter_mask.copy(m_filter_mask); };
+
+		/** Sets the input image to be filtered.
+		 *
+		 * @param image image to be filtered
+		 */
+		inline void setImage(const Image<float> &image);
+
+		/** Sets the size of the tiles.
+		 *
+		 * The size is rounded up to a power of two and to at least twice the size of the filter mask.
+		 *
+		 * @param tile_size width and height of the tiles (0: chosen automatically, see getTileSize())
+		 */
+		inline void setTileSize(int tile_size) { m_tile_size = tile_size; };
+
+		/** Returns the size of the tiles used for a filter mask.
+		 *
+		 * If no tile size has been set, the power of two between max(64, twice the mask size) and
+		 * max(1024, twice the mask size) is chosen that needs the least operations per result pixel.
+		 *
+		 * @param mask_width width of the filter mask
+		 * @param mask_height height of the filter mask
+		 * @return width and height of the tiles
+		 */
+		inline int getTileSize(int mask_width, int mask_height) const;
+
+		/** Deletes the cached spectra of the filter mask. */
+		inline void clearMaskSpectra();
+
+		/** Performs the filtering (convolution) of the previously set input image with the previously set filter mask.
+		 *
+		 * @param result Image object in which the result of the convolution is stored
+		 *
+		 * @see setMask()
+		 * @see setImage()
+		 */
+		inline void doConvolution(Image<float> &result);
+
+		/** Performs the filtering (convolution) of the previously set input image with the given filter mask.
+		 *
+		 * @param filter_mask filter mask to convolve with
+		 * @param result Image object in which the result of the convolution is stored
+		 *
+		 * @see setImage()
+		 */
+		inline void doConvolutionWithMask(const Image<float> &filter_mask, Image<float> &result);
+
+		/** Performs the filtering (convolution) of the given input image with the previously set filter mask.
+		 *
+		 * @param input_image input image to be filtered
+		 * @param result Image object in which the result of the convolution is stored
+		 *
+		 * @see setMask()
+		 */
+		inline void doConvolutionWithImage(const Image<float> &input_image, Image<float> &result);
+
+	protected:
+		/** Implementation of the convolution.
+		 *
+		 * @param input_image input image to be filtered
+		 * @param filter_mask filter mask to convolve with
+		 * @param mask_spectra spectra of filter_mask per tile size (cache, may be extended)
+		 * @param result Image object in which the result of the convolution is stored
+		 */
+		inline void doConvolution(const Image<float> &input_image, const Image<float> &filter_mask,
+								  std::map<int, Image<Complex> *> &mask_spectra, Image<float> &result);
+
+		/** Performs the boundary handling (copies the pixels of the input image, see SpatialFiltering::doBoundaryCalculations()).
+		 *
+		 * @param input_image input image to be filtered
+		 * @param filter_mask filter mask to convolve with
+		 * @param result Image object in which the result of the convolution is stored
+		 */
+		inline virtual void doBoundaryCalculations(const Image<float> &input_image, const Image<float> &filter_mask, Image<float> &result);
+
+	private:
+		/** Computes the spectrum of a filter mask for a tile size. */
+		static inline void doComputeMaskSpectrum(const Image<float> &filter_mask, int tile_size, Image<Complex> &spectrum);
+
+		/** Deletes the spectra of a cache. */
+		static inline void doClearMaskSpectra(std::map<int, Image<Complex> *> &mask_spectra);
+
+		/** Copying is not applicable. */
+		OverlapSaveFiltering(const OverlapSaveFiltering &);
+		/** Assignment operator is not applicable. */
+		OverlapSaveFiltering &operator=(const OverlapSaveFiltering &);
+	};
+
+	/* ************************************************************************** */
+	/* *** Implementation of the inline methods ********************************* */
+	/* ************************************************************************** */
+
+	/* ************************************************************************** */
+	inline OverlapSaveFiltering::OverlapSaveFiltering() : m_filter_mask(),
+														  m_filter_mask_available(false),
+														  m_input_image(),
+														  m_input_image_available(false),
+														  m_tile_size(0),
+														  m_mask_spectra()
+	/* ************************************************************************** */
+	{
+	}
+
+	/* ************************************************************************** */
+	inline OverlapSaveFiltering::~OverlapSaveFiltering()
+	/* ************************************************************************** */
+	{
+		clearMaskSpectra();
+	}
+
+	/* ************************************************************************** */
+	inline void OverlapSaveFiltering::setMask(const Image<float> &filter_mask)
+	/* ************************************************************************** */
+	{
+		m_filter_mask.copy(filter_mask);
+		m_filter_mask_available = (m_filter_mask.getWidth() > 0) && (m_filter_mask.getHeight() > 0);
+
+		// The spectra belong to the previous mask
+		clearMaskSpectra();
+	}
+
+	/* ************************************************************************** */
+	inline void OverlapSaveFiltering::setImage(const Image<float> &image)
+	/* ************************************************************************** */
+	{
+		m_input_image.copy(image);
+		m_input_image_available = true;
+	}
+
+	/* ************************************************************************** */
+	inline int OverlapSaveFiltering::getTileSize(int mask_width, int mask_height) const
+	/* ************************************************************************** */
+	{
+		int mask_size = std::max(mask_width, mask_height);
+
+		// Smallest power of two of at least twice the mask size
+		int min_size = 2;
+		while (min_size < 2 * mask_size)
+			min_size *= 2;
+
+		if (m_tile_size > 0)
+		{
+			int tile_size = min_size;
+			while (tile_size < m_tile_size)
+				tile_size *= 2;
+			return tile_size;
+		}
+
+		// Operations per result pixel: T^2 log T / ((T - mask_width + 1)(T - mask_height + 1))
+		int best_size = min_size;
+		double best_costs = 0.0;
+		// (tiles smaller than 64*64 are not considered because of the overhead per tile)
+		for (int tile_size = std::max(min_size, 64); tile_size <= std::max(min_size, 1024); tile_size *= 2)
+		{
+			double costs = (double)tile_size * tile_size * log((double)tile_size) /
+						   ((double)(tile_size - mask_width + 1) * (tile_size - mask_height + 1));
+			if ((best_costs == 0.0) || (costs < best_costs))
+			{
+				best_size = tile_size;
+				best_costs = costs;
+			}
+		}
+		return best_size;
+	}
+
+	/* ************************************************************************** */
+	inline void OverlapSaveFiltering::clearMaskSpectra()
+	/* ************************************************************************** */
+	{
+		doClearMaskSpectra(m_mask_spectra);
+	}
+
+	/* ************************************************************************** */
+	inline void OverlapSaveFiltering::doConvolution(Image<float> &result)
+	/* ************************************************************************** */
+	{
+		if (m_filter_mask_available && m_input_image_available)
+			doConvolution(m_input_image, m_filter_mask, m_mask_spectra, result);
+		else
+		{
+			gerr << "Error in OverlapSaveFiltering::doConvolution( Image<float> &result )" << endl;
+			gerr << "Filter mask or input image does not exist." << endl;
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void OverlapSaveFiltering::doConvolutionWithMask(const Image<float> &filter_mask, Image<float> &result)
+	/* ************************************************************************** */
+	{
+		if (m_input_image_available)
+		{
+			// The spectra of a mask given directly are not kept
+			std::map<int, Image<Complex> *> mask_spectra;
+			try
+			{
+				doConvolution(m_input_image, filter_mask, mask_spectra, result);
+			}
+			catch (...)
+			{
+				doClearMaskSpectra(mask_spectra);
+				throw;
+			}
+			doClearMaskSpectra(mask_spectra);
+		}
+		else
+		{
+			gerr << "Error in OverlapSaveFiltering::doConvolutionWithMask( const Image<float> &filter_mask, Image<float> &result )" << endl;
+			gerr << "Input image does not exist." << endl;
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void OverlapSaveFiltering::doConvolutionWithImage(const Image<float> &input_image, Image<float> &result)
+	/* ************************************************************************** */
+	{
+		if (m_filter_mask_available)
+			doConvolution(input_image, m_filter_mask, m_mask_spectra, result);
+		else
+		{
+			gerr << "Error in OverlapSaveFiltering::doConvolutionWithImage( const Image<float> &input_image, Image<float> &result )" << endl;
+			gerr << "Filter mask does not exist." << endl;
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void OverlapSaveFiltering::doConvolution(const Image<float> &input_image, const Image<float> &filter_mask,
+													std::map<int, Image<Complex> *> &mask_spectra, Image<float> &result)
+	/* ************************************************************************** */
+	{
+		//
+		// Get and test sizes
+		//
+		int mask_width = filter_mask.getWidth();
+		int mask_height = filter_mask.getHeight();
+		int img_width = input_image.getWidth();
+		int img_height = input_image.getHeight();
+
+		if ((img_width < mask_width) || (img_height < mask_height))
+		{
+			throw GException(
+				"OverlapSaveFiltering::doConvolution( const Image<float> &input_image, const Image<float> &filter_mask, ..., Image<float> &result )",
+				"The filter mask must not be larger than the image.");
+		}
+		if ((img_width != result.getWidth()) || (img_height != result.getHeight()))
+		{
+			result.resize(img_width, img_height);
+		}
+
+		//
+		// Tiles: each tile of size tile_size*tile_size yields step_x*step_y result pixels
+		//
+		int tile_size = getTileSize(mask_width, mask_height);
+		int step_x = tile_size - mask_width + 1;
+		int step_y = tile_size - mask_height + 1;
+		int width = img_width - mask_width + 1;	  // width of the computed area
+		int height = img_height - mask_height + 1; // height of the computed area
+		int tiles_x = (width + step_x - 1) / step_x;
+		int tiles_y = (height + step_y - 1) / step_y;
+		int tiles = tiles_x * tiles_y;
+		int pairs = (tiles + 1) / 2;
+
+		// Spectrum of the filter mask for this tile size (computed before the parallel loop)
+		Image<Complex> *&mask_spectrum = mask_spectra[tile_size];
+		if (!mask_spectrum)
+		{
+			mask_spectrum = new Image<Complex>(tile_size, tile_size);
+			doComputeMaskSpectrum(filter_mask, tile_size, *mask_spectrum);
+		}
+		const Complex *spectrum = mask_spectrum->getData();
+
+		//
+		// Working memory per thread
+		//
+		int threads = std::max(1, std::min(Parallel::getMaxThreads(), pairs));
+		std::vector<FFT> ffts(threads, FFT(tile_size, DFT::SCALE_ON_RETRANSFORMATION));
+		std::vector<Image<Complex> > tiles_data(threads);
+
+		const float *inp_data = input_image.getData();
+		float *res_data = result.getData() + (mask_height / 2) * img_width + mask_width / 2;
+
+		//
+		// Convolve two tiles at a time
+		//
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(threads)
+#endif
+		for (int pair = 0; pair < pairs; ++pair)
+		{
+			int thread = Parallel::getThreadNumber();
+			FFT &fft = ffts[thread];
+			Image<Complex> &tile = tiles_data[thread];
+			if ((tile.getWidth() != tile_size) || (tile.getHeight() != tile_size))
+				tile.resize(tile_size, tile_size);
+
+			//
+			// Copy the input of both tiles into the real and the imaginary part
+			// (zeros outside the image)
+			//
+			tile.fill(0.0f);
+			for (int part = 0; part < 2; ++part)
+			{
+				int index = 2 * pair + part;
+				if (index >= tiles)
+					break;
+
+				int x0 = (index % tiles_x) * step_x;
+				int y0 = (index / tiles_x) * step_y;
+				int copy_width = std::min(tile_size, img_width - x0);
+				int copy_height = std::min(tile_size, img_height - y0);
+
+				for (int y = 0; y < copy_height; ++y)
+				{
+					const float *inp = inp_data + (y0 + y) * img_width + x0;
+					Complex *t = tile.getData() + y * tile_size;
+					if (part == 0)
+						for (int x = 0; x < copy_width; ++x)
+							t[x].re = inp[x];
+					else
+						for (int x = 0; x < copy_width; ++x)
+							t[x].im = inp[x];
+				}
+			}
+
+			//
+			// Cyclic convolution in the frequency domain
+			//
+			fft.doFourierTransform2D(tile);
+			ComplexKernels::doMultiply(tile.getData(), spectrum, tile.getData(), tile_size * tile_size);
+			fft.doInvFourierTransform2D(tile);
+
+			//
+			// Copy the valid part (not disturbed by the wrap-around) of both results
+			//
+			for (int part = 0; part < 2; ++part)
+			{
+				int index = 2 * pair + part;
+				if (index >= tiles)
+					break;
+
+				int x0 = (index % tiles_x) * step_x;
+				int y0 = (index / tiles_x) * step_y;
+				int copy_width = std::min(step_x, width - x0);
+				int copy_height = std::min(step_y, height - y0);
+
+				for (int y = 0; y < copy_height; ++y)
+				{
+					const Complex *t = tile.getData() + (y + mask_height - 1) * tile_size + mask_width - 1;
+					float *res = res_data + (y0 + y) * img_width + x0;
+					if (part == 0)
+						for (int x = 0; x < copy_width; ++x)
+							res[x] = t[x].re;
+					else
+						for (int x = 0; x < copy_width; ++x)
+							res[x] = t[x].im;
+				}
+			}
+		}
+
+		//
+		// Boundary handling
+		//
+		doBoundaryCalculations(input_image, filter_mask, result);
+	}
+
+	/* ************************************************************************** */
+	inline void OverlapSaveFiltering::doBoundaryCalculations(const Image<float> &input_image, const Image<float> &filter_mask, Image<float> &result)
+	/* ************************************************************************** */
+	{
+		int mask_width = filter_mask.getWidth();
+		int mask_height = filter_mask.getHeight();
+		int img_width = input_image.getWidth();
+		int img_height = input_image.getHeight();
+
+		int bsize_left = mask_width / 2;
+		int bsize_right = mask_width - bsize_left - 1;
+		int bsize_up = mask_height / 2;
+		int bsize_down = mask_height - bsize_up - 1;
+
+		const float *inp = input_image.getData();
+		float *res = result.getData();
+
+		for (int y = 0; y < img_height; ++y, inp += img_width, res += img_width)
+		{
+			if ((y < bsize_up) || (y >= img_height - bsize_down))
+			{
+				// upper and lower border
+				std::copy(inp, inp + img_width, res);
+			}
+			else
+			{
+				// left and right border
+				std::copy(inp, inp + bsize_left, res);
+				std::copy(inp + img_width - bsize_right, inp + img_width, res + img_width - bsize_right);
+			}
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void OverlapSaveFiltering::doComputeMaskSpectrum(const Image<float> &filter_mask, int tile_size, Image<Complex> &spectrum)
+	/* ************************************************************************** */
+	{
+		// Mask in the upper left corner of the tile, zeros elsewhere
+		spectrum.resize(tile_size, tile_size);
+		spectrum.fill(0.0f);
+
+		for (int y = 0; y < filter_mask.getHeight(); ++y)
+		{
+			const float *mask = filter_mask.getData() + y * filter_mask.getWidth();
+			Complex *s = spectrum.getData() + y * tile_size;
+			for (int x = 0; x < filter_mask.getWidth(); ++x)
+				s[x] = mask[x];
+		}
+
+		// Not scaled (the inverse transformation of the tiles is scaled)
+		FFT fft(tile_size, DFT::SCALE_ON_RETRANSFORMATION);
+		fft.doFourierTransform2D(spectrum);
+	}
+
+	/* ************************************************************************** */
+	inline void OverlapSaveFiltering::doClearMaskSpectra(std::map<int, Image<Complex> *> &mask_spectra)
+	/* ************************************************************************** */
+	{
+		for (std::map<int, Image<Complex> *>::iterator it = mask_spectra.begin(); it != mask_spectra.end(); ++it)
+			delete it->second;
+		mask_spectra.clear();
+	}
+
+} /* namespace GET */
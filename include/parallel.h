@@ -0,0 +1,41 @@
+#pragma once
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace GET
+{
+
+	/** Helper functions for the parallel execution of loops.
+	 *
+	 * The GETLib parallelises loops with OpenMP (#pragma omp ...). If the library is
+	 * compiled without OpenMP support (-fopenmp), the pragmas are ignored and all loops
+	 * run in the calling thread. These functions hide the difference, so that per-thread
+	 * working memory can be allocated the same way in both cases.
+	 */
+	class Parallel
+	{
+	public:
+		/** Returns the maximum number of threads a parallel loop is executed with. */
+		static inline int getMaxThreads()
+		{
+#ifdef _OPENMP
+			return omp_get_max_threads();
+#else
+			return 1;
+#endif
+		};
+
+		/** Returns the number of the calling thread within a parallel loop (0..getMaxThreads()-1). */
+		static inline int getThreadNumber()
+		{
+#ifdef _OPENMP
+			return omp_get_thread_num();
+#else
+			return 0;
+#endif
+		};
+	};
+
+} /* namespace GET */
@@ -0,0 +1,262 @@
+#pragma once
+
+#include "basetypes.h"
+#include "complex.h"
+
+namespace GET
+{
+
+	/** Colour value with float channels (accumulator of Rgb, see PixelTraits<Rgb>).
+	 *
+	 * Sums and products of Rgb pixels are calculated in RgbFloat and rounded and clamped to
+	 * [0,255] only when they are stored (PixelTraits<Rgb>::getPixel()).
+	 */
+	struct RgbFloat
+	{
+		/** Red value */
+		float r;
+		/** Green value */
+		float g;
+		/** Blue value */
+		float b;
+
+		/** Constructor (black). */
+		inline RgbFloat() : r(0.0f), g(0.0f), b(0.0f) {}
+
+		/** Constructor. */
+		inline RgbFloat(float red, float green, float blue) : r(red), g(green), b(blue) {}
+
+		/** Conversion of an Rgb pixel (without rounding). */
+		inline RgbFloat(const Rgb &rgb) : r(rgb.r), g(rgb.g), b(rgb.b) {}
+
+		/** Addition (per channel). */
+		inline RgbFloat &operator+=(const RgbFloat &add)
+		{
+			r += add.r;
+			g += add.g;
+			b += add.b;
+			return *this;
+		}
+
+		/** Subtraction (per channel). */
+		inline RgbFloat &operator-=(const RgbFloat &sub)
+		{
+			r -= sub.r;
+			g -= sub.g;
+			b -= sub.b;
+			return *this;
+		}
+
+		/** Multiplication (per channel). */
+		inline RgbFloat &operator*=(const RgbFloat &mul)
+		{
+			r *= mul.r;
+			g *= mul.g;
+			b *= mul.b;
+			return *this;
+		}
+
+		/** Division (per channel). */
+		inline RgbFloat &operator/=(const RgbFloat &div)
+		{
+			r /= div.r;
+			g /= div.g;
+			b /= div.b;
+			return *this;
+		}
+
+		/** Multiplication of all channels with a factor. */
+		inline RgbFloat &operator*=(float factor)
+		{
+			r *= factor;
+			g *= factor;
+			b *= factor;
+			return *this;
+		}
+
+		/** Division of all channels by a divisor. */
+		inline RgbFloat &operator/=(float divisor)
+		{
+			r /= divisor;
+			g /= divisor;
+			b /= divisor;
+			return *this;
+		}
+
+		/** Multiplication of all channels with a factor (e.g. a value of a filter mask). */
+		inline RgbFloat operator*(float factor) const { return RgbFloat(r * factor, g * factor, b * factor); }
+	};
+
+	/** Properties of a base data type used by the generic pixel loops.
+	 *
+	 * The loops of ImageArithmetic and SpatialFiltering do not calculate in the base data type
+	 * itself but in its accumulator type:
+	 * \code
+	 * typename PixelTraits<Typ>::Accumulator sum = PixelTraits<Typ>::getAccumulator( a );
+	 * sum += b;
+	 * result = PixelTraits<Typ>::getPixel( sum );
+	 * \endcode
+	 * For uchar, uint16, int16 and Rgb the accumulator has float channels, so sums do not
+	 * wrap around and products with masks or factors are not truncated. getPixel() rounds to
+	 * the nearest value (halves upwards) and clamps to the value range (saturation). half and
+	 * bfloat16 are accumulated in float as well. All other types are their own accumulator.
+	 *
+	 * Specialise PixelTraits for new base data types that need a wider type for calculations.
+	 *
+	 * @param Typ base data type of an image
+	 */
+	template <typename Typ>
+	struct PixelTraits
+	{
+		/** Type in which sums and products of pixels are calculated */
+		typedef Typ Accumulator;
+
+		enum
+		{
+			WIDENED = 0,   ///< 1, if Accumulator differs from Typ
+			SIMD_WIDTH = 1 ///< pixels per 128 bit vector register (1: pixel loops only)
+		};
+
+		/** Returns a pixel as accumulator. */
+		static inline Accumulator getAccumulator(const Typ &value) { return value; }
+
+		/** Stores an accumulator as pixel (rounded and clamped, if Accumulator is wider). */
+		static inline Typ getPixel(const Accumulator &value) { return value; }
+	};
+
+	/** PixelTraits of the integer types: accumulated in float, stored rounded and saturated.
+	 *
+	 * @param Typ integer type
+	 * @param MINIMUM smallest value of Typ
+	 * @param MAXIMUM largest value of Typ
+	 */
+	template <typename Typ, int MINIMUM, int MAXIMUM>
+	struct IntegerPixelTraits
+	{
+		/** Type in which sums and products of pixels are calculated */
+		typedef float Accumulator;
+
+		enum
+		{
+			WIDENED = 1,                   ///< 1, if Accumulator differs from Typ
+			SIMD_WIDTH = 16 / sizeof(Typ), ///< pixels per 128 bit vector register
+			MINIMUM_VALUE = MINIMUM,       ///< smallest value of Typ
+			MAXIMUM_VALUE = MAXIMUM        ///< largest value of Typ
+		};
+
+		/** Returns a pixel as accumulator. */
+		static inline Accumulator getAccumulator(const Typ &value) { return (float)value; }
+
+		/** Stores an accumulator as pixel (NaN is stored as MINIMUM).
+		 *
+		 * The value is clamped to [MINIMUM,MAXIMUM] and rounded to the nearest integer, halves
+		 * upwards (the SIMD kernels of ImageArithmetic::doNarrow() give the same result).
+		 */
+		static inline Typ getPixel(float value)
+		{
+			value = (value > (float)MINIMUM) ? value : (float)MINIMUM;
+			value = (value < (float)MAXIMUM) ? value : (float)MAXIMUM;
+			value += 0.5f;
+			int result = (int)value;
+			if ((float)result > value) // truncation rounded a negative value upwards
+				--result;
+			return (Typ)result;
+		}
+	};
+
+	/** uchar: accumulated in float, stored rounded and saturated to [0,255] */
+	template <>
+	struct PixelTraits<uchar> : public IntegerPixelTraits<uchar, 0, 255>
+	{
+	};
+
+	/** uint16: accumulated in float, stored rounded and saturated to [0,65535] */
+	template <>
+	struct PixelTraits<uint16> : public IntegerPixelTraits<uint16, 0, 65535>
+	{
+	};
+
+	/** int16: accumulated in float, stored rounded and saturated to [-32768,32767] */
+	template <>
+	struct PixelTraits<int16> : public IntegerPixelTraits<int16, -32768, 32767>
+	{
+	};
+
+	/** float: calculated in float */
+	template <>
+	struct PixelTraits<float>
+	{
+		typedef float Accumulator;
+		enum
+		{
+			WIDENED = 0,
+			SIMD_WIDTH = 4
+		};
+		static inline Accumulator getAccumulator(float value) { return value; }
+		static inline float getPixel(float value) { return value; }
+	};
+
+	/** Complex: calculated in Complex */
+	template <>
+	struct PixelTraits<Complex>
+	{
+		typedef Complex Accumulator;
+		enum
+		{
+			WIDENED = 0,
+			SIMD_WIDTH = 2
+		};
+		static inline Accumulator getAccumulator(const Complex &value) { return value; }
+		static inline Complex getPixel(const Accumulator &value) { return value; }
+	};
+
+	/** half: accumulated in float, stored rounded to nearest (even) */
+	template <>
+	struct PixelTraits<half>
+	{
+		typedef float Accumulator;
+		enum
+		{
+			WIDENED = 1,
+			SIMD_WIDTH = 8
+		};
+		static inline Accumulator getAccumulator(const half &value) { return (float)value; }
+		static inline half getPixel(float value) { return half(value); }
+	};
+
+	/** bfloat16: accumulated in float, stored rounded to nearest (even) */
+	template <>
+	struct PixelTraits<bfloat16>
+	{
+		typedef float Accumulator;
+		enum
+		{
+			WIDENED = 1,
+			SIMD_WIDTH = 8
+		};
+		static inline Accumulator getAccumulator(const bfloat16 &value) { return (float)value; }
+		static inline bfloat16 getPixel(float value) { return bfloat16(value); }
+	};
+
+	/** Rgb: accumulated in RgbFloat, every channel stored rounded and saturated to [0,255] */
+	template <>
+	struct PixelTraits<Rgb>
+	{
+		typedef RgbFloat Accumulator;
+		enum
+		{
+			WIDENED = 1,
+			SIMD_WIDTH = 1
+		};
+		static inline Accumulator getAccumulator(const Rgb &value) { return RgbFloat(value); }
+		static inline Rgb getPixel(const RgbFloat &value)
+		{
+			Rgb rgb;
+			rgb.r = PixelTraits<uchar>::getPixel(value.r);
+			rgb.g = PixelTraits<uchar>::getPixel(value.g);
+			rgb.b = PixelTraits<uchar>::getPixel(value.b);
+			return rgb;
+		}
+	};
+
+} /* namespace GET */
@@ -0,0 +1,369 @@
+#pragma once
+
+#include "image.h"
+#include "imagereference.h"
+#include "imagearithmetic.h"
+
+#include <algorithm>
+
+namespace GET
+{
+
+	/** RGB image with separate planes for the red, green and blue channels (planar layout).
+	 *
+	 * Image<Rgb> stores the three channels of each pixel next to each other (interleaved layout,
+	 * 3 bytes per pixel), so SIMD instructions can not process a channel without shuffles and
+	 * every operation on an Image<Rgb> handles the channels one by one (e.g. the convolution
+	 * multiplies and rounds each channel separately). In the planar layout every channel is a
+	 * contiguous Image<Typ>, so every algorithm for gray value images works on the channels
+	 * with its vectorised code, e.g. SpatialFiltering (see
+	 * SpatialFiltering::doConvolutionWithImage( const PlanarRgbImage<PTYPE>&, PlanarRgbImage<PTYPE>& )),
+	 * Scaling, Statistic, the pointwise arithmetic and image expressions.
+	 *
+	 * With Typ = float the channels can be filtered and scaled without rounding between the
+	 * steps; with Typ = uchar the image needs the same memory as an Image<Rgb>.
+	 *
+	 * The conversion between the planar layout and Image<Rgb> or Image<QRgb> (copy(), copyTo())
+	 * needs one pass over the data. It uses SIMD shuffles (see ImageArithmetic::doDeinterleave())
+	 * and is only needed at the boundaries of processing chains working on the planar layout.
+	 * QRgb is the pixel type of Qt (unsigned int 0xAARRGGBB); the alpha channel is ignored and
+	 * set to 255 by copyTo().
+	 *
+	 * @param Typ base data type of the channels (uchar or float, values in [0,255])
+	 *
+	 * @see Conversions::doRgb2Gray( const PlanarRgbImage<float>&, Image<float>& )
+	 */
+	template <typename Typ = float>
+	class PlanarRgbImage
+	{
+	private:
+		/** Memory of the three planes (one after the other) */
+		Image<Typ> m_storage;
+
+		/** Red channel */
+		ImageReference<Typ> m_red;
+
+		/** Green channel */
+		ImageReference<Typ> m_green;
+
+		/** Blue channel */
+		ImageReference<Typ> m_blue;
+
+		/** Number of pixels converted at once (channels of a block stay in the L1 cache) */
+		enum
+		{
+			BLOCK = 1024
+		};
+
+		/** Points the planes to m_storage. */
+		inline void doSetPlanes();
+
+		/** Converts a block of channel values from uchar (without rounding). */
+		static inline void doLoad(const uchar *source, Typ *destination, PixelIndex size) { ImageArithmetic::doConvert(destination, source, size); };
+
+		/** Converts a block of channel values to uchar (rounded and clamped to [0,255]). */
+		static inline void doStore(const Typ *source, uchar *destination, PixelIndex size);
+
+		/** Copy constructor is private and must not be used. */
+		PlanarRgbImage(const PlanarRgbImage<Typ> &);
+
+		/** Assignment operator is private and must not be used. */
+		PlanarRgbImage<Typ> &operator=(const PlanarRgbImage<Typ> &);
+
+	public:
+		/** Constructor.
+		 *
+		 * @param width width of the image
+		 * @param height height of the image
+		 */
+		inline PlanarRgbImage(int width = 0, int height = 0);
+
+		/** Constructor converting an image in interleaved layout.
+		 *
+		 * @param image RGB image to be copied
+		 */
+		inline explicit PlanarRgbImage(const Image<Rgb> &image);
+
+		/** Returns the width of the image. */
+		inline int getWidth() const { return m_red.getWidth(); };
+
+		/** Returns the height of the image. */
+		inline int getHeight() const { return m_red.getHeight(); };
+
+		/** Returns the number of pixels of the image. */
+		inline PixelIndex getSize() const { return m_red.getSize(); };
+
+		/** Returns the red channel. */
+		inline Image<Typ> &getRed() { return m_red; };
+
+		/** Returns the red channel. */
+		inline const Image<Typ> &getRed() const { return m_red; };
+
+		/** Returns the green channel. */
+		inline Image<Typ> &getGreen() { return m_green; };
+
+		/** Returns the green channel. */
+		inline const Image<Typ> &getGreen() const { return m_green; };
+
+		/** Returns the blue channel. */
+		inline Image<Typ> &getBlue() { return m_blue; };
+
+		/** Returns the blue channel. */
+		inline const Image<Typ> &getBlue() const { return m_blue; };
+
+		/** Returns a channel (0: red, 1: green, 2: blue), e.g. for loops over the channels. */
+		inline Image<Typ> &getChannel(int channel) { return (channel == 0) ? m_red : ((channel == 1) ? m_green : m_blue); };
+
+		/** Returns a channel (0: red, 1: green, 2: blue), e.g. for loops over the channels. */
+		inline const Image<Typ> &getChannel(int channel) const { return (channel == 0) ? m_red : ((channel == 1) ? m_green : m_blue); };
+
+		/** Resize image.
+		 *
+		 * The image data will be lost (see Image::resize()).
+		 *
+		 * @param width new width of the image
+		 * @param height new height of the image
+		 */
+		inline void resize(int width, int height);
+
+		/** Sets all pixels to the given colour. */
+		inline void fill(Typ red, Typ green, Typ blue);
+
+		/** Copies a planar RGB image.
+		 *
+		 * @param image image to be copied
+		 * @return this object
+		 */
+		inline PlanarRgbImage<Typ> &copy(const PlanarRgbImage<Typ> &image);
+
+		/** Copies an image in interleaved layout into the planar layout.
+		 *
+		 * @param image image to be copied
+		 * @return this object
+		 */
+		inline PlanarRgbImage<Typ> &copy(const Image<Rgb> &image);
+
+		/** Copies a Qt image (QRgb pixels, 0xAARRGGBB) into the planar layout.
+		 *
+		 * @param image image to be copied (Image<QRgb>, the alpha channel is ignored)
+		 * @return this object
+		 */
+		inline PlanarRgbImage<Typ> &copy(const Image<unsigned int> &image);
+
+		/** Copies this image into an image in interleaved layout.
+		 *
+		 * Values are rounded and clamped to [0,255].
+		 *
+		 * @param image image the pixels of this image are copied to (resized if necessary)
+		 */
+		inline void copyTo(Image<Rgb> &image) const;
+
+		/** Copies this image into a Qt image (QRgb pixels, alpha 255).
+		 *
+		 * Values are rounded and clamped to [0,255].
+		 *
+		 * @param image image the pixels of this image are copied to (Image<QRgb>, resized if necessary)
+		 */
+		inline void copyTo(Image<unsigned int> &image) const;
+
+	private:
+		/** Implementation of copy() for Rgb and QRgb. */
+		template <typename Pixel>
+		inline void doCopyFrom(const Image<Pixel> &image);
+
+		/** Implementation of copyTo() for Rgb and QRgb. */
+		template <typename Pixel>
+		inline void doCopyTo(Image<Pixel> &image) const;
+	};
+
+	/* ************************************************************************** */
+	/* *** Implementation of the inline methods ********************************* */
+	/* ************************************************************************** */
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline PlanarRgbImage<Typ>::PlanarRgbImage(int width, int height) : m_storage(width, 3 * height),
+																		 m_red(width, height, m_storage.getData()),
+																		 m_green(width, height, m_storage.getData() + (PixelIndex)width * height),
+																		 m_blue(width, height, m_storage.getData() + 2 * (PixelIndex)width * height)
+	/* ************************************************************************** */
+	{
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline PlanarRgbImage<Typ>::PlanarRgbImage(const Image<Rgb> &image) : m_storage(image.getWidth(), 3 * image.getHeight()),
+																		   m_red(image.getWidth(), image.getHeight(), m_storage.getData()),
+																		   m_green(image.getWidth(), image.getHeight(), m_storage.getData() + image.getSize()),
+																		   m_blue(image.getWidth(), image.getHeight(), m_storage.getData() + 2 * image.getSize())
+	/* ************************************************************************** */
+	{
+		copy(image);
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void PlanarRgbImage<Typ>::doSetPlanes()
+	/* ************************************************************************** */
+	{
+		int width = m_storage.getWidth();
+		int height = m_storage.getHeight() / 3;
+		PixelIndex size = (PixelIndex)width * height;
+
+		m_red.setData(m_storage.getData(), width, height);
+		m_green.setData(m_storage.getData() + size, width, height);
+		m_blue.setData(m_storage.getData() + 2 * size, width, height);
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void PlanarRgbImage<Typ>::resize(int width, int height)
+	/* ************************************************************************** */
+	{
+		if ((width == getWidth()) && (height == getHeight()))
+			return;
+
+		m_storage.resize(width, 3 * height);
+		doSetPlanes();
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void PlanarRgbImage<Typ>::fill(Typ red, Typ green, Typ blue)
+	/* ************************************************************************** */
+	{
+		m_red.fill(red);
+		m_green.fill(green);
+		m_blue.fill(blue);
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline PlanarRgbImage<Typ> &PlanarRgbImage<Typ>::copy(const PlanarRgbImage<Typ> &image)
+	/* ************************************************************************** */
+	{
+		if (&image != this)
+		{
+			resize(image.getWidth(), image.getHeight());
+			std::copy(image.m_storage.getData(), image.m_storage.getData() + 3 * getSize(), m_storage.getData());
+		}
+		return *this;
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline PlanarRgbImage<Typ> &PlanarRgbImage<Typ>::copy(const Image<Rgb> &image)
+	/* ************************************************************************** */
+	{
+		doCopyFrom(image);
+		return *this;
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline PlanarRgbImage<Typ> &PlanarRgbImage<Typ>::copy(const Image<unsigned int> &image)
+	/* ************************************************************************** */
+	{
+		doCopyFrom(image);
+		return *this;
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void PlanarRgbImage<Typ>::copyTo(Image<Rgb> &image) const
+	/* ************************************************************************** */
+	{
+		doCopyTo(image);
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void PlanarRgbImage<Typ>::copyTo(Image<unsigned int> &image) const
+	/* ************************************************************************** */
+	{
+		doCopyTo(image);
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	template <typename Pixel>
+	inline void PlanarRgbImage<Typ>::doCopyFrom(const Image<Pixel> &image)
+	/* ************************************************************************** */
+	{
+		resize(image.getWidth(), image.getHeight());
+
+		// the planes are packed; a packed source is processed as a single row
+		int rows = image.isPacked() ? 1 : getHeight();
+		PixelIndex size = (rows == 1) ? getSize() : getWidth();
+
+		uchar channel[3][BLOCK];
+		for (int y = 0; y < rows; ++y)
+		{
+			const Pixel *source = image.getRow(y);
+			Typ *plane[3] = {m_red.getData() + y * size, m_green.getData() + y * size, m_blue.getData() + y * size};
+
+			for (PixelIndex start = 0; start < size; start += BLOCK)
+			{
+				PixelIndex length = std::min((PixelIndex)BLOCK, size - start);
+				ImageArithmetic::doDeinterleave(source + start, channel[0], channel[1], channel[2], length);
+				for (int c = 0; c < 3; ++c)
+					doLoad(channel[c], plane[c] + start, length);
+			}
+		}
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	template <typename Pixel>
+	inline void PlanarRgbImage<Typ>::doCopyTo(Image<Pixel> &image) const
+	/* ************************************************************************** */
+	{
+		if ((image.getWidth() != getWidth()) || (image.getHeight() != getHeight()))
+			image.resize(getWidth(), getHeight());
+
+		// the planes are packed; a packed destination is processed as a single row
+		int rows = image.isPacked() ? 1 : getHeight();
+		PixelIndex size = (rows == 1) ? getSize() : getWidth();
+
+		uchar channel[3][BLOCK];
+		for (int y = 0; y < rows; ++y)
+		{
+			Pixel *destination = image.getRow(y);
+			const Typ *plane[3] = {m_red.getData() + y * size, m_green.getData() + y * size, m_blue.getData() + y * size};
+
+			for (PixelIndex start = 0; start < size; start += BLOCK)
+			{
+				PixelIndex length = std::min((PixelIndex)BLOCK, size - start);
+				for (int c = 0; c < 3; ++c)
+					doStore(plane[c] + start, channel[c], length);
+				ImageArithmetic::doInterleave(channel[0], channel[1], channel[2], destination + start, length);
+			}
+		}
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void PlanarRgbImage<Typ>::doStore(const Typ *source, uchar *destination, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		for (PixelIndex i = 0; i < size; ++i)
+			destination[i] = PixelTraits<uchar>::getPixel((float)source[i]);
+	}
+
+	/* ************************************************************************** */
+	template <>
+	inline void PlanarRgbImage<float>::doStore(const float *source, uchar *destination, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		ImageArithmetic::doNarrow(destination, source, size);
+	}
+
+	/* ************************************************************************** */
+	template <>
+	inline void PlanarRgbImage<uchar>::doStore(const uchar *source, uchar *destination, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		std::copy(source, source + size, destination);
+	}
+
+} /* namespace GET */
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "image.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+namespace GET
+{
+
+	/** Loading and saving of images as raw pixel data (e.g. 16 bit camera images).
+	 *
+	 * A raw file contains the pixels row by row without gaps, optionally behind a header of a
+	 * fixed size that is skipped when loading. Width, height and byte order are not stored in
+	 * the file and have to be given when loading. Unlike ImageIO this does not need Qt and keeps
+	 * the full 16 bit of Image<uint16> and Image<int16>.
+	 *
+	 * Multi-byte pixels are byte-swapped if the byte order of the file differs from the byte
+	 * order of the computer.
+	 *
+	 * @param Typ base data type with a single channel, e.g. uint16, int16, uchar or float
+	 */
+	template <typename Typ>
+	class RawImageIO
+	{
+	public:
+		/** Byte order of the pixels in the file */
+		enum ByteOrder
+		{
+			LITTLE_ENDIAN_ORDER, ///< least significant byte first (e.g. x86, most cameras)
+			BIG_ENDIAN_ORDER	 ///< most significant byte first (e.g. PGM with 16 bit, FITS)
+		};
+
+		/** Loads an image from a raw file.
+		 *
+		 * @param filename name of the file
+		 * @param image loaded image (is resized to width x height)
+		 * @param width width of the image
+		 * @param height height of the image
+		 * @param order byte order of the pixels in the file
+		 * @param offset size of the header in bytes (skipped)
+		 * @return true on success, false if the file can not be opened or is too small
+		 */
+		static inline bool openImage(const char *filename, Image<Typ> &image, int width, int height, ByteOrder order = LITTLE_ENDIAN_ORDER, long offset = 0);
+
+		/** Saves an image as raw file (without header).
+		 *
+		 * @param filename name of the file (is overwritten)
+		 * @param image image to save
+		 * @param order byte order of the pixels in the file
+		 * @return true on success, false if the file can not be written
+		 */
+		static inline bool saveImage(const char *filename, const Image<Typ> &image, ByteOrder order = LITTLE_ENDIAN_ORDER);
+
+	private:
+		/** Returns true if the byte order of the file differs from the byte order of the computer. */
+		static inline bool isSwapped(ByteOrder order);
+
+		/** Reverses the bytes of each pixel. */
+		static inline void doSwap(Typ *data, PixelIndex size);
+	};
+
+	/* ************************************************************************** */
+	/* *** Implementation of the inline methods ********************************* */
+	/* ************************************************************************** */
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline bool RawImageIO<Typ>::openImage(const char *filename, Image<Typ> &image, int width, int height, ByteOrder order, long offset)
+	/* ************************************************************************** */
+	{
+		FILE *file = fopen(filename, "rb");
+		if (!file)
+		{
+			gerr << "runtime error in RawImageIO<Typ>::openImage( const char *filename, Image<Typ> &image, int width, int height, ByteOrder order, long offset )\n";
+			gerr << "The file " << filename << " can not be opened\n";
+			return false;
+		}
+
+		image.resize(width, height);
+		bool success = (fseek(file, offset, SEEK_SET) == 0);
+
+		// read row by row, the rows of the image may be padded
+		bool swap = isSwapped(order);
+		for (int y = 0; success && (y < image.getHeight()); ++y)
+		{
+			Typ *row = image.getRow(y);
+			success = (fread(row, sizeof(Typ), (size_t)image.getWidth(), file) == (size_t)image.getWidth());
+			if (swap)
+				doSwap(row, image.getWidth());
+		}
+		fclose(file);
+
+		if (!success)
+		{
+			gerr << "runtime error in RawImageIO<Typ>::openImage( const char *filename, Image<Typ> &image, int width, int height, ByteOrder order, long offset )\n";
+			gerr << "The file " << filename << " is smaller than the image\n";
+		}
+		return success;
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline bool RawImageIO<Typ>::saveImage(const char *filename, const Image<Typ> &image, ByteOrder order)
+	/* ************************************************************************** */
+	{
+		FILE *file = fopen(filename, "wb");
+		if (!file)
+		{
+			gerr << "runtime error in RawImageIO<Typ>::saveImage( const char *filename, const Image<Typ> &image, ByteOrder order )\n";
+			gerr << "The file " << filename << " can not be created\n";
+			return false;
+		}
+
+		// swapped pixels are written from a copy of the row
+		bool swap = isSwapped(order);
+		std::vector<Typ> buffer(swap ? image.getWidth() : 0);
+		bool success = true;
+		for (int y = 0; success && (y < image.getHeight()); ++y)
+		{
+			const Typ *row = image.getRow(y);
+			if (swap)
+			{
+				std::copy(row, row + image.getWidth(), buffer.begin());
+				doSwap(&buffer[0], image.getWidth());
+				row = &buffer[0];
+			}
+			success = (fwrite(row, sizeof(Typ), (size_t)image.getWidth(), file) == (size_t)image.getWidth());
+		}
+		success = (fclose(file) == 0) && success;
+
+		if (!success)
+		{
+			gerr << "runtime error in RawImageIO<Typ>::saveImage( const char *filename, const Image<Typ> &image, ByteOrder order )\n";
+			gerr << "The file " << filename << " can not be written\n";
+		}
+		return success;
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline bool RawImageIO<Typ>::isSwapped(ByteOrder order)
+	/* ************************************************************************** */
+	{
+		const unsigned short probe = 1;
+		bool little_endian = (*(const unsigned char *)&probe == 1);
+		return (sizeof(Typ) > 1) && (little_endian != (order == LITTLE_ENDIAN_ORDER));
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void RawImageIO<Typ>::doSwap(Typ *data, PixelIndex size)
+	/* ************************************************************************** */
+	{
+		for (PixelIndex i = 0; i < size; ++i)
+		{
+			unsigned char *bytes = (unsigned char *)(data + i);
+			std::reverse(bytes, bytes + sizeof(Typ));
+		}
+	}
+
+} /* namespace GET */
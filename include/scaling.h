@@ -1,6 +1,11 @@
 #ifndef __GET__SCALING_H
 #define __GET__SCALING_H
 
+#include "image.h"
+#include "fastmath.h"
+
+#include <algorithm>
+
 namespace GET
 {
 
@@ -175,8 +180,116 @@ class Scaling
 	 * @return entsprechender zurckskalierter und danach diskretisierter Wert aus dem originalen Wertebereich
 	 */
 	int doScaleBackDiskreteWithTruncation( float scaled_value );
+
+	/**
+	 * Skaliert alle Pixel eines Bildes mit einer Potenzfunktion (Gammakorrektur).
+	 * 
+	 * Jeder Wert v wird bezglich des originalen Wertebereichs auf [0,1] normiert (kleinere
+	 * Werte werden auf 0 gesetzt), mit gamma potenziert und in den skalierten Wertebereich
+	 * abgebildet: scal_min + (scal_max - scal_min) * ((v - orig_min) / (orig_max - orig_min))^gamma.
+	 * 
+	 * Die Potenzen werden blockweise mit FastMath::doPow() berechnet, d.h. nach
+	 * FastMath::setAccuracy( FastMath::FAST ) wird die vektorisierte Nherung verwendet.
+	 * 
+	 * @param input Eingabebild (Werte aus dem originalen Wertebereich)
+	 * @param output Ausgabebild (Werte aus dem skalierten Wertebereich, darf input sein)
+	 * @param gamma Exponent der Potenzfunktion
+	 */
+	inline void doScaleGamma( const Image<float> &input, Image<float> &output, float gamma );
+	
+	/**
+	 * Skaliert alle Pixel eines Bildes linear vom originalen in den skalierten Wertebereich
+	 * und speichert sie in einem Bild mit anderem Basisdatentyp, z.B. ein 12-Bit-Kamerabild
+	 * (Image<uint16>, originaler Bereich [0,4095]) nach Image<uchar> mit Bereich [0,255].
+	 * 
+	 * Gerechnet wird blockweise in float (ImageArithmetic::doWiden()), gespeichert wird mit
+	 * ImageArithmetic::doNarrow(), d.h. fr ganzzahlige Zieltypen gerundet und auf deren
+	 * Wertebereich begrenzt (Sttigung).
+	 * 
+	 * Source und Destination mssen float als Akkumulator haben (siehe PixelTraits), also
+	 * float, uchar, uint16, int16, half oder bfloat16 sein.
+	 * 
+	 * @param input Eingabebild (Werte aus dem originalen Wertebereich)
+	 * @param output Ausgabebild (Werte aus dem skalierten Wertebereich)
+	 */
+	template <typename Source, typename Destination>
+	inline void doScaleImage( const Image<Source> &input, Image<Destination> &output );
 };
 
+
+
+/* ************************************************************************** */
+inline void Scaling::doScaleGamma( const Image<float> &input, Image<float> &output, float gamma )
+/* ************************************************************************** */
+{
+	if ( (output.getWidth() != input.getWidth()) || (output.getHeight() != input.getHeight()) )
+		output.resize( input.getWidth(), input.getHeight() );
+	
+	// gepackte Bilder werden als eine einzige Zeile bearbeitet
+	int rows = ( input.isPacked() && output.isPacked() ) ? 1 : input.getHeight();
+	PixelIndex size = ( rows == 1 ) ? input.getSize() : input.getWidth();
+	
+	float normalisation = (m_orig_maxval != m_orig_minval) ? 1.0f / (m_orig_maxval - m_orig_minval) : 0.0f;
+	float range = m_scal_maxval - m_scal_minval;
+	
+	// Blcke, die im Cache bleiben, statt drei Durchlufen ber das ganze Bild
+	const int block_size = 1024;
+	for ( int y = 0; y < rows; ++y )
+	{
+		const float *source = input.getRow( y );
+		float *destination = output.getRow( y );
+		
+		for ( PixelIndex start = 0; start < size; start += block_size )
+		{
+			int length = (int)std::min( (PixelIndex)block_size, size - start );
+			
+			for ( int i = 0; i < length; ++i )
+				destination[start + i] = std::max( (source[start + i] - m_orig_minval) * normalisation, 0.0f );
+			
+			FastMath::doPow( destination + start, gamma, destination + start, length );
+			
+			for ( int i = 0; i < length; ++i )
+				destination[start + i] = m_scal_minval + range * destination[start + i];
+		}
+	}
+}
+
+
+/* ************************************************************************** */
+template <typename Source, typename Destination>
+inline void Scaling::doScaleImage( const Image<Source> &input, Image<Destination> &output )
+/* ************************************************************************** */
+{
+	if ( (output.getWidth() != input.getWidth()) || (output.getHeight() != input.getHeight()) )
+		output.resize( input.getWidth(), input.getHeight() );
+	
+	// gepackte Bilder werden als eine einzige Zeile bearbeitet
+	int rows = ( input.isPacked() && output.isPacked() ) ? 1 : input.getHeight();
+	PixelIndex size = ( rows == 1 ) ? input.getSize() : input.getWidth();
+	
+	float factor = (m_orig_maxval != m_orig_minval) ? (m_scal_maxval - m_scal_minval) / (m_orig_maxval - m_orig_minval) : 0.0f;
+	float offset = m_scal_minval - m_orig_minval * factor;
+	
+	// Zwischenergebnis in float, ein Block bleibt im Cache
+	const int block_size = 1024;
+	float block[block_size];
+	for ( int y = 0; y < rows; ++y )
+	{
+		const Source *source = input.getRow( y );
+		Destination *destination = output.getRow( y );
+		
+		for ( PixelIndex start = 0; start < size; start += block_size )
+		{
+			int length = (int)std::min( (PixelIndex)block_size, size - start );
+			
+			ImageArithmetic::doWiden( block, source + start, length );
+			for ( int i = 0; i < length; ++i )
+				block[i] = offset + factor * block[i];
+			ImageArithmetic::doNarrow( destination + start, block, length );
+		}
+	}
+}
+
 }
 
 #endif //_SKALING_H_
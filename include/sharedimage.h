@@ -0,0 +1,331 @@
+#pragma once
+
+#include "image.h"
+
+#if __cplusplus >= 201103L
+#include <atomic>
+#include <utility>
+#define GET_SHAREDIMAGE_ATOMIC
+#endif
+
+namespace GET
+{
+
+	template <typename Typ>
+	class ImageView;
+
+	/** Image whose copies share the image data until one of them is changed (copy-on-write).
+	 *
+	 * Copies of an Image always copy the pixels. Images that are copied often but rarely changed
+	 * (e.g. frames handed to several filters or worker threads) can be held as SharedImage
+	 * instead: copying a SharedImage only increments a reference count, the pixels are copied
+	 * when a shared image is changed (getWritableImage()).
+	 *
+	 * The image and its reference count are stored together in one block owned by all copies,
+	 * so an image that is not shared is accessed without any locking. If compiled with C++11,
+	 * the reference count is atomic: copies of one SharedImage may be passed to other threads
+	 * and read or changed there (a single SharedImage object must not be used by several threads
+	 * at once, like any other object).
+	 *
+	 * An ImageView of a SharedImage gives the image its own data and pins it: as long as views
+	 * refer to the data, copies of the image get their own data instead of sharing it, so
+	 * changes through the views never reach the copies.
+	 *
+	 * The sharing is a property of this class only. The Image returned by getImage() is an ordinary
+	 * image, so it can be passed to every method, including those of the prebuilt libraries,
+	 * as long as only getWritableImage() is used for changing it.
+	 *
+	 * \code
+	 * SharedImage<float> frame( camera_image );
+	 * SharedImage<float> for_worker( frame );          // no copy of the pixels
+	 * statistic.getMaxMin( for_worker.getImage(), maximum, minimum );
+	 * frame.getWritableImage().mul( 0.5f );            // frame gets its own pixels first
+	 * \endcode
+	 *
+	 * @param Typ base data type of the image
+	 */
+	template <typename Typ>
+	class SharedImage
+	{
+	public:
+		/** Constructor, creates an image of the given size (not shared). */
+		inline SharedImage(int width = 0, int height = 0);
+
+		/** Constructor, copies the pixels of an image (not shared). */
+		inline explicit SharedImage(const Image<Typ> &image);
+
+#if __cplusplus >= 201103L
+		/** Constructor, takes over the image data of an image without copying it (see Image::Image(Image<Typ>&&)). */
+		inline explicit SharedImage(Image<Typ> &&image);
+#endif
+
+		/** Copy constructor, shares the image data with image (no copy of the pixels). */
+		inline SharedImage(const SharedImage<Typ> &image);
+
+		/** Destructor, the image data is released by the last image sharing it. */
+		inline ~SharedImage();
+
+		/** Assignment, shares the image data with image (no copy of the pixels). */
+		inline SharedImage<Typ> &operator=(const SharedImage<Typ> &image);
+
+		/** Returns the image for reading.
+		 *
+		 * The image must not be changed through this reference (it may be shared).
+		 */
+		inline const Image<Typ> &getImage() const { return m_block->image; };
+
+		/** Conversion to the image for reading, so that the object can be passed as const Image<Typ>&. */
+		inline operator const Image<Typ> &() const { return m_block->image; };
+
+		/** Returns the image for changing it.
+		 *
+		 * If the image data is shared with other images, this object gets its own copy first.
+		 * The reference is valid until this object is copied, assigned or destroyed: a copy
+		 * made afterwards shares the image data again, so call getWritableImage() again
+		 * before changing the image after copying it.
+		 */
+		inline Image<Typ> &getWritableImage();
+
+		/** Returns true, if the image data is shared with other images. */
+		inline bool isShared() const { return getOwners() > 1; };
+
+		/** Returns true, if views refer to the image data (see ImageView). */
+		inline bool isPinned() const { return getPins() > 0; };
+
+		/** Returns the width of the image. */
+		inline int getWidth() const { return m_block->image.getWidth(); };
+
+		/** Returns the height of the image. */
+		inline int getHeight() const { return m_block->image.getHeight(); };
+
+	private:
+		/** Image together with the number of objects referring to it */
+		struct Block
+		{
+			Image<Typ> image;
+#ifdef GET_SHAREDIMAGE_ATOMIC
+			std::atomic<int> references; ///< SharedImage objects and views referring to the block
+			std::atomic<int> pins;		 ///< views referring to the block (see ImageView)
+#else
+			int references; ///< SharedImage objects and views referring to the block
+			int pins;		///< views referring to the block (see ImageView)
+#endif
+
+			inline Block(int width, int height) : image(width, height), references(1), pins(0){};
+			inline explicit Block(const Image<Typ> &original) : image(original), references(1), pins(0){};
+#if __cplusplus >= 201103L
+			inline explicit Block(Image<Typ> &&original) : image(std::move(original)), references(1), pins(0){};
+#endif
+		};
+
+		/** Block shared with all copies of this object (never NULL) */
+		Block *m_block;
+
+		/** Returns the number of SharedImage objects sharing m_block. */
+		inline int getOwners() const { return getReferences(m_block) - getPins(); };
+
+		/** Returns the number of views referring to m_block. */
+		inline int getPins() const;
+
+		/** Shares m_block, which has been taken from image, or copies it if it is pinned. */
+		inline void doShare();
+
+		/** Gives this object its own image data and pins it for a view.
+		 *
+		 * @return the block the view refers to, must be released with doUnpin()
+		 */
+		inline Block *doPin();
+
+		/** Removes the pin of a view from a block (see doPin()). */
+		static inline void doUnpin(Block *block);
+
+		/** Returns the number of objects referring to a block. */
+		static inline int getReferences(const Block *block);
+
+		/** Adds a reference to a block. */
+		static inline void doAddReference(Block *block);
+
+		/** Removes a reference to a block, deletes it if it was the last one. */
+		static inline void doRelease(Block *block);
+
+		friend class ImageView<Typ>;
+	};
+
+	/* ************************************************************************** */
+	/* *** Implementation of the inline methods ********************************* */
+	/* ************************************************************************** */
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline SharedImage<Typ>::SharedImage(int width, int height) : m_block(new Block(width, height))
+	/* ************************************************************************** */
+	{
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline SharedImage<Typ>::SharedImage(const Image<Typ> &image) : m_block(new Block(image))
+	/* ************************************************************************** */
+	{
+	}
+
+#if __cplusplus >= 201103L
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline SharedImage<Typ>::SharedImage(Image<Typ> &&image) : m_block(new Block(std::move(image)))
+	/* ************************************************************************** */
+	{
+	}
+#endif
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline SharedImage<Typ>::SharedImage(const SharedImage<Typ> &image) : m_block(image.m_block)
+	/* ************************************************************************** */
+	{
+		doShare();
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline SharedImage<Typ>::~SharedImage()
+	/* ************************************************************************** */
+	{
+		doRelease(m_block);
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline SharedImage<Typ> &SharedImage<Typ>::operator=(const SharedImage<Typ> &image)
+	/* ************************************************************************** */
+	{
+		if (image.m_block != m_block)
+		{
+			doRelease(m_block);
+			m_block = image.m_block;
+			doShare();
+		}
+		return *this;
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline Image<Typ> &SharedImage<Typ>::getWritableImage()
+	/* ************************************************************************** */
+	{
+		if (getOwners() > 1)
+		{
+			Block *block = new Block(m_block->image);
+			doRelease(m_block);
+			m_block = block;
+		}
+		return m_block->image;
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void SharedImage<Typ>::doShare()
+	/* ************************************************************************** */
+	{
+		// views of the other image must not change this one
+		if (getPins() > 0)
+			m_block = new Block(m_block->image);
+		else
+			doAddReference(m_block);
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline typename SharedImage<Typ>::Block *SharedImage<Typ>::doPin()
+	/* ************************************************************************** */
+	{
+		getWritableImage();
+		++m_block->pins;
+		doAddReference(m_block);
+		return m_block;
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void SharedImage<Typ>::doUnpin(Block *block)
+	/* ************************************************************************** */
+	{
+		--block->pins;
+		doRelease(block);
+	}
+
+#ifdef GET_SHAREDIMAGE_ATOMIC
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline int SharedImage<Typ>::getPins() const
+	/* ************************************************************************** */
+	{
+		return m_block->pins.load(std::memory_order_acquire);
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline int SharedImage<Typ>::getReferences(const Block *block)
+	/* ************************************************************************** */
+	{
+		// acquire: the changes of a released copy are visible before the data is written
+		return block->references.load(std::memory_order_acquire);
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void SharedImage<Typ>::doAddReference(Block *block)
+	/* ************************************************************************** */
+	{
+		block->references.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void SharedImage<Typ>::doRelease(Block *block)
+	/* ************************************************************************** */
+	{
+		// acq_rel: all accesses of the other copies happen before the block is deleted
+		if (block->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			delete block;
+	}
+
+#else /* GET_SHAREDIMAGE_ATOMIC */
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline int SharedImage<Typ>::getPins() const
+	/* ************************************************************************** */
+	{
+		return m_block->pins;
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline int SharedImage<Typ>::getReferences(const Block *block)
+	/* ************************************************************************** */
+	{
+		return block->references;
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void SharedImage<Typ>::doAddReference(Block *block)
+	/* ************************************************************************** */
+	{
+		++block->references;
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void SharedImage<Typ>::doRelease(Block *block)
+	/* ************************************************************************** */
+	{
+		if (--block->references == 0)
+			delete block;
+	}
+
+#endif /* GET_SHAREDIMAGE_ATOMIC */
+
+} /* namespace GET */
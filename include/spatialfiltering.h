@@ -2,9 +2,13 @@
 #define __GET__SPATIALFILTERING_H
 
 #include "image.h"
+#include "imageview.h"
+#include "tiledimage.h"
+#include "planarrgbimage.h"
 #include "gexception.h"
 
 #include <math.h>
+#include <algorithm>
 
 
 namespace GET
@@ -20,20 +24,16 @@ namespace GET
  * 
  * #Randbehanldlungsmethode:# Pixelwert aus Originalbild kopieren.
  * 
+ * Die Summe wird im Akkumulatortyp von PixelTraits gebildet und jedes Ergebnispixel 
+ * nur einmal gerundet und auf den Wertebereich begrenzt (Sttigung). Fr Bilder vom 
+ * Typ uchar, uint16, int16 und Rgb wird in float (Rgb: RgbFloat) summiert, so 
+ * dass die Filterung ohne vorherige Umwandlung nach float mglich ist; half und bfloat16 
+ * werden ebenfalls in float summiert. Die brigen Typen werden in sich selbst summiert.
+ * 
  * @author Holger Tubig
  * @version FUNKTIONSFHIG.
  * @note keine Quellen.
  * 
- * @bug 
- *       bei der Filterung wird #VOR DEM SUMMIEREN# jeder Pixel mit dem Gewicht multipliziert
- *       und wieder #DISKRETISIERT(NACH UCHAR UMGEWANDELT)#. Das fhrt zu dem Eindruck, dass 
- *       die Farbtiefe abnimmt (#siehe testSpatialFiltering fr Image<uchar> und Image<Rgb>#). 
- *       Das heisst: #Filterung kann fr Rgb und uchar so nicht verwendet werden#. Lsung: Es 
- *       muss in diesem Fall erst vollstndig aufsummiert und abschliessend durch die Summe 
- *       der Maskenwerte dividiert werden. Frage: Evtl. kann der Fehler fr float-Masken so
- *       gelassen werden. Image<uchar> werden blicherweise vermutlich auch mit uchar-Masken 
- *       gefiltert und dort ist die andere Vorgehensweise ohnehin notwendig. (siehe auch Todo)
- * 
  * @todo Aufsatzpunkt ist bisher in der Mitte (Widerspruch zu Faltung)
  * @todo Erweiterung auf uchar-Filtermasken
  * @todo nach Einfhrung der Exceptions in GETGLOBAL: Exceptions erzeugen, wenn Eingabebild
@@ -123,6 +123,56 @@ template <typename PTYPE, typename MASKTYPE=float> class SpatialFiltering
 	 */
 	inline void doConvolutionWithImage( const Image<PTYPE> &input_image, Image<PTYPE> &result );
 
+	/** Filterung(Faltung) zeilenbandweise ausfhren.
+	 * 
+	 * Liefert das gleiche Ergebnis wie doConvolutionWithImage(), bearbeitet das Bild aber in 
+	 * Bndern von band_height Zeilen (plus den von der Maske bentigten Nachbarzeilen). 
+	 * Dadurch bleibt der Speicherbedarf auf ein Band beschrnkt und Eingabe- und Ergebnisbild 
+	 * werden nur einmal von oben nach unten durchlaufen, z.B. fr sehr groe Bilder oder 
+	 * MappedImage-Objekte, deren Daten nicht in den Hauptspeicher passen.
+	 * 
+	 * Eine abgeleitete Randbehandlung (doBoundaryCalculations()) wird fr jedes Band 
+	 * aufgerufen und darf nur die Zeilen am oberen und unteren Rand des Bandes verndern.
+	 * 
+	 * @param input_image Eingabebild, das gefiltert werden soll
+	 * @param result Image-Objekt, in dem das Ergebnis der Faltung gespeichert werden soll
+	 * @param band_height Anzahl der Zeilen pro Band (mindestens die Hhe der Filtermaske)
+	 * 
+	 * @see setMask()
+	 */
+	void doConvolutionInBands( const Image<PTYPE> &input_image, Image<PTYPE> &result, int band_height = 256 );
+
+	/** Filterung(Faltung) kachelweise ausfhren.
+	 * 
+	 * Liefert das gleiche Ergebnis wie doConvolutionWithImage() fr das ganze Bild. Jede Kachel 
+	 * wird mit den von der Maske bentigten Nachbarpixeln (TiledImage::TileIterator) gefaltet, 
+	 * so dass nur eine Kachel mit Rand gleichzeitig als Zeilenbild im Speicher liegt. 
+	 * 
+	 * Eine abgeleitete Randbehandlung (doBoundaryCalculations()) wird fr jede Kachel 
+	 * aufgerufen und darf nur die Pixel am Rand der Kachel verndern.
+	 * 
+	 * @param input_image Eingabebild, das gefiltert werden soll
+	 * @param result Ergebnisbild (anderes Objekt als input_image, wird ggf. auf die Gre 
+	 *               des Eingabebildes gebracht)
+	 * 
+	 * @see setMask()
+	 */
+	void doConvolutionInTiles( const TiledImage<PTYPE> &input_image, TiledImage<PTYPE> &result );
+
+	/** Filterung(Faltung) eines Farbbildes in planarer Anordnung ausfhren.
+	 * 
+	 * Jeder Kanal (PlanarRgbImage::getChannel()) wird als Grauwertbild mit der vorher gesetzten 
+	 * Filtermaske gefaltet. Im Gegensatz zu Image<Rgb> werden die Kanle dabei mit den 
+	 * vektorisierten Schleifen fr Grauwertbilder bearbeitet.
+	 * 
+	 * @param input_image Eingabebild, das gefiltert werden soll
+	 * @param result Ergebnisbild (anderes Objekt als input_image, wird ggf. auf die Gre 
+	 *               des Eingabebildes gebracht)
+	 * 
+	 * @see setMask()
+	 */
+	void doConvolutionWithImage( const PlanarRgbImage<PTYPE> &input_image, PlanarRgbImage<PTYPE> &result );
+
 
 
 	/** Erzeugt und setzt die Maske eines (quadratischen) Boxfilters/Mittelwertfilter.
@@ -230,6 +280,119 @@ inline void SpatialFiltering<PTYPE,MASKTYPE>::doConvolutionWithImage( const Imag
 
 
 
+/* *********************************************************************************** */
+/* Faltung mit Eingabebild zeilenbandweise ausfhren. */
+template <typename PTYPE, typename MASKTYPE> 
+void SpatialFiltering<PTYPE,MASKTYPE>::doConvolutionInBands( const Image<PTYPE> &input_image, Image<PTYPE> &result, int band_height )
+/* *********************************************************************************** */
+{
+	if ( !m_filter_mask_available )
+	{
+		gerr << "Fehler in SpatialFiltering<PTYPE>::doConvolutionInBands( const Image<PTYPE> &input_image, Image<PTYPE> &result, int band_height )" << endl;
+		gerr << "Filtermaske existiert nicht." << endl;
+		return;
+	}
+	
+	int img_width   = input_image.getWidth();
+	int img_height  = input_image.getHeight();
+	int mask_height = m_filter_mask.getHeight();
+	int above       = mask_height / 2;            // Zeilen der Maske oberhalb des Zentrums
+	int below       = mask_height - 1 - above;    // Zeilen der Maske unterhalb des Zentrums
+	
+	band_height = std::max( band_height, mask_height );
+	if ( img_height <= band_height )
+	{
+		doConvolution( input_image, m_filter_mask, result );
+		return;
+	}
+	
+	if ( (img_width!=result.getWidth()) || (img_height!=result.getHeight()) )
+		result.resize( img_width, img_height );
+	
+	Image<PTYPE> band_result;
+	for ( int y0=0; y0<img_height; y0+=band_height )
+	{
+		int y1 = std::min( y0 + band_height, img_height );
+		
+		// Eingabeband mit den Nachbarzeilen, die die Maske bentigt (mindestens Maskenhhe)
+		int in_y1 = std::min( img_height, y1 + below );
+		int in_y0 = std::max( 0, std::min( y0 - above, in_y1 - mask_height ) );
+		
+		ConstImageView<PTYPE> band_input( input_image, 0, in_y0, img_width, in_y1 - in_y0 );
+		doConvolution( band_input, m_filter_mask, band_result );
+		
+		// nur die Zeilen des Bandes bernehmen
+		ImageView<PTYPE> band_output( result, 0, y0, img_width, y1 - y0 );
+		band_output.copy( band_result, 0, y0 - in_y0, img_width, y1 - y0 );
+	}
+}
+
+
+
+/* *********************************************************************************** */
+/* Faltung eines gekachelten Bildes kachelweise ausfhren. */
+template <typename PTYPE, typename MASKTYPE> 
+void SpatialFiltering<PTYPE,MASKTYPE>::doConvolutionInTiles( const TiledImage<PTYPE> &input_image, TiledImage<PTYPE> &result )
+/* *********************************************************************************** */
+{
+	if ( !m_filter_mask_available || (&input_image==&result) )
+	{
+		gerr << "Fehler in SpatialFiltering<PTYPE>::doConvolutionInTiles( const TiledImage<PTYPE> &input_image, TiledImage<PTYPE> &result )" << endl;
+		if ( !m_filter_mask_available )
+			gerr << "Filtermaske existiert nicht." << endl;
+		else
+			gerr << "Eingabebild und Ergebnisbild mssen verschiedene Objekte sein." << endl;
+		return;
+	}
+	
+	int mask_width  = m_filter_mask.getWidth();
+	int mask_height = m_filter_mask.getHeight();
+	
+	result.resize( input_image.getWidth(), input_image.getHeight() );
+	if ( (result.getWidth()!=input_image.getWidth()) || (result.getHeight()!=input_image.getHeight()) )
+		return;
+	
+	// Rand der Kacheln: Nachbarpixel, die die Maske links/oben bzw. rechts/unten vom Zentrum bentigt
+	typename TiledImage<PTYPE>::TileIterator tile( input_image, 
+	                                               mask_width / 2, mask_height / 2, 
+	                                               mask_width - 1 - mask_width / 2, mask_height - 1 - mask_height / 2 );
+	Image<PTYPE> tile_result;
+	for ( ; tile.isValid(); tile.doNext() )
+	{
+		doConvolution( tile.getInput(), m_filter_mask, tile_result );
+		
+		// nur die Pixel der Kachel bernehmen
+		result.copyFrom( ImageView<PTYPE>( tile_result, tile.getOffsetX(), tile.getOffsetY(), tile.getWidth(), tile.getHeight() ), 
+		                 tile.getX0(), tile.getY0() );
+	}
+}
+
+
+
+/* *********************************************************************************** */
+/* Faltung eines Farbbildes in planarer Anordnung kanalweise ausfhren. */
+template <typename PTYPE, typename MASKTYPE> 
+void SpatialFiltering<PTYPE,MASKTYPE>::doConvolutionWithImage( const PlanarRgbImage<PTYPE> &input_image, PlanarRgbImage<PTYPE> &result )
+/* *********************************************************************************** */
+{
+	if ( !m_filter_mask_available || (&input_image==&result) )
+	{
+		gerr << "Fehler in SpatialFiltering<PTYPE>::doConvolutionWithImage( const PlanarRgbImage<PTYPE> &input_image, PlanarRgbImage<PTYPE> &result )" << endl;
+		if ( !m_filter_mask_available )
+			gerr << "Filtermaske existiert nicht." << endl;
+		else
+			gerr << "Eingabebild und Ergebnisbild mssen verschiedene Objekte sein." << endl;
+		return;
+	}
+	
+	// die Kanle des Ergebnisses zeigen in dessen Speicher, daher vorher die Gre setzen
+	result.resize( input_image.getWidth(), input_image.getHeight() );
+	for ( int channel=0; channel<3; ++channel )
+		doConvolution( input_image.getChannel( channel ), m_filter_mask, result.getChannel( channel ) );
+}
+
+
+
 /* *********************************************************************************** */
 template <typename PTYPE, typename MASKTYPE> 
 SpatialFiltering<PTYPE,MASKTYPE>::SpatialFiltering() :
@@ -311,6 +474,66 @@ inline Rgb helpfunc_multiply( Rgb & val1,float val2  )
 	return res;
 }
 
+/* *********************************************************************************** */
+/* Faltung mit Akkumulation im Akkumulatortyp von PixelTraits (nur der innere Bereich, 
+ * die Randbehandlung fhrt doConvolution() durch). Die Zeilen des Eingabebildes werden 
+ * zeilenweise in den Akkumulatortyp gewandelt, jedes Ergebnispixel wird nur einmal gerundet 
+ * und gesttigt. Wird nur fr Typen mit breiterem Akkumulator (PixelTraits::WIDENED) 
+ * instanziiert. */
+template <int WIDENED> 
+struct helpstruct_convolution_widened
+{
+	template <typename PTYPE, typename MASKTYPE> 
+	static inline bool doConvolution( const Image<PTYPE> &, const Image<MASKTYPE> &, Image<PTYPE> & )
+	{
+		return false;
+	}
+};
+
+template <> 
+struct helpstruct_convolution_widened<1>
+{
+	template <typename PTYPE, typename MASKTYPE> 
+	static bool doConvolution( const Image<PTYPE> &input_image, const Image<MASKTYPE> &filter_mask, Image<PTYPE> &result )
+	{
+		typedef typename PixelTraits<PTYPE>::Accumulator Accumulator;
+		
+		int mask_width  = filter_mask.getWidth();
+		int mask_height = filter_mask.getHeight();
+		int img_width   = input_image.getWidth();
+		int width  = img_width - mask_width + 1;                 // Breite des zu berechnenden Bereichs
+		int height = input_image.getHeight() - mask_height + 1;  // Hoehe des zu berechnenden Bereichs
+		
+		Image<Accumulator> input_row( img_width, 1 );
+		Image<Accumulator> sum( width, 1 );
+		Accumulator *inp = input_row.getData();
+		Accumulator *res = sum.getData();
+		
+		for ( int y=0; y<height; ++y )
+		{
+			for ( int mask_y=0; mask_y<mask_height; ++mask_y )
+			{
+				ImageArithmetic::doWiden( inp, input_image.getRow( y + mask_y ), img_width );
+				
+				// gespiegelte Maske (wie doConvolution())
+				MASKTYPE *mask_row = filter_mask.getRow( mask_height - 1 - mask_y ) + mask_width - 1;
+				for ( int mask_x=0; mask_x<mask_width; ++mask_x )
+				{
+					float mvalue = (float) *( mask_row - mask_x );
+					if ( (mask_y==0) && (mask_x==0) )
+						for ( int x=0; x<width; ++x )
+							res[x] = inp[x] * mvalue;
+					else
+						for ( int x=0; x<width; ++x )
+							res[x] += inp[x + mask_x] * mvalue;
+				}
+			}
+			ImageArithmetic::doNarrow( result.getRow( y + mask_height/2 ) + mask_width/2, res, width );
+		}
+		return true;
+	}
+};
+
 /* *********************************************************************************** */
 /* Implementation der Faltung. */
 template <typename PTYPE, typename MASKTYPE> 
@@ -339,14 +562,28 @@ void SpatialFiltering<PTYPE,MASKTYPE>::doConvolution( const Image<PTYPE> &input_
 	{
 		result.resize( img_width, img_height );
 	}
+	
+	//
+	// Typen mit breiterem Akkumulator (z.B. uchar, Rgb, half): im Akkumulator summieren
+	//
+	if ( helpstruct_convolution_widened<PixelTraits<PTYPE>::WIDENED>::doConvolution( input_image, filter_mask, result ) )
+	{
+		doBoundaryCalculations( input_image, filter_mask, result );
+		return;
+	}
 
 	//
 	// Datenzeiger holen (um die Filtermaske (mask_data) zu spiegeln,
 	// werden ihre Daten einfach rckwrts durchlaufen!)
 	//
-	MASKTYPE* mask_data   = filter_mask.getData() + filter_mask.getSize() - 1;
+	MASKTYPE* mask_data   = filter_mask.getRow( mask_height-1 ) + mask_width - 1;
 	PTYPE* inp_data   = input_image.getData();
 	PTYPE* res_data  = result.getData();
+	
+	// Zeilenabstnde (siehe Image::getStride())
+	int mask_stride = filter_mask.getStride();
+	int inp_stride  = input_image.getStride();
+	int res_stride  = result.getStride();
 
 
 	
@@ -355,7 +592,7 @@ void SpatialFiltering<PTYPE,MASKTYPE>::doConvolution( const Image<PTYPE> &input_
 	//
 	int start_posx = mask_width / 2;
 	int start_posy = mask_height / 2;
-	res_data += start_posy*img_width + start_posx;
+	res_data += start_posy*res_stride + start_posx;
 
 	int width  = img_width - mask_width + 1;   // Breite des zu berechnenden Bereichs
 	int height = img_height - mask_height + 1; // Hoehe des zu berechnenden Bereichs
@@ -375,10 +612,10 @@ void SpatialFiltering<PTYPE,MASKTYPE>::doConvolution( const Image<PTYPE> &input_
 		// Datenzeiger auf aktuellen Zeilenanfang initialisieren und 
 		// Zeilenanfangszeiger auf nchste Zeile verschieben
 		inp = inp_line;
-		inp_line += img_width;
+		inp_line += inp_stride;
 		
 		res = res_line;
-		res_line += img_width;
+		res_line += res_stride;
 		
 		// Zeile berechnen
 		for ( int x=0; x<width; ++x )
@@ -405,10 +642,10 @@ void SpatialFiltering<PTYPE,MASKTYPE>::doConvolution( const Image<PTYPE> &input_
 			// Datenzeiger auf aktuellen Zeilenanfang initialisieren und 
 			// Zeilenanfangszeiger auf nchste Zeile verschieben
 			inp = inp_line;
-			inp_line += img_width;
+			inp_line += inp_stride;
 			
 			res = res_line;
-			res_line += img_width;
+			res_line += res_stride;
 			
 			// Zeile berechnen
 			for ( int x=0; x<width; ++x )
@@ -429,8 +666,8 @@ void SpatialFiltering<PTYPE,MASKTYPE>::doConvolution( const Image<PTYPE> &input_
 		// in Maske eine Zeile weiter gehen (wegen Spiegelung der Maske 
 		// wird der Maskenzeiger eine Zeile rckwrts und der Bildzeiger eine
 		// Zeile vorwrts gesetzt)
-		mask_data -= mask_width;
-		inp_data  += img_width;
+		mask_data -= mask_stride;
+		inp_data  += inp_stride;
 		
 		// komplette Maskenzeile berechnen
 		for ( int mask_x=0; mask_x<mask_width; ++mask_x )
@@ -446,10 +683,10 @@ void SpatialFiltering<PTYPE,MASKTYPE>::doConvolution( const Image<PTYPE> &input_
 				// Datenzeiger auf aktuellen Zeilenanfang initialisieren und 
 				// Zeilenanfangszeiger auf nchste Zeile verschieben
 				inp = inp_line;
-				inp_line += img_width;
+				inp_line += inp_stride;
 				
 				res = res_line;
-				res_line += img_width;
+				res_line += res_stride;
 				
 				// Zeile berechnen
 				for ( int x=0; x<width; ++x )
@@ -486,8 +723,8 @@ void SpatialFiltering<PTYPE,MASKTYPE>::doBoundaryCalculations( const Image<PTYPE
 	
 	int    img_width  	= input_image.getWidth();
 	int    img_height 	= input_image.getHeight();
-	PTYPE* inp 			= input_image.getData();
-	PTYPE* res 	 		= result.getData();
+	PTYPE* inp;
+	PTYPE* res;
 	
 	//
 	// Randgroessen berechnen
@@ -505,16 +742,23 @@ void SpatialFiltering<PTYPE,MASKTYPE>::doBoundaryCalculations( const Image<PTYPE
 	//
 	
 	// oberer Rand
-	int size = img_width * bsize_up;
-	for ( int i=0; i<size; ++i)
+	for ( int y=0; y<bsize_up; ++y )
 	{
-		*(res++) = *(inp++);
+		inp = input_image.getRow( y );
+		res = result.getRow( y );
+		for ( int x=0; x<img_width; ++x )
+		{
+			*(res++) = *(inp++);
+		}
 	}
 	
 	// linker Rand und rechter Rand 
 	// (von Ende oberer Rand bis Ansatz unterer Rand)
 	for ( int y=0; y<height; ++y )
 	{
+		inp = input_image.getRow( bsize_up + y );
+		res = result.getRow( bsize_up + y );
+		
 		//linker Rand dieser Zeile
 		for ( int x=0; x<bsize_left; ++x )
 		{
@@ -533,10 +777,14 @@ void SpatialFiltering<PTYPE,MASKTYPE>::doBoundaryCalculations( const Image<PTYPE
 	}
 	
 	//unterer Rand
-	size = img_width * bsize_down;
-	for ( int i=0; i<size; ++i)
+	for ( int y=img_height-bsize_down; y<img_height; ++y )
 	{
-		*(res++) = *(inp++);
+		inp = input_image.getRow( y );
+		res = result.getRow( y );
+		for ( int x=0; x<img_width; ++x )
+		{
+			*(res++) = *(inp++);
+		}
 	}
 }
 
@@ -0,0 +1,501 @@
+#pragma once
+
+#include "image.h"
+#include "sharedimage.h"
+
+#include <stddef.h>
+#include <string.h>
+#include <list>
+#include <map>
+#include <vector>
+
+#if __cplusplus >= 201103L
+#include <mutex>
+#define GET_SPECTRUMCACHE_LOCKING
+#endif
+
+namespace GET
+{
+
+	/** LRU cache for filter masks (transfer functions) in the frequency domain.
+	 *
+	 * Computing a filter mask (e.g. a Butterworth lowpass or the Fourier transform of a
+	 * spatial filter mask) costs at least one full pass over the image with expensive
+	 * operations per pixel. If the same few filters are applied to many images, the masks
+	 * can be taken from this cache instead.
+	 *
+	 * A mask is identified by a Key consisting of the filter type, its parameters and the mask
+	 * size. The key of the Fourier transform of a spatial filter mask refers to the pixels of the
+	 * spatial mask and contains a hash of them. Only the cache keeps a copy of the pixels (one
+	 * per entry), so that masks with the same hash are told apart by comparing all pixels.
+	 *
+	 * The cached masks are stored as SharedImage: a lookup into a SharedImage shares the cached
+	 * mask without copying it.
+	 *
+	 * The total memory of all cached masks is limited to a capacity given in bytes. If a new
+	 * mask does not fit, the least recently used masks are removed from the cache. The
+	 * numbers of hits and misses are counted to judge the benefit of the cache.
+	 *
+	 * If compiled with C++11, all methods are thread-safe, so one cache can be shared by
+	 * several filter objects (see getSharedCache()).
+	 *
+	 * @param MASKTYPE base data type of the cached filter masks
+	 *
+	 * @see FrequencyDomainFilteringBaseTemplate::setButterworthLowpassMask( float, int, int, int, SpectrumCache<MASKTYPE>& )
+	 * @see FrequencyDomainFiltering::setSpatialMask( const Image<Complex>&, SpectrumCache<Complex>& )
+	 */
+	template <typename MASKTYPE>
+	class SpectrumCache
+	{
+	public:
+		/** Filter types whose masks can be cached */
+		enum FilterType
+		{
+			IDEAL_LOWPASS,		  ///< ideal lowpass (d0)
+			IDEAL_HIGHPASS,		  ///< ideal highpass (d0)
+			BUTTERWORTH_LOWPASS,  ///< Butterworth lowpass (d0, n)
+			BUTTERWORTH_HIGHPASS, ///< Butterworth highpass (d0, n)
+			SPATIAL_MASK		  ///< Fourier transform of a spatial filter mask (pixels)
+		};
+
+		/** Identifies a cached filter mask.
+		 *
+		 * The key of a spatial filter mask refers to the pixels of the mask (see makeSpatialKey()),
+		 * so it may only be used as long as the mask exists and is not changed.
+		 */
+		struct Key
+		{
+			int type;						///< filter type (FilterType)
+			float d0;						///< cutoff frequency
+			int n;							///< order of the filter
+			int width;						///< width of the mask
+			int height;						///< height of the mask
+			unsigned long long hash;		///< hash of all other members and the pixels
+			const unsigned char *pixels;	///< first row of the spatial filter mask (SPATIAL_MASK only, otherwise NULL)
+			size_t row_size;				///< size of a row of the spatial filter mask in bytes
+			size_t row_pitch;				///< distance between the beginnings of two rows in bytes
+		};
+
+	private:
+		/** Cached mask together with its key */
+		struct Entry
+		{
+			Key key;						   ///< key, pixels refers to the member pixels
+			std::vector<unsigned char> pixels;	///< copy of the pixels of the spatial filter mask (rows without gaps)
+			SharedImage<MASKTYPE> mask;		   ///< cached mask
+		};
+
+		/** Cached masks, the most recently used mask first */
+		std::list<Entry> m_entries;
+
+		/** Index for finding the entry of a key in m_entries (by Key::hash, compared with the key of the entry) */
+		std::multimap<unsigned long long, typename std::list<Entry>::iterator> m_index;
+
+		/** Maximum memory of all cached masks in bytes */
+		size_t m_capacity;
+
+		/** Current memory of all cached masks in bytes */
+		size_t m_memory;
+
+		/** Number of successful lookups */
+		unsigned long m_hits;
+
+		/** Number of failed lookups */
+		unsigned long m_misses;
+
+#ifdef GET_SPECTRUMCACHE_LOCKING
+		/** Protects all members against concurrent access */
+		mutable std::mutex m_mutex;
+#endif
+
+		/** Locks the cache for the lifetime of the object (no locking without C++11) */
+		class Lock
+		{
+		public:
+#ifdef GET_SPECTRUMCACHE_LOCKING
+			inline explicit Lock(const SpectrumCache<MASKTYPE> &cache) : m_lock(cache.m_mutex){};
+
+		private:
+			std::lock_guard<std::mutex> m_lock;
+#else
+			inline explicit Lock(const SpectrumCache<MASKTYPE> &){};
+#endif
+		};
+
+	public:
+		/** Constructor.
+		 *
+		 * @param capacity maximum memory of all cached masks in bytes
+		 */
+		SpectrumCache(size_t capacity = 64 * 1024 * 1024);
+
+		/** Destructor. All cached masks are deleted. */
+		~SpectrumCache();
+
+		/** Returns the cache that is shared by all filter objects with masks of type MASKTYPE. */
+		static SpectrumCache<MASKTYPE> &getSharedCache();
+
+		/** Creates the key of a parametrised filter mask. */
+		static inline Key makeKey(FilterType type, float d0, int n, int width, int height);
+
+		/** Creates the key of the Fourier transform of a spatial filter mask.
+		 *
+		 * The key refers to the pixels of the mask (no copy) and contains a hash (FNV-1a) over them.
+		 */
+		template <typename SPATIALTYPE>
+		static Key makeSpatialKey(const Image<SPATIALTYPE> &spatial_mask);
+
+		/** Looks up a mask and shares it (no copy of the pixels).
+		 *
+		 * @param key key of the mask
+		 * @param mask object that shares the cached mask (only on a hit)
+		 * @return true, if the mask was in the cache
+		 */
+		bool doLookup(const Key &key, SharedImage<MASKTYPE> &mask);
+
+		/** Looks up a mask and copies it into an image.
+		 *
+		 * For images that must hold their own data (e.g. the filter mask of a filter object);
+		 * the copy does not allocate if mask already has the size of the cached mask.
+		 *
+		 * @param key key of the mask
+		 * @param mask Image-object into which the cached mask is copied (only on a hit)
+		 * @return true, if the mask was in the cache
+		 */
+		bool doLookup(const Key &key, Image<MASKTYPE> &mask);
+
+		/** Stores a mask in the cache, the cache shares it (no copy of the pixels).
+		 *
+		 * Least recently used masks are removed until the new mask fits into the capacity.
+		 * Masks that are larger than the capacity are not stored.
+		 *
+		 * @param key key of the mask
+		 * @param mask mask to be stored
+		 */
+		void doInsert(const Key &key, const SharedImage<MASKTYPE> &mask);
+
+		/** Stores a copy of a mask in the cache (see doInsert( const Key&, const SharedImage<MASKTYPE>& )). */
+		void doInsert(const Key &key, const Image<MASKTYPE> &mask);
+
+		/** Removes all masks from the cache (the counters are kept). */
+		void clear();
+
+		/** Sets the maximum memory of all cached masks in bytes. Masks are removed if necessary. */
+		void setCapacity(size_t capacity);
+
+		/** Returns the maximum memory of all cached masks in bytes. */
+		inline size_t getCapacity() const
+		{
+			Lock lock(*this);
+			return m_capacity;
+		};
+
+		/** Returns the current memory of all cached masks (and their keys) in bytes. */
+		inline size_t getMemoryUsage() const
+		{
+			Lock lock(*this);
+			return m_memory;
+		};
+
+		/** Returns the number of cached masks. */
+		inline int getEntries() const
+		{
+			Lock lock(*this);
+			return (int)m_index.size();
+		};
+
+		/** Returns the number of successful lookups. */
+		inline unsigned long getHits() const
+		{
+			Lock lock(*this);
+			return m_hits;
+		};
+
+		/** Returns the number of failed lookups. */
+		inline unsigned long getMisses() const
+		{
+			Lock lock(*this);
+			return m_misses;
+		};
+
+		/** Resets the hit and miss counters. */
+		inline void resetCounters()
+		{
+			Lock lock(*this);
+			m_hits = m_misses = 0;
+		};
+
+	private:
+		/** Removes least recently used masks until at most capacity bytes are used (m_mutex must be locked). */
+		void doEvict(size_t capacity);
+
+		/** Returns the entry of a key (m_entries.end(), if the key is not cached; m_mutex must be locked). */
+		typename std::list<Entry>::iterator doFind(const Key &key);
+
+		/** Returns true, if the key of an entry equals key (including all pixels). */
+		static bool isEqual(const Key &entry_key, const Key &key);
+
+		/** Memory of a cached mask and its key in bytes */
+		static inline size_t getMemory(const Image<MASKTYPE> &mask, const Key &key)
+		{
+			return (size_t)mask.getSize() * sizeof(MASKTYPE) + key.row_size * (key.pixels ? key.height : 0);
+		};
+
+		/** Continues a hash (FNV-1a) with size bytes. */
+		static inline unsigned long long doHash(unsigned long long hash, const void *data, size_t size)
+		{
+			const unsigned char *bytes = (const unsigned char *)data;
+			for (size_t i = 0; i < size; ++i)
+			{
+				hash ^= bytes[i];
+				hash *= 1099511628211ULL;
+			}
+			return hash;
+		};
+
+		/** Copying a cache is not applicable. */
+		SpectrumCache(const SpectrumCache<MASKTYPE> &);
+		/** Assignment operator is not applicable. */
+		SpectrumCache<MASKTYPE> &operator=(const SpectrumCache<MASKTYPE> &);
+	};
+
+	/* ************************************************************************** */
+	/* *** Implementation of the templates ************************************** */
+	/* ************************************************************************** */
+
+	/* ************************************************************************** */
+	template <typename MASKTYPE>
+	SpectrumCache<MASKTYPE>::SpectrumCache(size_t capacity) : m_capacity(capacity),
+															  m_memory(0),
+															  m_hits(0),
+															  m_misses(0)
+	/* ************************************************************************** */
+	{
+	}
+
+	/* ************************************************************************** */
+	template <typename MASKTYPE>
+	SpectrumCache<MASKTYPE>::~SpectrumCache()
+	/* ************************************************************************** */
+	{
+		clear();
+	}
+
+	/* ************************************************************************** */
+	template <typename MASKTYPE>
+	SpectrumCache<MASKTYPE> &SpectrumCache<MASKTYPE>::getSharedCache()
+	/* ************************************************************************** */
+	{
+		static SpectrumCache<MASKTYPE> shared_cache;
+		return shared_cache;
+	}
+
+	/* ************************************************************************** */
+	template <typename MASKTYPE>
+	inline typename SpectrumCache<MASKTYPE>::Key SpectrumCache<MASKTYPE>::makeKey(FilterType type, float d0, int n, int width, int height)
+	/* ************************************************************************** */
+	{
+		Key key;
+		key.type = type;
+		key.d0 = d0;
+		key.n = n;
+		key.width = width;
+		key.height = height;
+		key.pixels = NULL;
+		key.row_size = 0;
+		key.row_pitch = 0;
+
+		unsigned long long hash = 14695981039346656037ULL;
+		hash = doHash(hash, &key.type, sizeof(key.type));
+		hash = doHash(hash, &key.d0, sizeof(key.d0));
+		hash = doHash(hash, &key.n, sizeof(key.n));
+		hash = doHash(hash, &key.width, sizeof(key.width));
+		key.hash = doHash(hash, &key.height, sizeof(key.height));
+		return key;
+	}
+
+	/* ************************************************************************** */
+	template <typename MASKTYPE>
+	template <typename SPATIALTYPE>
+	typename SpectrumCache<MASKTYPE>::Key SpectrumCache<MASKTYPE>::makeSpatialKey(const Image<SPATIALTYPE> &spatial_mask)
+	/* ************************************************************************** */
+	{
+		Key key = makeKey(SPATIAL_MASK, 0.0f, 0, spatial_mask.getWidth(), spatial_mask.getHeight());
+		if (spatial_mask.getSize() == 0)
+			return key;
+
+		// the pixels row by row (the rows of the mask may be padded)
+		key.pixels = (const unsigned char *)spatial_mask.getData();
+		key.row_size = (size_t)spatial_mask.getWidth() * sizeof(SPATIALTYPE);
+		key.row_pitch = (size_t)spatial_mask.getStride() * sizeof(SPATIALTYPE);
+		for (int y = 0; y < spatial_mask.getHeight(); ++y)
+			key.hash = doHash(key.hash, key.pixels + y * key.row_pitch, key.row_size);
+
+		return key;
+	}
+
+	/* ************************************************************************** */
+	template <typename MASKTYPE>
+	bool SpectrumCache<MASKTYPE>::doLookup(const Key &key, SharedImage<MASKTYPE> &mask)
+	/* ************************************************************************** */
+	{
+		Lock lock(*this);
+
+		typename std::list<Entry>::iterator entry = doFind(key);
+		if (entry == m_entries.end())
+		{
+			++m_misses;
+			return false;
+		}
+
+		// Mark as most recently used
+		m_entries.splice(m_entries.begin(), m_entries, entry);
+
+		mask = entry->mask;
+		++m_hits;
+		return true;
+	}
+
+	/* ************************************************************************** */
+	template <typename MASKTYPE>
+	bool SpectrumCache<MASKTYPE>::doLookup(const Key &key, Image<MASKTYPE> &mask)
+	/* ************************************************************************** */
+	{
+		// copied outside of the lock, the shared mask stays valid if it is evicted meanwhile
+		SharedImage<MASKTYPE> cached;
+		if (!doLookup(key, cached))
+			return false;
+
+		mask.copy(cached.getImage());
+		return true;
+	}
+
+	/* ************************************************************************** */
+	template <typename MASKTYPE>
+	void SpectrumCache<MASKTYPE>::doInsert(const Key &key, const SharedImage<MASKTYPE> &mask)
+	/* ************************************************************************** */
+	{
+		size_t memory = getMemory(mask.getImage(), key);
+
+		Lock lock(*this);
+
+		// Already cached (e.g. inserted by another thread in the meantime)
+		if (doFind(key) != m_entries.end())
+			return;
+
+		// Masks larger than the capacity are not cached at all
+		if (memory > m_capacity)
+			return;
+
+		doEvict(m_capacity - memory);
+
+		m_entries.push_front(Entry());
+		Entry &entry = m_entries.front();
+		entry.key = key;
+		entry.mask = mask;
+
+		// the only copy of the pixels of a spatial filter mask, without the gaps between the rows
+		if (key.pixels)
+		{
+			entry.pixels.resize(key.row_size * key.height);
+			for (int y = 0; y < key.height; ++y)
+				memcpy(&entry.pixels[y * key.row_size], key.pixels + y * key.row_pitch, key.row_size);
+			entry.key.pixels = &entry.pixels[0];
+			entry.key.row_pitch = key.row_size;
+		}
+
+		m_index.insert(std::make_pair(key.hash, m_entries.begin()));
+		m_memory += memory;
+	}
+
+	/* ************************************************************************** */
+	template <typename MASKTYPE>
+	void SpectrumCache<MASKTYPE>::doInsert(const Key &key, const Image<MASKTYPE> &mask)
+	/* ************************************************************************** */
+	{
+		doInsert(key, SharedImage<MASKTYPE>(mask));
+	}
+
+	/* ************************************************************************** */
+	template <typename MASKTYPE>
+	typename std::list<typename SpectrumCache<MASKTYPE>::Entry>::iterator SpectrumCache<MASKTYPE>::doFind(const Key &key)
+	/* ************************************************************************** */
+	{
+		typedef typename std::multimap<unsigned long long, typename std::list<Entry>::iterator>::iterator IndexIterator;
+
+		std::pair<IndexIterator, IndexIterator> range = m_index.equal_range(key.hash);
+		for (IndexIterator it = range.first; it != range.second; ++it)
+		{
+			if (isEqual(it->second->key, key))
+				return it->second;
+		}
+		return m_entries.end();
+	}
+
+	/* ************************************************************************** */
+	template <typename MASKTYPE>
+	bool SpectrumCache<MASKTYPE>::isEqual(const Key &entry_key, const Key &key)
+	/* ************************************************************************** */
+	{
+		if ((entry_key.type != key.type) || (entry_key.d0 != key.d0) || (entry_key.n != key.n) ||
+			(entry_key.width != key.width) || (entry_key.height != key.height) || (entry_key.hash != key.hash) ||
+			(entry_key.row_size != key.row_size) || ((entry_key.pixels == NULL) != (key.pixels == NULL)))
+			return false;
+
+		if (key.pixels)
+		{
+			for (int y = 0; y < key.height; ++y)
+			{
+				if (memcmp(entry_key.pixels + y * entry_key.row_pitch, key.pixels + y * key.row_pitch, key.row_size) != 0)
+					return false;
+			}
+		}
+		return true;
+	}
+
+	/* ************************************************************************** */
+	template <typename MASKTYPE>
+	void SpectrumCache<MASKTYPE>::clear()
+	/* ************************************************************************** */
+	{
+		Lock lock(*this);
+		doEvict(0);
+	}
+
+	/* ************************************************************************** */
+	template <typename MASKTYPE>
+	void SpectrumCache<MASKTYPE>::setCapacity(size_t capacity)
+	/* ************************************************************************** */
+	{
+		Lock lock(*this);
+		m_capacity = capacity;
+		doEvict(capacity);
+	}
+
+	/* ************************************************************************** */
+	template <typename MASKTYPE>
+	void SpectrumCache<MASKTYPE>::doEvict(size_t capacity)
+	/* ************************************************************************** */
+	{
+		while (((m_memory > capacity) || (capacity == 0)) && !m_entries.empty())
+		{
+			typedef typename std::multimap<unsigned long long, typename std::list<Entry>::iterator>::iterator IndexIterator;
+
+			typename std::list<Entry>::iterator entry = --m_entries.end();
+			m_memory -= getMemory(entry->mask.getImage(), entry->key);
+
+			std::pair<IndexIterator, IndexIterator> range = m_index.equal_range(entry->key.hash);
+			for (IndexIterator it = range.first; it != range.second; ++it)
+			{
+				if (it->second == entry)
+				{
+					m_index.erase(it);
+					break;
+				}
+			}
+
+			m_entries.pop_back();
+		}
+	}
+
+} /* namespace GET */
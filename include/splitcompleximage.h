@@ -0,0 +1,328 @@
+#pragma once
+
+#include "image.h"
+#include "imagereference.h"
+#include "complex.h"
+#include "gexception.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace GET
+{
+
+	/** Complex image with separate planes for the real and the imaginary parts (split layout).
+	 *
+	 * Image<Complex> stores real and imaginary part of each pixel next to each other
+	 * (interleaved layout). Operations that treat both parts differently (complex
+	 * multiplication, magnitude, butterflies of the FFT) then need shuffles to separate them
+	 * before SIMD instructions can be used. In the split layout all real parts and all
+	 * imaginary parts are stored in two planes of type float, so that these operations can
+	 * process 4 (SSE) or 8 (AVX) pixels per instruction without any shuffles.
+	 *
+	 * Both planes are available as Image<float> (getReal(), getImag()) without copying, i.e.
+	 * all algorithms for real images can be applied to them directly. The other way round, a
+	 * split complex image can refer to two existing Image<float> planes without copying them
+	 * (see SplitComplexImage(Image<float>&, Image<float>&)); e.g. the real part of a filter result can
+	 * be used without any conversion.
+	 *
+	 * A conversion between the split layout and Image<Complex> (copy(), copyTo()) always needs
+	 * one pass over the data, since the memory layouts differ. It is only needed at the
+	 * boundaries of processing chains working on the split layout.
+	 *
+	 * @see SplitFFT
+	 * @see Conversions::doComplex2Magnitude( const SplitComplexImage&, Image<float>& )
+	 * @see FrequencyDomainFilteringBaseTemplate::doConvolutionWithImage( const SplitComplexImage&, SplitComplexImage& )
+	 */
+	class SplitComplexImage
+	{
+	private:
+		/** Memory of both planes (real parts in the upper half, imaginary parts in the lower half) */
+		Image<float> m_storage;
+
+		/** true, if the planes are stored in m_storage (false: the planes refer to external images) */
+		bool m_data_owner;
+
+		/** Real parts */
+		ImageReference<float> m_real;
+
+		/** Imaginary parts */
+		ImageReference<float> m_imag;
+
+		/** Copy constructor is private and must not be used. */
+		SplitComplexImage(const SplitComplexImage &);
+
+		/** Assignment operator is private and must not be used. */
+		SplitComplexImage &operator=(const SplitComplexImage &);
+
+	public:
+		/** Constructor.
+		 *
+		 * @param width width of the image
+		 * @param height height of the image
+		 */
+		inline SplitComplexImage(int width = 0, int height = 0);
+
+		/** Constructor for a split complex image referring to existing planes (no copy).
+		 *
+		 * The planes are neither copied nor freed by this object and must exist as long as
+		 * this object is used. Changes of the pixels of this object change the given images.
+		 * resize() is only allowed if the size does not change.
+		 *
+		 * @param real real parts (packed layout, see Image::isPacked())
+		 * @param imag imaginary parts (same size and layout as real)
+		 */
+		inline SplitComplexImage(Image<float> &real, Image<float> &imag);
+
+		/** Constructor converting an image in interleaved layout.
+		 *
+		 * @param image complex image to be copied
+		 */
+		inline explicit SplitComplexImage(const Image<Complex> &image);
+
+		/** Returns the width of the image. */
+		inline int getWidth() const { return m_real.getWidth(); };
+
+		/** Returns the height of the image. */
+		inline int getHeight() const { return m_real.getHeight(); };
+
+		/** Returns the number of pixels of the image. */
+		inline PixelIndex getSize() const { return m_real.getSize(); };
+
+		/** Returns the plane with the real parts. */
+		inline Image<float> &getReal() { return m_real; };
+
+		/** Returns the plane with the real parts. */
+		inline const Image<float> &getReal() const { return m_real; };
+
+		/** Returns the plane with the imaginary parts. */
+		inline Image<float> &getImag() { return m_imag; };
+
+		/** Returns the plane with the imaginary parts. */
+		inline const Image<float> &getImag() const { return m_imag; };
+
+		/** Resize image.
+		 *
+		 * The image data will be lost (see Image::resize()).
+		 *
+		 * @param width new width of the image
+		 * @param height new height of the image
+		 */
+		inline void resize(int width, int height);
+
+		/** Sets all pixels to the given value.
+		 *
+		 * @param re real part
+		 * @param im imaginary part
+		 */
+		inline void fill(float re, float im = 0.0f);
+
+		/** Copies a split complex image.
+		 *
+		 * @param image image to be copied
+		 * @return this object
+		 */
+		inline SplitComplexImage &copy(const SplitComplexImage &image);
+
+		/** Copies an image in interleaved layout into the split layout.
+		 *
+		 * @param image image to be copied
+		 * @return this object
+		 */
+		inline SplitComplexImage &copy(const Image<Complex> &image);
+
+		/** Copies a real image (the imaginary parts are set to 0).
+		 *
+		 * @param image image to be copied
+		 * @return this object
+		 */
+		inline SplitComplexImage &copy(const Image<float> &image);
+
+		/** Copies this image into an image in interleaved layout.
+		 *
+		 * @param image image the pixels of this image are copied to (resized if necessary)
+		 */
+		inline void copyTo(Image<Complex> &image) const;
+	};
+
+	/* ************************************************************************** */
+	/* *** Implementation of the inline methods ********************************* */
+	/* ************************************************************************** */
+
+	/* ************************************************************************** */
+	inline SplitComplexImage::SplitComplexImage(int width, int height) : m_storage(width, 2 * height),
+																		 m_data_owner(true),
+																		 m_real(width, height, m_storage.getData()),
+																		 m_imag(width, height, m_storage.getData() + (PixelIndex)width * height)
+	/* ************************************************************************** */
+	{
+	}
+
+	/* ************************************************************************** */
+	inline SplitComplexImage::SplitComplexImage(Image<float> &real, Image<float> &imag) : m_storage(0, 0),
+																						   m_data_owner(false),
+																						   m_real(real.getWidth(), real.getHeight(), real.getData()),
+																						   m_imag(imag.getWidth(), imag.getHeight(), imag.getData())
+	/* ************************************************************************** */
+	{
+		if ((real.getWidth() != imag.getWidth()) || (real.getHeight() != imag.getHeight()))
+		{
+			throw GException(
+				"SplitComplexImage::SplitComplexImage( Image<float> &real, Image<float> &imag )",
+				"Real and imaginary plane must be the same size.");
+		}
+		if (!real.isPacked() || !imag.isPacked())
+		{
+			throw GException(
+				"SplitComplexImage::SplitComplexImage( Image<float> &real, Image<float> &imag )",
+				"Real and imaginary plane must be packed (Image::isPacked()).");
+		}
+	}
+
+	/* ************************************************************************** */
+	inline SplitComplexImage::SplitComplexImage(const Image<Complex> &image) : m_storage(image.getWidth(), 2 * image.getHeight()),
+																				m_data_owner(true),
+																				m_real(image.getWidth(), image.getHeight(), m_storage.getData()),
+																				m_imag(image.getWidth(), image.getHeight(), m_storage.getData() + image.getSize())
+	/* ************************************************************************** */
+	{
+		copy(image);
+	}
+
+	/* ************************************************************************** */
+	inline void SplitComplexImage::resize(int width, int height)
+	/* ************************************************************************** */
+	{
+		if ((width == getWidth()) && (height == getHeight()))
+			return;
+
+		if (m_data_owner)
+		{
+			m_storage.resize(width, 2 * height);
+			m_real.setData(m_storage.getData(), width, height);
+			m_imag.setData(m_storage.getData() + (PixelIndex)width * height, width, height);
+		}
+		else if ((PixelIndex)width * height == getSize())
+		{
+			m_real.resize(width, height);
+			m_imag.resize(width, height);
+		}
+		else
+		{
+			// The planes belong to other images
+			gerr << "Runtime error in SplitComplexImage::resize( int width, int height )" << endl;
+			gerr << "The planes of this object refer to external images. ";
+			gerr << "For this reason, any resize() call that leads to a reallocation of memory is forbidden." << endl;
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void SplitComplexImage::fill(float re, float im)
+	/* ************************************************************************** */
+	{
+		m_real.fill(re);
+		m_imag.fill(im);
+	}
+
+	/* ************************************************************************** */
+	inline SplitComplexImage &SplitComplexImage::copy(const SplitComplexImage &image)
+	/* ************************************************************************** */
+	{
+		if (&image != this)
+		{
+			resize(image.getWidth(), image.getHeight());
+			std::copy(image.m_real.getData(), image.m_real.getData() + getSize(), m_real.getData());
+			std::copy(image.m_imag.getData(), image.m_imag.getData() + getSize(), m_imag.getData());
+		}
+		return *this;
+	}
+
+	/* ************************************************************************** */
+	inline SplitComplexImage &SplitComplexImage::copy(const Image<Complex> &image)
+	/* ************************************************************************** */
+	{
+		resize(image.getWidth(), image.getHeight());
+
+		// the planes are packed; a packed source is processed as a single row
+		int rows = image.isPacked() ? 1 : getHeight();
+		PixelIndex size = (rows == 1) ? getSize() : getWidth();
+
+		for (int y = 0; y < rows; ++y)
+		{
+			const float *source = (const float *)image.getRow(y);
+			float *re = m_real.getData() + y * size;
+			float *im = m_imag.getData() + y * size;
+			PixelIndex i = 0;
+
+#if defined(__SSE2__)
+			// Deinterleave 4 pixels: [r0 i0 r1 i1] [r2 i2 r3 i3] -> [r0 r1 r2 r3] [i0 i1 i2 i3]
+			for (; i + 4 <= size; i += 4)
+			{
+				__m128 low = _mm_loadu_ps(source + 2 * i);
+				__m128 high = _mm_loadu_ps(source + 2 * i + 4);
+				_mm_storeu_ps(re + i, _mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0)));
+				_mm_storeu_ps(im + i, _mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1)));
+			}
+#endif
+			for (; i < size; ++i)
+			{
+				re[i] = source[2 * i];
+				im[i] = source[2 * i + 1];
+			}
+		}
+
+		return *this;
+	}
+
+	/* ************************************************************************** */
+	inline SplitComplexImage &SplitComplexImage::copy(const Image<float> &image)
+	/* ************************************************************************** */
+	{
+		resize(image.getWidth(), image.getHeight());
+
+		m_real.copy(image);
+		m_imag.fill(0.0f);
+
+		return *this;
+	}
+
+	/* ************************************************************************** */
+	inline void SplitComplexImage::copyTo(Image<Complex> &image) const
+	/* ************************************************************************** */
+	{
+		if ((image.getWidth() != getWidth()) || (image.getHeight() != getHeight()))
+			image.resize(getWidth(), getHeight());
+
+		// the planes are packed; a packed destination is processed as a single row
+		int rows = image.isPacked() ? 1 : getHeight();
+		PixelIndex size = (rows == 1) ? getSize() : getWidth();
+
+		for (int y = 0; y < rows; ++y)
+		{
+			float *destination = (float *)image.getRow(y);
+			const float *re = m_real.getData() + y * size;
+			const float *im = m_imag.getData() + y * size;
+			PixelIndex i = 0;
+
+#if defined(__SSE2__)
+			// Interleave 4 pixels: [r0 r1 r2 r3] [i0 i1 i2 i3] -> [r0 i0 r1 i1] [r2 i2 r3 i3]
+			for (; i + 4 <= size; i += 4)
+			{
+				__m128 re4 = _mm_loadu_ps(re + i);
+				__m128 im4 = _mm_loadu_ps(im + i);
+				_mm_storeu_ps(destination + 2 * i, _mm_unpacklo_ps(re4, im4));
+				_mm_storeu_ps(destination + 2 * i + 4, _mm_unpackhi_ps(re4, im4));
+			}
+#endif
+			for (; i < size; ++i)
+			{
+				destination[2 * i] = re[i];
+				destination[2 * i + 1] = im[i];
+			}
+		}
+	}
+
+} /* namespace GET */
@@ -0,0 +1,365 @@
+#pragma once
+
+#include "dft.h"
+#include "splitcompleximage.h"
+#include "gexception.h"
+
+#include <math.h>
+#include <vector>
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace GET
+{
+
+	/** Fast Fourier transformation of complex images in split layout (SplitComplexImage).
+	 *
+	 * Radix-2 FFT for images whose width and height are powers of two (the image does not have
+	 * to be square). Frequencies, sign convention and scaling (see DFT::ScalingType) are the
+	 * same as for FFT, so the results can be mixed with the ones of FFT.
+	 *
+	 * The rows are transformed one after another. The columns are transformed by applying the
+	 * butterflies to whole rows: every butterfly of the column transformation combines two
+	 * rows with one twiddle factor, which is done for all columns at once with SIMD instructions
+	 * on contiguous memory (no transposition, no gathering of strided pixels). Since real and
+	 * imaginary parts are stored in separate planes, no shuffles are needed.
+	 *
+	 * The twiddle factors are computed once per image size and kept in this object, so one
+	 * object should be used per thread.
+	 *
+	 * @see SplitComplexImage
+	 * @see FFT
+	 */
+	class SplitFFT : public DFT
+	{
+	private:
+		/** Twiddle factors and bit reversal permutation of one transformation size */
+		struct Twiddles
+		{
+			/** size of the transformation */
+			int size;
+			/** cos(2*pi*k/size), k = 0 ... size/2-1 */
+			std::vector<float> cos_table;
+			/** sin(2*pi*k/size), k = 0 ... size/2-1 */
+			std::vector<float> sin_table;
+			/** bit reversed index of k, k = 0 ... size-1 */
+			std::vector<int> bit_reversal;
+		};
+
+		/** Twiddle factors for the rows */
+		Twiddles m_row_twiddles;
+
+		/** Twiddle factors for the columns */
+		Twiddles m_column_twiddles;
+
+	public:
+		/** Constructor.
+		 *
+		 * @param scaling type of scaling
+		 */
+		SplitFFT(ScalingType scaling = SCALE_ON_TRANSFORMATION) : DFT(scaling)
+		{
+			m_row_twiddles.size = 0;
+			m_column_twiddles.size = 0;
+		};
+
+		/** Two-dimensional Fourier transformation (in place).
+		 *
+		 * @param image Input: image in position space, output: image in Fourier space
+		 */
+		inline void doFourierTransform2D(SplitComplexImage &image);
+
+		/** Two-dimensional Fourier transformation of a real image.
+		 *
+		 * The real image is copied into the real plane of fourier_image; no complex image in
+		 * interleaved layout is created.
+		 *
+		 * @param original_image Input - image in position space
+		 * @param fourier_image  Output - image in Fourier space
+		 */
+		inline void doFourierTransform2D(const Image<float> &original_image, SplitComplexImage &fourier_image);
+
+		/** Inverse two-dimensional Fourier transformation (in place).
+		 *
+		 * The real part of the result is available without copying via SplitComplexImage::getReal().
+		 *
+		 * @param image Input: image in Fourier space, output: image in position space
+		 */
+		inline void doInvFourierTransform2D(SplitComplexImage &image);
+
+		/** Nyquist modulation (centering in frequency space/position space).
+		 *
+		 * @see DFT::doNyquistModulation()
+		 */
+		inline void doNyquistModulation(SplitComplexImage &image)
+		{
+			DFT::doNyquistModulation(image.getReal());
+			DFT::doNyquistModulation(image.getImag());
+		};
+
+	private:
+		/** Transformation in both directions (sign: -1 forward, +1 inverse) */
+		inline void doTransform2D(SplitComplexImage &image, int sign);
+
+		/** Computes the twiddle factors of a transformation size (if not done before) */
+		static inline void doComputeTwiddles(int size, Twiddles &twiddles);
+
+		/** One-dimensional FFT of one row */
+		static inline void doTransformRow(float *re, float *im, const Twiddles &twiddles, int sign);
+
+		/** Butterfly of two whole rows p and q with the twiddle factor w:
+		 *
+		 *   t = w * q,  q = p - t,  p = p + t
+		 */
+		static inline void doRowButterfly(float *p_re, float *p_im, float *q_re, float *q_im, float w_re, float w_im, int width);
+
+		/** Multiplies both planes with factor */
+		static inline void doScale(SplitComplexImage &image, float factor);
+	};
+
+	/* ************************************************************************** */
+	/* *** Implementation of the inline methods ********************************* */
+	/* ************************************************************************** */
+
+	/* ************************************************************************** */
+	inline void SplitFFT::doFourierTransform2D(SplitComplexImage &image)
+	/* ************************************************************************** */
+	{
+		doTransform2D(image, -1);
+
+		switch (getScaling())
+		{
+		case NOSCALING:
+		case SCALE_ON_RETRANSFORMATION:
+			break;
+		case SYMMETRICAL_SCALING:
+			doScale(image, 1.0f / sqrtf(image.getSize()));
+			break;
+		case SCALE_ON_TRANSFORMATION:
+			doScale(image, 1.0f / image.getSize());
+			break;
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void SplitFFT::doFourierTransform2D(const Image<float> &original_image, SplitComplexImage &fourier_image)
+	/* ************************************************************************** */
+	{
+		fourier_image.copy(original_image);
+		doFourierTransform2D(fourier_image);
+	}
+
+	/* ************************************************************************** */
+	inline void SplitFFT::doInvFourierTransform2D(SplitComplexImage &image)
+	/* ************************************************************************** */
+	{
+		doTransform2D(image, 1);
+
+		switch (getScaling())
+		{
+		case NOSCALING:
+		case SCALE_ON_TRANSFORMATION:
+			break;
+		case SYMMETRICAL_SCALING:
+			doScale(image, 1.0f / sqrtf(image.getSize()));
+			break;
+		case SCALE_ON_RETRANSFORMATION:
+			doScale(image, 1.0f / image.getSize());
+			break;
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void SplitFFT::doTransform2D(SplitComplexImage &image, int sign)
+	/* ************************************************************************** */
+	{
+		int width = image.getWidth();
+		int height = image.getHeight();
+
+		if ((width <= 0) || (height <= 0) || (width & (width - 1)) || (height & (height - 1)))
+		{
+			throw GException(
+				"SplitFFT::doTransform2D( SplitComplexImage &image, int sign )",
+				"Width and height of the image must be powers of two.");
+		}
+
+		doComputeTwiddles(width, m_row_twiddles);
+		doComputeTwiddles(height, m_column_twiddles);
+
+		float *re = image.getReal().getData();
+		float *im = image.getImag().getData();
+
+		//
+		// Transform the rows
+		//
+		if (width > 1)
+		{
+			for (int y = 0; y < height; ++y)
+				doTransformRow(re + y * width, im + y * width, m_row_twiddles, sign);
+		}
+
+		//
+		// Transform the columns: bit reversal of the rows and butterflies of whole rows
+		//
+		const std::vector<int> &bit_reversal = m_column_twiddles.bit_reversal;
+		for (int y = 0; y < height; ++y)
+		{
+			int partner = bit_reversal[y];
+			if (partner > y)
+			{
+				std::swap_ranges(re + y * width, re + (y + 1) * width, re + partner * width);
+				std::swap_ranges(im + y * width, im + (y + 1) * width, im + partner * width);
+			}
+		}
+
+		for (int length = 2; length <= height; length *= 2)
+		{
+			int half = length / 2;
+			int step = height / length;
+			for (int start = 0; start < height; start += length)
+			{
+				for (int k = 0; k < half; ++k)
+				{
+					int p = (start + k) * width;
+					int q = (start + k + half) * width;
+					doRowButterfly(re + p, im + p, re + q, im + q, m_column_twiddles.cos_table[k * step], sign * m_column_twiddles.sin_table[k * step], width);
+				}
+			}
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void SplitFFT::doComputeTwiddles(int size, Twiddles &twiddles)
+	/* ************************************************************************** */
+	{
+		if (twiddles.size == size)
+			return;
+
+		twiddles.size = size;
+		twiddles.cos_table.resize(size / 2);
+		twiddles.sin_table.resize(size / 2);
+		for (int k = 0; k < size / 2; ++k)
+		{
+			double angle = 2.0 * M_PI * k / size;
+			twiddles.cos_table[k] = (float)cos(angle);
+			twiddles.sin_table[k] = (float)sin(angle);
+		}
+
+		int bits = 0;
+		while ((1 << bits) < size)
+			++bits;
+
+		twiddles.bit_reversal.resize(size);
+		for (int k = 0; k < size; ++k)
+		{
+			int reversed = 0;
+			for (int b = 0; b < bits; ++b)
+				if (k & (1 << b))
+					reversed |= 1 << (bits - 1 - b);
+			twiddles.bit_reversal[k] = reversed;
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void SplitFFT::doTransformRow(float *re, float *im, const Twiddles &twiddles, int sign)
+	/* ************************************************************************** */
+	{
+		int size = twiddles.size;
+
+		for (int k = 0; k < size; ++k)
+		{
+			int partner = twiddles.bit_reversal[k];
+			if (partner > k)
+			{
+				std::swap(re[k], re[partner]);
+				std::swap(im[k], im[partner]);
+			}
+		}
+
+		for (int length = 2; length <= size; length *= 2)
+		{
+			int half = length / 2;
+			int step = size / length;
+			for (int start = 0; start < size; start += length)
+			{
+				float *p_re = re + start;
+				float *p_im = im + start;
+				float *q_re = p_re + half;
+				float *q_im = p_im + half;
+				for (int k = 0; k < half; ++k)
+				{
+					float w_re = twiddles.cos_table[k * step];
+					float w_im = sign * twiddles.sin_table[k * step];
+					float t_re = q_re[k] * w_re - q_im[k] * w_im;
+					float t_im = q_re[k] * w_im + q_im[k] * w_re;
+					q_re[k] = p_re[k] - t_re;
+					q_im[k] = p_im[k] - t_im;
+					p_re[k] += t_re;
+					p_im[k] += t_im;
+				}
+			}
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void SplitFFT::doRowButterfly(float *p_re, float *p_im, float *q_re, float *q_im, float w_re, float w_im, int width)
+	/* ************************************************************************** */
+	{
+		int x = 0;
+
+#if defined(__AVX__)
+		__m256 w_re8 = _mm256_set1_ps(w_re);
+		__m256 w_im8 = _mm256_set1_ps(w_im);
+		for (; x + 8 <= width; x += 8)
+		{
+			__m256 qr = _mm256_loadu_ps(q_re + x);
+			__m256 qi = _mm256_loadu_ps(q_im + x);
+			__m256 pr = _mm256_loadu_ps(p_re + x);
+			__m256 pi = _mm256_loadu_ps(p_im + x);
+			__m256 tr = _mm256_sub_ps(_mm256_mul_ps(qr, w_re8), _mm256_mul_ps(qi, w_im8));
+			__m256 ti = _mm256_add_ps(_mm256_mul_ps(qr, w_im8), _mm256_mul_ps(qi, w_re8));
+			_mm256_storeu_ps(q_re + x, _mm256_sub_ps(pr, tr));
+			_mm256_storeu_ps(q_im + x, _mm256_sub_ps(pi, ti));
+			_mm256_storeu_ps(p_re + x, _mm256_add_ps(pr, tr));
+			_mm256_storeu_ps(p_im + x, _mm256_add_ps(pi, ti));
+		}
+#endif
+#if defined(__SSE2__)
+		__m128 w_re4 = _mm_set1_ps(w_re);
+		__m128 w_im4 = _mm_set1_ps(w_im);
+		for (; x + 4 <= width; x += 4)
+		{
+			__m128 qr = _mm_loadu_ps(q_re + x);
+			__m128 qi = _mm_loadu_ps(q_im + x);
+			__m128 pr = _mm_loadu_ps(p_re + x);
+			__m128 pi = _mm_loadu_ps(p_im + x);
+			__m128 tr = _mm_sub_ps(_mm_mul_ps(qr, w_re4), _mm_mul_ps(qi, w_im4));
+			__m128 ti = _mm_add_ps(_mm_mul_ps(qr, w_im4), _mm_mul_ps(qi, w_re4));
+			_mm_storeu_ps(q_re + x, _mm_sub_ps(pr, tr));
+			_mm_storeu_ps(q_im + x, _mm_sub_ps(pi, ti));
+			_mm_storeu_ps(p_re + x, _mm_add_ps(pr, tr));
+			_mm_storeu_ps(p_im + x, _mm_add_ps(pi, ti));
+		}
+#endif
+		for (; x < width; ++x)
+		{
+			float t_re = q_re[x] * w_re - q_im[x] * w_im;
+			float t_im = q_re[x] * w_im + q_im[x] * w_re;
+			q_re[x] = p_re[x] - t_re;
+			q_im[x] = p_im[x] - t_im;
+			p_re[x] += t_re;
+			p_im[x] += t_im;
+		}
+	}
+
+	/* ************************************************************************** */
+	inline void SplitFFT::doScale(SplitComplexImage &image, float factor)
+	/* ************************************************************************** */
+	{
+		image.getReal().mul(factor);
+		image.getImag().mul(factor);
+	}
+
+} /* namespace GET */
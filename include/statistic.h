@@ -19,8 +19,20 @@ namespace GET
 class Statistic
 {
 private:
-	int m_index_last_maximum;
-	int m_index_last_minimum;
+	PixelIndex m_index_last_maximum;
+	PixelIndex m_index_last_minimum;
+
+	/**
+	 * Ermittelt Minimum und Maximum eines Bildes mit 16-Bit-Pixeln (uint16, int16)
+	 * zeilenweise mit ImageArithmetic::doMaxMin() und speichert die Indizes
+	 * der ersten Vorkommen von Maximum und Minimum (wie die allgemeinen Methoden).
+	 * 
+	 * @param image Bild mit mindestens einem Pixel (Input)
+	 * @param max maximaler Pixelwert von image (Output)
+	 * @param min minimaler Pixelwert von image (Output)
+	 */
+	template <typename TYP>
+	inline void getMaxMinInteger16( const Image<TYP> &image, TYP &max, TYP &min );
 public:
 	/**
 	 * Ermittelt das Maximum aller Bildpixel.
@@ -121,7 +133,7 @@ public:
 	 * 
 	 * @return Index des letzten Maximums	
 	 */
-	inline int getLastMaxIndex( ) { return m_index_last_maximum; };
+	inline PixelIndex getLastMaxIndex( ) { return m_index_last_maximum; };
 
 	/**
 	 * liefert den Index des letzten durch getMin(...) oder getMaxMin(...)
@@ -129,7 +141,7 @@ public:
 	 * 
 	 * @return Index des letzten Minimums	
 	 */
-	inline int getLastMinIndex( ) { return m_index_last_minimum; };
+	inline PixelIndex getLastMinIndex( ) { return m_index_last_minimum; };
 	
 	/** Konstruktor */
 	Statistic( ) :
@@ -149,10 +161,13 @@ template <typename TYP>
 TYP Statistic::getMax( const Image<TYP> &image )
 /* ****************************************************************************** */
 {
-	int  size = image.getSize();
-	TYP* data = image.getData();
+	PixelIndex size = image.getSize();
+	int  width  = image.getWidth();
+	int  height = image.getHeight();
+	TYP* data   = image.getData();
+	TYP* row;
 	TYP  max;
-	int  index; 
+	PixelIndex index;
 
 	if (size>=1)
 	{
@@ -160,13 +175,17 @@ TYP Statistic::getMax( const Image<TYP> &image )
 		max   = data[0];
 		index = 0;
 		
-		// alle weiteren Pixel nach dem Maximum durchsuchen
-		for ( int i=1; i<size; ++i )
+		// alle Pixel zeilenweise nach dem Maximum durchsuchen (Index i = y*width+x)
+		for ( int y=0; y<height; ++y )
 		{
-			if (data[i]>max)
+			row = image.getRow( y );
+			for ( int x=0; x<width; ++x )
 			{
-				max   = data[i];
-				index = i;
+				if (row[x]>max)
+				{
+					max   = row[x];
+					index = (PixelIndex)y*width+x;
+				}
 			}
 		}
 		
@@ -187,10 +206,13 @@ template <typename TYP>
 TYP Statistic::getMin( const Image<TYP> &image )
 /* ****************************************************************************** */
 {
-	int  size = image.getSize();
-	TYP* data = image.getData();
+	PixelIndex size = image.getSize();
+	int  width  = image.getWidth();
+	int  height = image.getHeight();
+	TYP* data   = image.getData();
+	TYP* row;
 	TYP  min;
-	int  index; 
+	PixelIndex index;
 
 	if (size>=1)
 	{
@@ -198,13 +220,17 @@ TYP Statistic::getMin( const Image<TYP> &image )
 		min   = data[0];
 		index = 0;
 		
-		// alle weiteren Pixel nach dem Minimum durchsuchen
-		for ( int i=1; i<size; ++i )
+		// alle Pixel zeilenweise nach dem Minimum durchsuchen (Index i = y*width+x)
+		for ( int y=0; y<height; ++y )
 		{
-			if (min>data[i])
+			row = image.getRow( y );
+			for ( int x=0; x<width; ++x )
 			{
-				min   = data[i];
-				index = i;
+				if (min>row[x])
+				{
+					min   = row[x];
+					index = (PixelIndex)y*width+x;
+				}
 			}
 		}
 		
@@ -225,10 +251,13 @@ template <typename TYP>
 void Statistic::getMaxMin( const Image<TYP> &image, TYP &max, TYP &min )
 /* ****************************************************************************** */
 {
-	int  size = image.getSize();
-	TYP* data = image.getData();
-	int  index_max; 
-	int  index_min; 
+	PixelIndex size = image.getSize();
+	int  width  = image.getWidth();
+	int  height = image.getHeight();
+	TYP* data   = image.getData();
+	TYP* row;
+	PixelIndex index_max;
+	PixelIndex index_min;
 
 	if (size>=1)
 	{
@@ -236,18 +265,22 @@ void Statistic::getMaxMin( const Image<TYP> &image, TYP &max, TYP &min )
 		max = min = data[0];
 		index_max = index_min = 0;
 		
-		// alle weiteren Pixel nach dem Maximum durchsuchen
-		for ( int i=1; i<size; ++i )
+		// alle Pixel zeilenweise nach dem Maximum durchsuchen (Index i = y*width+x)
+		for ( int y=0; y<height; ++y )
 		{
-			if (data[i]>max)
-			{
-				max       = data[i];
-				index_max = i;
-			}
-			else if (min>data[i])
+			row = image.getRow( y );
+			for ( int x=0; x<width; ++x )
 			{
-				min       = data[i];
-				index_min = i;
+				if (row[x]>max)
+				{
+					max       = row[x];
+					index_max = (PixelIndex)y*width+x;
+				}
+				else if (min>row[x])
+				{
+					min       = row[x];
+					index_min = (PixelIndex)y*width+x;
+				}
 			}
 		}
 		
@@ -265,6 +298,154 @@ void Statistic::getMaxMin( const Image<TYP> &image, TYP &max, TYP &min )
 
 
 
+/* ****************************************************************************** */
+template <typename TYP>
+inline void Statistic::getMaxMinInteger16( const Image<TYP> &image, TYP &max, TYP &min )
+/* ****************************************************************************** */
+{
+	int width  = image.getWidth();
+	int height = image.getHeight();
+	int y_max  = 0;
+	int y_min  = 0;
+	TYP row_max, row_min;
+
+	// Extrema der Zeilen vektorisiert, gemerkt wird die erste Zeile mit dem Extremum
+	ImageArithmetic::doMaxMin( image.getRow( 0 ), width, max, min );
+	for ( int y=1; y<height; ++y )
+	{
+		ImageArithmetic::doMaxMin( image.getRow( y ), width, row_max, row_min );
+		if (row_max>max)
+		{
+			max   = row_max;
+			y_max = y;
+		}
+		if (min>row_min)
+		{
+			min   = row_min;
+			y_min = y;
+		}
+	}
+
+	// erstes Vorkommen in der Zeile suchen (Index i = y*width+x)
+	const TYP* row = image.getRow( y_max );
+	int x = 0;
+	while (row[x]!=max)
+		++x;
+	m_index_last_maximum = (PixelIndex)y_max*width+x;
+
+	row = image.getRow( y_min );
+	x = 0;
+	while (row[x]!=min)
+		++x;
+	m_index_last_minimum = (PixelIndex)y_min*width+x;
+}
+
+/* ****************************************************************************** */
+template <>
+inline uint16 Statistic::getMax( const Image<uint16> &image )
+/* ****************************************************************************** */
+{
+	uint16 max, min;
+	PixelIndex index_min = m_index_last_minimum;
+
+	if (image.getSize()>=1)
+	{
+		getMaxMinInteger16( image, max, min );
+		m_index_last_minimum = index_min;
+	}
+	else
+		m_index_last_maximum = -1;
+
+	return max;
+}
+
+/* ****************************************************************************** */
+template <>
+inline uint16 Statistic::getMin( const Image<uint16> &image )
+/* ****************************************************************************** */
+{
+	uint16 max, min;
+	PixelIndex index_max = m_index_last_maximum;
+
+	if (image.getSize()>=1)
+	{
+		getMaxMinInteger16( image, max, min );
+		m_index_last_maximum = index_max;
+	}
+	else
+		m_index_last_minimum = -1;
+
+	return min;
+}
+
+/* ****************************************************************************** */
+template <>
+inline void Statistic::getMaxMin( const Image<uint16> &image, uint16 &max, uint16 &min )
+/* ****************************************************************************** */
+{
+	if (image.getSize()>=1)
+		getMaxMinInteger16( image, max, min );
+	else
+	{
+		m_index_last_maximum = -1;
+		m_index_last_minimum = -1;
+	}
+}
+
+/* ****************************************************************************** */
+template <>
+inline int16 Statistic::getMax( const Image<int16> &image )
+/* ****************************************************************************** */
+{
+	int16 max, min;
+	PixelIndex index_min = m_index_last_minimum;
+
+	if (image.getSize()>=1)
+	{
+		getMaxMinInteger16( image, max, min );
+		m_index_last_minimum = index_min;
+	}
+	else
+		m_index_last_maximum = -1;
+
+	return max;
+}
+
+/* ****************************************************************************** */
+template <>
+inline int16 Statistic::getMin( const Image<int16> &image )
+/* ****************************************************************************** */
+{
+	int16 max, min;
+	PixelIndex index_max = m_index_last_maximum;
+
+	if (image.getSize()>=1)
+	{
+		getMaxMinInteger16( image, max, min );
+		m_index_last_maximum = index_max;
+	}
+	else
+		m_index_last_minimum = -1;
+
+	return min;
+}
+
+/* ****************************************************************************** */
+template <>
+inline void Statistic::getMaxMin( const Image<int16> &image, int16 &max, int16 &min )
+/* ****************************************************************************** */
+{
+	if (image.getSize()>=1)
+		getMaxMinInteger16( image, max, min );
+	else
+	{
+		m_index_last_maximum = -1;
+		m_index_last_minimum = -1;
+	}
+}
+
+
+
 /* ****************************************************************************** */
 template <typename TYP>
 TYP Statistic::getMax( const ImageSequence<TYP> &imageseq )
@@ -0,0 +1,750 @@
+#pragma once
+
+#include "image.h"
+#include "imageview.h"
+#include "mappedimage.h"
+#include "gexception.h"
+
+#include <algorithm>
+#include <list>
+#include <vector>
+
+namespace GET
+{
+
+	/** Image stored in square tiles (e.g. 256x256 pixels) instead of rows.
+	 *
+	 * In a row-major Image the vertical neighbours of a pixel are a whole row apart, so 2D-local
+	 * operations on very wide images touch a new page (and TLB entry) for every row of the
+	 * neighbourhood. A TiledImage stores every tile as a packed Image of its own, so a tile plus
+	 * its neighbourhood fits into a few pages and into the cache.
+	 *
+	 * Tiles are materialized on demand:
+	 * - Without a source, a tile is allocated on its first write (setPixel(), getTile(),
+	 *   copyFrom()). Pixels of tiles that were never written have the background value
+	 *   (setBackground()) and need no memory. Written tiles hold the only copy of their pixels
+	 *   and stay in memory, so such an image must fit into the main memory.
+	 * - With a source image (e.g. a MappedImage of a file larger than the main memory), a tile
+	 *   is copied from the source when it is accessed. At most getCacheCapacity() tiles are kept;
+	 *   the least recently used tile is evicted and, if it was written, copied back to the source.
+	 *   doFlush() copies all written tiles back.
+	 * - With a spill file, the image behaves like an image without source, but written tiles
+	 *   are evicted like those of an image with source: the file (a MappedImage created with
+	 *   MappedImage::CREATE) takes evicted tiles and gives them back when they are accessed again.
+	 *   This is the mode for results larger than the main memory.
+	 *
+	 * Kernels process the image tile by tile with a TileIterator, which hands out every tile
+	 * together with a halo of neighbouring pixels as one packed image (see
+	 * SpatialFiltering::doConvolutionInTiles() and Morphology::doErosionInTiles()).
+	 *
+	 * The object is not thread-safe; reading pixels of an image with source changes the cache.
+	 *
+	 * \code
+	 * MappedImage<float> file( "scan.raw", 120000, 80000 );
+	 * TiledImage<float> input( file, 1024 ), result( "result.raw", 120000, 80000, 1024 );
+	 * filter.doConvolutionInTiles( input, result );
+	 * result.doFlush();                                 // result.raw holds all pixels
+	 * \endcode
+	 *
+	 * @param Typ base data type of the image
+	 */
+	template <typename Typ>
+	class TiledImage
+	{
+	public:
+		/** Default size of the tiles (width and height in pixels) */
+		enum
+		{
+			TILE_SIZE = 256
+		};
+
+		class TileIterator;
+
+		/** Constructor for an image without source, all pixels have the background value.
+		 *
+		 * All written tiles are kept in memory (the cache capacity does not apply).
+		 *
+		 * @param width width of the image
+		 * @param height height of the image
+		 * @param tile_size width and height of the tiles
+		 */
+		inline TiledImage(int width = 0, int height = 0, int tile_size = TILE_SIZE);
+
+		/** Constructor for an image whose tiles are copied from a source image on demand.
+		 *
+		 * The source must exist as long as this object and must not be resized meanwhile.
+		 * Written tiles are copied back to the source when they are evicted, by doFlush() and
+		 * by the destructor.
+		 *
+		 * @param source image with the pixels
+		 * @param cache_capacity maximum number of tiles kept in memory (at least 1)
+		 * @param tile_size width and height of the tiles
+		 */
+		inline TiledImage(Image<Typ> &source, int cache_capacity, int tile_size = TILE_SIZE);
+
+		/** Constructor for an image without source whose written tiles are spilled to a file.
+		 *
+		 * The file is created (or truncated) with the size of the image and mapped with
+		 * MappedImage::CREATE. All pixels have the background value until they are written; at most
+		 * cache_capacity tiles are kept in memory, evicted tiles are copied to the file. After
+		 * doFlush() or the destruction of this object the file holds the pixels of all written
+		 * tiles (tiles never written are 0 in the file, not the background value). The file is
+		 * not deleted.
+		 *
+		 * @param filename name of the file
+		 * @param width width of the image
+		 * @param height height of the image
+		 * @param cache_capacity maximum number of tiles kept in memory (at least 1)
+		 * @param tile_size width and height of the tiles
+		 * @throws GException if the file can not be created or mapped (see MappedImage)
+		 */
+		inline TiledImage(const char *filename, int width, int height, int cache_capacity, int tile_size = TILE_SIZE);
+
+		/** Destructor, copies written tiles back to the source or the spill file. */
+		inline ~TiledImage();
+
+		/** Returns the width of the image. */
+		inline int getWidth() const { return m_width; };
+
+		/** Returns the height of the image. */
+		inline int getHeight() const { return m_height; };
+
+		/** Returns the width and height of the tiles (tiles at the right and bottom border may be smaller). */
+		inline int getTileSize() const { return m_tile_size; };
+
+		/** Returns the number of tiles per row. */
+		inline int getTileColumns() const { return m_columns; };
+
+		/** Returns the number of tiles per column. */
+		inline int getTileRows() const { return m_rows; };
+
+		/** Returns the width of the tiles of column tx. */
+		inline int getTileWidth(int tx) const { return std::min(m_tile_size, m_width - tx * m_tile_size); };
+
+		/** Returns the height of the tiles of row ty. */
+		inline int getTileHeight(int ty) const { return std::min(m_tile_size, m_height - ty * m_tile_size); };
+
+		/** Returns the number of tiles currently in memory. */
+		inline int getTileCount() const { return (int)m_lru.size(); };
+
+		/** Changes the size of an image without source, all tiles are released.
+		 *
+		 * @param width width of the image
+		 * @param height height of the image
+		 */
+		inline void resize(int width, int height);
+
+		/** Sets the value of the pixels of tiles that were never written (image without source). */
+		inline void setBackground(const Typ &background) { m_background = background; };
+
+		/** Returns the value of the pixels of tiles that were never written. */
+		inline const Typ &getBackground() const { return m_background; };
+
+		/** Sets the maximum number of tiles kept in memory (image with source or spill file, at least 1). */
+		inline void setCacheCapacity(int cache_capacity);
+
+		/** Returns the maximum number of tiles kept in memory (image with source or spill file). */
+		inline int getCacheCapacity() const { return m_cache_capacity; };
+
+		/** Returns a pixel.
+		 *
+		 * @param x column
+		 * @param y row
+		 */
+		inline Typ getPixel(int x, int y) const;
+
+		/** Sets a pixel (materializes its tile).
+		 *
+		 * @param x column
+		 * @param y row
+		 * @param value new value of the pixel
+		 */
+		inline void setPixel(int x, int y, const Typ &value);
+
+		/** Returns a tile for writing (materializes the tile).
+		 *
+		 * The reference is valid until another tile is materialized (image with source) or the
+		 * image is resized.
+		 *
+		 * @param tx column of the tile
+		 * @param ty row of the tile
+		 */
+		inline Image<Typ> &getTile(int tx, int ty);
+
+		/** Copies a region of the image into an image.
+		 *
+		 * Only the tiles overlapping the region are accessed, tiles without data are not allocated.
+		 *
+		 * @param image image for the pixels (is resized to width x height)
+		 * @param x0 left column of the region
+		 * @param y0 top row of the region
+		 * @param width width of the region
+		 * @param height height of the region
+		 */
+		inline void copyTo(Image<Typ> &image, int x0, int y0, int width, int height) const;
+
+		/** Copies the whole image into an image (is resized to the size of this image). */
+		inline void copyTo(Image<Typ> &image) const { copyTo(image, 0, 0, m_width, m_height); };
+
+		/** Copies an image into a region of this image.
+		 *
+		 * Pixels outside of this image are ignored (with a message on gerr).
+		 *
+		 * @param image pixels to be copied
+		 * @param x0 column of the upper left pixel of image in this image
+		 * @param y0 row of the upper left pixel of image in this image
+		 */
+		inline void copyFrom(const Image<Typ> &image, int x0 = 0, int y0 = 0);
+
+		/** Copies all written tiles back to the source or the spill file. */
+		inline void doFlush();
+
+	private:
+		/** Management data of a tile */
+		struct Tile
+		{
+			/** Pixels of the tile (NULL, if the tile is not in memory) */
+			Image<Typ> *image;
+			/** true, if the tile was written since it was copied from the source */
+			bool written;
+			/** true, if the tile has been copied to the spill file (its pixels are read from there) */
+			bool spilled;
+			/** Position in the list of tiles in memory */
+			std::list<int>::iterator position;
+		};
+
+		/** Width of the image */
+		int m_width;
+		/** Height of the image */
+		int m_height;
+		/** Width and height of the tiles */
+		int m_tile_size;
+		/** Number of tiles per row */
+		int m_columns;
+		/** Number of tiles per column */
+		int m_rows;
+		/** Source of the pixels (NULL, if the tiles are not backed by an image) */
+		Image<Typ> *m_source;
+		/** Spill file created by this object, also m_source (NULL, if there is none) */
+		MappedImage<Typ> *m_spill;
+		/** Maximum number of tiles in memory (image with source) */
+		int m_cache_capacity;
+		/** Value of the pixels of tiles that were never written */
+		Typ m_background;
+		/** Tiles, row by row (materialized on demand, also when reading) */
+		mutable std::vector<Tile> m_tiles;
+		/** Indices of the tiles in memory, most recently used first */
+		mutable std::list<int> m_lru;
+
+		/** Initializes the tile table for the current size. */
+		inline void doCreateTiles();
+
+		/** Returns the tile with the given index, materializing it if possible.
+		 *
+		 * @param index index of the tile
+		 * @param allocate true: allocate tiles without source (write access)
+		 * @return the tile or NULL (no source and not allocated)
+		 */
+		inline Image<Typ> *doMaterialize(int index, bool allocate) const;
+
+		/** Removes the least recently used tiles until the capacity is not exceeded. */
+		inline void doEvict() const;
+
+		/** Copies a written tile back to the source. */
+		inline void doWriteBack(int index) const;
+
+		/** Releases all tiles (without writing them back). */
+		inline void doReleaseTiles();
+
+		/** Copying is not possible. */
+		TiledImage(const TiledImage<Typ> &);
+
+		/** Assignment is not possible. */
+		TiledImage<Typ> &operator=(const TiledImage<Typ> &);
+	};
+
+	/** Iterator handing the tiles of a TiledImage to a kernel, every tile with a halo.
+	 *
+	 * For every tile (row by row) the tile and the pixels around it within the halo are copied
+	 * into a packed image (getInput()). At the border of the image the halo is clipped; if the
+	 * image is large enough, the input is then widened to the inside, so that it is always at
+	 * least (halo_left + 1 + halo_right) x (halo_top + 1 + halo_bottom) pixels large. The input
+	 * image is reused for all tiles, so the memory needed is bounded by one tile plus halo. The
+	 * result may be written to an image with a different tile size (copyFrom()).
+	 *
+	 * \code
+	 * for ( TiledImage<float>::TileIterator tile( input, 2, 2, 2, 2 ); tile.isValid(); tile.doNext() )
+	 * {
+	 *     kernel( tile.getInput(), window_result );
+	 *     result.copyFrom( ImageView<float>( window_result, tile.getOffsetX(), tile.getOffsetY(), tile.getWidth(), tile.getHeight() ),
+	 *                      tile.getX0(), tile.getY0() );
+	 * }
+	 * \endcode
+	 */
+	template <typename Typ>
+	class TiledImage<Typ>::TileIterator
+	{
+	public:
+		/** Constructor, starts with the upper left tile.
+		 *
+		 * @param image image to be processed (must not be changed during the iteration)
+		 * @param halo_left number of columns left of the tile
+		 * @param halo_top number of rows above the tile
+		 * @param halo_right number of columns right of the tile
+		 * @param halo_bottom number of rows below the tile
+		 */
+		inline TileIterator(const TiledImage<Typ> &image, int halo_left, int halo_top, int halo_right, int halo_bottom);
+
+		/** Returns true, if the iterator refers to a tile. */
+		inline bool isValid() const { return m_ty < m_image.getTileRows(); };
+
+		/** Moves to the next tile. */
+		inline void doNext();
+
+		/** Returns the column of the tile. */
+		inline int getTileX() const { return m_tx; };
+
+		/** Returns the row of the tile. */
+		inline int getTileY() const { return m_ty; };
+
+		/** Returns the left column of the tile in the image. */
+		inline int getX0() const { return m_tx * m_image.getTileSize(); };
+
+		/** Returns the top row of the tile in the image. */
+		inline int getY0() const { return m_ty * m_image.getTileSize(); };
+
+		/** Returns the width of the tile. */
+		inline int getWidth() const { return m_image.getTileWidth(m_tx); };
+
+		/** Returns the height of the tile. */
+		inline int getHeight() const { return m_image.getTileHeight(m_ty); };
+
+		/** Returns the tile with its halo as packed image. */
+		inline const Image<Typ> &getInput() const { return m_input; };
+
+		/** Returns the column of the tile in getInput(). */
+		inline int getOffsetX() const { return getX0() - m_input_x0; };
+
+		/** Returns the row of the tile in getInput(). */
+		inline int getOffsetY() const { return getY0() - m_input_y0; };
+
+	private:
+		/** Image to be processed */
+		const TiledImage<Typ> &m_image;
+		/** Halo */
+		int m_halo_left, m_halo_top, m_halo_right, m_halo_bottom;
+		/** Current tile */
+		int m_tx, m_ty;
+		/** Position of the input in the image */
+		int m_input_x0, m_input_y0;
+		/** Tile with halo */
+		Image<Typ> m_input;
+
+		/** Copies the current tile with its halo into m_input. */
+		inline void doLoad();
+	};
+
+	/* ************************************************************************** */
+	/* *** Implementation of the inline methods ********************************* */
+	/* ************************************************************************** */
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline TiledImage<Typ>::TiledImage(int width, int height, int tile_size) : m_width(width),
+																				 m_height(height),
+																				 m_tile_size(std::max(1, tile_size)),
+																				 m_source(NULL),
+																				 m_spill(NULL),
+																				 m_cache_capacity(0),
+																				 m_background()
+	/* ************************************************************************** */
+	{
+		doCreateTiles();
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline TiledImage<Typ>::TiledImage(Image<Typ> &source, int cache_capacity, int tile_size) : m_width(source.getWidth()),
+																								  m_height(source.getHeight()),
+																								  m_tile_size(std::max(1, tile_size)),
+																								  m_source(&source),
+																								  m_spill(NULL),
+																								  m_cache_capacity(std::max(1, cache_capacity)),
+																								  m_background()
+	/* ************************************************************************** */
+	{
+		doCreateTiles();
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline TiledImage<Typ>::TiledImage(const char *filename, int width, int height, int cache_capacity, int tile_size) : m_width(width),
+																													   m_height(height),
+																													   m_tile_size(std::max(1, tile_size)),
+																													   m_source(NULL),
+																													   m_spill(NULL),
+																													   m_cache_capacity(std::max(1, cache_capacity)),
+																													   m_background()
+	/* ************************************************************************** */
+	{
+		m_spill = new MappedImage<Typ>(filename, width, height, MappedImage<Typ>::CREATE);
+		m_spill->setAccessPattern(MappedImage<Typ>::NORMAL);
+		m_source = m_spill;
+		doCreateTiles();
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline TiledImage<Typ>::~TiledImage()
+	/* ************************************************************************** */
+	{
+		doFlush();
+		doReleaseTiles();
+		delete m_spill;
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void TiledImage<Typ>::doCreateTiles()
+	/* ************************************************************************** */
+	{
+		m_columns = (m_width + m_tile_size - 1) / m_tile_size;
+		m_rows = (m_height + m_tile_size - 1) / m_tile_size;
+
+		Tile empty;
+		empty.image = NULL;
+		empty.written = false;
+		empty.spilled = false;
+		empty.position = m_lru.end();
+		m_tiles.assign((size_t)m_columns * m_rows, empty);
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void TiledImage<Typ>::doReleaseTiles()
+	/* ************************************************************************** */
+	{
+		for (std::list<int>::iterator i = m_lru.begin(); i != m_lru.end(); ++i)
+		{
+			delete m_tiles[*i].image;
+			m_tiles[*i].image = NULL;
+			m_tiles[*i].written = false;
+		}
+		m_lru.clear();
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void TiledImage<Typ>::resize(int width, int height)
+	/* ************************************************************************** */
+	{
+		if ((width == m_width) && (height == m_height))
+			return;
+
+		if (m_source)
+		{
+			gerr << "Runtime error in TiledImage<Typ>::resize( int width, int height )" << std::endl;
+			gerr << "The image has a source image, its size can not be changed." << std::endl;
+			return;
+		}
+
+		doReleaseTiles();
+		m_width = width;
+		m_height = height;
+		doCreateTiles();
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void TiledImage<Typ>::setCacheCapacity(int cache_capacity)
+	/* ************************************************************************** */
+	{
+		m_cache_capacity = std::max(1, cache_capacity);
+		doEvict();
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline Image<Typ> *TiledImage<Typ>::doMaterialize(int index, bool allocate) const
+	/* ************************************************************************** */
+	{
+		Tile &tile = m_tiles[index];
+		if (tile.image)
+		{
+			// most recently used
+			m_lru.splice(m_lru.begin(), m_lru, tile.position);
+			return tile.image;
+		}
+
+		// tiles never spilled are not in the spill file yet
+		bool from_source = m_source && (!m_spill || tile.spilled);
+		if (!from_source && !allocate)
+			return NULL;
+
+		int tx = index % m_columns;
+		int ty = index / m_columns;
+		tile.image = new Image<Typ>(getTileWidth(tx), getTileHeight(ty));
+		if (from_source)
+			tile.image->copy(*m_source, tx * m_tile_size, ty * m_tile_size, tile.image->getWidth(), tile.image->getHeight());
+		else
+			tile.image->fill(m_background);
+		tile.written = false;
+
+		m_lru.push_front(index);
+		tile.position = m_lru.begin();
+
+		// keep the new tile even if the capacity is exceeded
+		doEvict();
+		return tile.image;
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void TiledImage<Typ>::doEvict() const
+	/* ************************************************************************** */
+	{
+		// tiles without source hold the only copy of their pixels
+		if (!m_source)
+			return;
+
+		while ((int)m_lru.size() > m_cache_capacity)
+		{
+			int index = m_lru.back();
+			m_lru.pop_back();
+
+			Tile &tile = m_tiles[index];
+			if (tile.written)
+				doWriteBack(index);
+			delete tile.image;
+			tile.image = NULL;
+			tile.written = false;
+			tile.position = m_lru.end();
+		}
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void TiledImage<Typ>::doWriteBack(int index) const
+	/* ************************************************************************** */
+	{
+		Tile &tile = m_tiles[index];
+		int tx = index % m_columns;
+		int ty = index / m_columns;
+
+		ImageView<Typ> region(*m_source, tx * m_tile_size, ty * m_tile_size, tile.image->getWidth(), tile.image->getHeight());
+		region.copy(*tile.image);
+		tile.written = false;
+		tile.spilled = true;
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void TiledImage<Typ>::doFlush()
+	/* ************************************************************************** */
+	{
+		if (!m_source)
+			return;
+
+		for (std::list<int>::iterator i = m_lru.begin(); i != m_lru.end(); ++i)
+			if (m_tiles[*i].written)
+				doWriteBack(*i);
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline Image<Typ> &TiledImage<Typ>::getTile(int tx, int ty)
+	/* ************************************************************************** */
+	{
+		if ((tx < 0) || (ty < 0) || (tx >= m_columns) || (ty >= m_rows))
+			throw GException("TiledImage<Typ>::getTile( int tx, int ty )", "The tile is outside of the image.");
+
+		int index = ty * m_columns + tx;
+		Image<Typ> *image = doMaterialize(index, true);
+		m_tiles[index].written = true;
+		return *image;
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline Typ TiledImage<Typ>::getPixel(int x, int y) const
+	/* ************************************************************************** */
+	{
+		int tx = x / m_tile_size;
+		int ty = y / m_tile_size;
+		const Image<Typ> *image = doMaterialize(ty * m_columns + tx, false);
+		if (!image)
+			return m_background;
+		return image->getRow(y - ty * m_tile_size)[x - tx * m_tile_size];
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void TiledImage<Typ>::setPixel(int x, int y, const Typ &value)
+	/* ************************************************************************** */
+	{
+		int tx = x / m_tile_size;
+		int ty = y / m_tile_size;
+		getTile(tx, ty).getRow(y - ty * m_tile_size)[x - tx * m_tile_size] = value;
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void TiledImage<Typ>::copyTo(Image<Typ> &image, int x0, int y0, int width, int height) const
+	/* ************************************************************************** */
+	{
+		//
+		// TEST: region inside the image
+		//
+		if ((x0 < 0) || (y0 < 0) || (x0 + width > m_width) || (y0 + height > m_height))
+		{
+			gerr << "runtime error in TiledImage<Typ>::copyTo( Image<Typ> &image, int x0, int y0, int width, int height )\n";
+			gerr << "Specified region outside of the image, the region is clipped\n";
+
+			// ERROR CORRECTION
+			if (x0 < 0)
+			{
+				width += x0;
+				x0 = 0;
+			}
+			if (y0 < 0)
+			{
+				height += y0;
+				y0 = 0;
+			}
+			width = std::max(0, std::min(width, m_width - x0));
+			height = std::max(0, std::min(height, m_height - y0));
+		}
+
+		image.resize(width, height);
+		if ((width <= 0) || (height <= 0))
+			return;
+
+		// copy the part of every tile overlapping the region
+		for (int ty = y0 / m_tile_size; ty * m_tile_size < y0 + height; ++ty)
+		{
+			int top = std::max(y0, ty * m_tile_size);
+			int bottom = std::min(y0 + height, (ty + 1) * m_tile_size);
+
+			for (int tx = x0 / m_tile_size; tx * m_tile_size < x0 + width; ++tx)
+			{
+				int left = std::max(x0, tx * m_tile_size);
+				int right = std::min(x0 + width, (tx + 1) * m_tile_size);
+
+				ImageView<Typ> part(image, left - x0, top - y0, right - left, bottom - top);
+				const Image<Typ> *tile = doMaterialize(ty * m_columns + tx, false);
+				if (tile)
+					part.copy(*tile, left - tx * m_tile_size, top - ty * m_tile_size, right - left, bottom - top);
+				else
+					part.fill(m_background);
+			}
+		}
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void TiledImage<Typ>::copyFrom(const Image<Typ> &image, int x0, int y0)
+	/* ************************************************************************** */
+	{
+		int width = image.getWidth();
+		int height = image.getHeight();
+		int ix = 0;
+		int iy = 0;
+
+		//
+		// TEST: image inside this image
+		//
+		if ((x0 < 0) || (y0 < 0) || (x0 + width > m_width) || (y0 + height > m_height))
+		{
+			gerr << "runtime error in TiledImage<Typ>::copyFrom( const Image<Typ> &image, int x0, int y0 )\n";
+			gerr << "The image exceeds this image, only the overlapping pixels are copied\n";
+
+			// ERROR CORRECTION
+			if (x0 < 0)
+			{
+				ix = -x0;
+				width += x0;
+				x0 = 0;
+			}
+			if (y0 < 0)
+			{
+				iy = -y0;
+				height += y0;
+				y0 = 0;
+			}
+			width = std::min(width, m_width - x0);
+			height = std::min(height, m_height - y0);
+		}
+		if ((width <= 0) || (height <= 0))
+			return;
+
+		for (int ty = y0 / m_tile_size; ty * m_tile_size < y0 + height; ++ty)
+		{
+			int top = std::max(y0, ty * m_tile_size);
+			int bottom = std::min(y0 + height, (ty + 1) * m_tile_size);
+
+			for (int tx = x0 / m_tile_size; tx * m_tile_size < x0 + width; ++tx)
+			{
+				int left = std::max(x0, tx * m_tile_size);
+				int right = std::min(x0 + width, (tx + 1) * m_tile_size);
+
+				ImageView<Typ> part(getTile(tx, ty), left - tx * m_tile_size, top - ty * m_tile_size, right - left, bottom - top);
+				part.copy(image, ix + left - x0, iy + top - y0, right - left, bottom - top);
+			}
+		}
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline TiledImage<Typ>::TileIterator::TileIterator(const TiledImage<Typ> &image, int halo_left, int halo_top, int halo_right, int halo_bottom) : m_image(image),
+																																						m_halo_left(std::max(0, halo_left)),
+																																						m_halo_top(std::max(0, halo_top)),
+																																						m_halo_right(std::max(0, halo_right)),
+																																						m_halo_bottom(std::max(0, halo_bottom)),
+																																						m_tx(0),
+																																						m_ty(0),
+																																						m_input_x0(0),
+																																						m_input_y0(0),
+																																						m_input()
+	/* ************************************************************************** */
+	{
+		if (m_image.getTileColumns() == 0)
+			m_ty = m_image.getTileRows();
+		if (isValid())
+			doLoad();
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void TiledImage<Typ>::TileIterator::doNext()
+	/* ************************************************************************** */
+	{
+		if (!isValid())
+			return;
+
+		if (++m_tx == m_image.getTileColumns())
+		{
+			m_tx = 0;
+			++m_ty;
+		}
+		if (isValid())
+			doLoad();
+	}
+
+	/* ************************************************************************** */
+	template <typename Typ>
+	inline void TiledImage<Typ>::TileIterator::doLoad()
+	/* ************************************************************************** */
+	{
+		int width = m_image.getWidth();
+		int height = m_image.getHeight();
+
+		// halo clipped at the image border, widened to the inside up to the minimum size
+		int x1 = std::min(width, getX0() + getWidth() + m_halo_right);
+		int y1 = std::min(height, getY0() + getHeight() + m_halo_bottom);
+		m_input_x0 = std::max(0, std::min(getX0() - m_halo_left, x1 - (m_halo_left + 1 + m_halo_right)));
+		m_input_y0 = std::max(0, std::min(getY0() - m_halo_top, y1 - (m_halo_top + 1 + m_halo_bottom)));
+
+		m_image.copyTo(m_input, m_input_x0, m_input_y0, x1 - m_input_x0, y1 - m_input_y0);
+	}
+
+} /* namespace GET */
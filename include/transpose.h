@@ -48,8 +48,9 @@ class Transpose
 template<typename TYP> 
 void Transpose::doTranspose( Image<TYP> &image )
 {
-	int 	 width = image.getWidth();
-	TYP 	*data  = image.getData();
+	int 	 width  = image.getWidth();
+	int 	 stride = image.getStride();
+	TYP 	*data   = image.getData();
 	
 	//
 	// TEST: Transpose in an image for square images only
@@ -71,8 +72,8 @@ void Transpose::doTranspose( Image<TYP> &image )
 	for ( int nr=1; nr<width; ++nr )
 	{
 		x = data+1;
-		y = data+width;
-		data += width+1; 	// advance to the next diagonal element
+		y = data+stride;
+		data += stride+1; 	// advance to the next diagonal element
 		
 		TYP tmp;
 		for ( int i=nr; i<width; ++i )
@@ -83,7 +84,7 @@ void Transpose::doTranspose( Image<TYP> &image )
 			*x  = tmp;
 			
 			++x;
-			y += width;
+			y += stride;
 		}
 	}
 }
@@ -111,14 +112,18 @@ void Transpose::doTranspose( const Image<TYP> &image, Image<TYP> &transpose )
 	//
 	// Transpose
 	//
-	TYP *src  = image.getData();
-	TYP *dest = transpose.getData();
+	TYP *src;
+	TYP *dest   = transpose.getData();
+	int  stride = transpose.getStride();
 	
 	for ( int y=0; y<height; ++y )
-	for ( int x=0; x<width;  ++x )
 	{
-		dest[x*height+y] = *src;
-		++src;
+		src = image.getRow( y );
+		for ( int x=0; x<width;  ++x )
+		{
+			dest[(PixelIndex)x*stride+y] = *src;
+			++src;
+		}
 	}
 }
 